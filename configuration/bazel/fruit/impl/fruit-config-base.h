@@ -45,4 +45,16 @@
 // Whether abi::__cxa_demangle() is available after including cxxabi.h.
 #define FRUIT_HAS_CXA_DEMANGLE 1
 
+// Whether injectors record events (constructions, destructions, etc.) in per-thread ring buffers, see
+// fruit/injection_events.h. When this is not defined, there's no overhead at all.
+// #define FRUIT_ENABLE_INJECTION_EVENTS 1
+
+// Whether each TypeInfo stores a fingerprint of the type, computed at compile time from its name, that is the same in
+// all processes (see getTypeFingerprint()). When this is not defined, the fingerprints aren't computed nor stored.
+// #define FRUIT_ENABLE_TYPE_FINGERPRINTS 1
+
+// Whether std::hash<TypeId> returns the fingerprint of the type, so that the hash tables of injectors are the same in
+// every run. This needs FRUIT_ENABLE_TYPE_FINGERPRINTS.
+// #define FRUIT_HASH_TYPE_IDS_BY_FINGERPRINT 1
+
 #endif // FRUIT_CONFIG_BASE_H
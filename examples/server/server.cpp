@@ -68,7 +68,7 @@ public:
 private:
   static void worker_thread_main(const NormalizedComponent<Required<Request>, RequestDispatcher>& requestDispatcherNormalizedComponent,
                                  Request request) {
-    Injector<RequestDispatcher> injector(requestDispatcherNormalizedComponent, getRequestComponent(request));
+    Injector<RequestDispatcher> injector(requestDispatcherNormalizedComponent, request);
     
     RequestDispatcher* requestDispatcher(injector);
     requestDispatcher->handleRequest();
@@ -83,11 +83,6 @@ private:
     }
     return result;
   }
-  
-  static Component<Request> getRequestComponent(Request request) {
-    return createComponent()
-        .bindInstance(request);
-  }
 };
 
 const fruit::Component<Server>& getServerComponent() {
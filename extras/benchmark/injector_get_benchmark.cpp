@@ -0,0 +1,101 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fruit/fruit.h>
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+
+// Compares Injector::get<T>() for a type T exposed by the injector (which uses the node looked up when the injector was
+// constructed) with unsafeGet<T>() (which looks up T's node in the injector's hash table at each call, like get<T>()
+// used to do).
+
+template <int n>
+struct X {
+  INJECT(X()) = default;
+};
+
+using Comp = fruit::Component<X<0>, X<1>, X<2>, X<3>, X<4>, X<5>, X<6>, X<7>, X<8>, X<9>>;
+
+Comp getComponent() {
+  return fruit::createComponent();
+}
+
+template <typename... Ts>
+struct Benchmark;
+
+template <typename... Ts>
+struct Benchmark<fruit::Component<Ts...>> {
+  static std::uintptr_t getAll(fruit::Injector<Ts...>& injector) {
+    std::uintptr_t result = 0;
+    std::uintptr_t values[] = {reinterpret_cast<std::uintptr_t>(injector.template get<Ts*>())...};
+    for (std::uintptr_t value : values) {
+      result ^= value;
+    }
+    return result;
+  }
+  
+  static std::uintptr_t unsafeGetAll(fruit::Injector<Ts...>& injector) {
+    std::uintptr_t result = 0;
+    std::uintptr_t values[] = {reinterpret_cast<std::uintptr_t>(injector.template unsafeGet<Ts>())...};
+    for (std::uintptr_t value : values) {
+      result ^= value;
+    }
+    return result;
+  }
+  
+  static void run(std::size_t num_loops) {
+    fruit::Injector<Ts...> injector(getComponent());
+    injector.eagerlyInjectAll();
+    
+    std::uintptr_t result = 0;
+    
+    std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < num_loops; i++) {
+      result += getAll(injector);
+    }
+    double getTime = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start_time).count();
+    
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < num_loops; i++) {
+      result += unsafeGetAll(injector);
+    }
+    double unsafeGetTime = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start_time).count();
+    
+    std::size_t num_gets = num_loops * sizeof...(Ts);
+    std::cout << std::fixed;
+    std::cout << std::setprecision(15);
+    std::cout << "Get             = " << getTime * 1.0 / num_gets << std::endl;
+    std::cout << "UnsafeGet       = " << unsafeGetTime * 1.0 / num_gets << std::endl;
+    // Printing this prevents the compiler from optimizing out the loops above.
+    std::cout << "Checksum        = " << result << std::endl;
+  }
+};
+
+int main(int argc, const char* argv[]) {
+  if (argc != 2) {
+    std::cout << "Error: you need to specify the number of loops as argument." << std::endl;
+    return 1;
+  }
+  std::size_t num_loops = std::atoi(argv[1]);
+  
+  Benchmark<Comp>::run(num_loops);
+  
+  return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/data_structures/semistatic_graph.h>
+#include <fruit/impl/data_structures/semistatic_graph.templates.h>
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+
+// Measures a walk of a 10k-node SemistaticGraph from its roots, visiting the dependencies of each node before the node
+// itself, like eagerlyInjectAll() does when it constructs all the types of an injector.
+// The graph is a random DAG where each node depends on up to 4 nodes, and the last 100 nodes are the roots (the exposed
+// types).
+
+using namespace fruit::impl;
+
+struct BenchNodeValue {
+  std::size_t num_deps;
+  std::uintptr_t payload;
+};
+
+using Graph = SemistaticGraph<std::uintptr_t, BenchNodeValue>;
+
+struct BenchNode {
+  std::uintptr_t id;
+  BenchNodeValue value;
+  const std::vector<std::uintptr_t>* deps;
+
+  std::uintptr_t getId() { return id; }
+  BenchNodeValue getValue() { return value; }
+  bool isTerminal() { return false; }
+  std::vector<std::uintptr_t>::const_iterator getEdgesBegin() { return deps->begin(); }
+  std::vector<std::uintptr_t>::const_iterator getEdgesEnd() { return deps->end(); }
+};
+
+std::uintptr_t nodeIdFor(std::size_t i) {
+  // Spaced like the addresses of the TypeInfo objects used as NodeIds by injectors.
+  return 0x400000 + i * 24;
+}
+
+std::uintptr_t visit(Graph& graph, Graph::node_iterator itr, std::vector<bool>& visited) {
+  if (visited[itr.getIndex()]) {
+    return 0;
+  }
+  visited[itr.getIndex()] = true;
+  std::uintptr_t result = itr.getNode().payload;
+  std::size_t num_deps = itr.getNode().num_deps;
+  if (num_deps != 0) {
+    Graph::edge_iterator edges = itr.neighborsBegin();
+    for (std::size_t i = 0; i < num_deps; ++i, ++edges) {
+      result += visit(graph, edges.getNodeIterator(graph), visited);
+    }
+  }
+  return result;
+}
+
+int main(int argc, const char* argv[]) {
+  if (argc != 2) {
+    std::cout << "Error: you need to specify the number of loops as argument." << std::endl;
+    return 1;
+  }
+  std::size_t num_loops = std::atoi(argv[1]);
+
+  const std::size_t num_nodes = 10000;
+  const std::size_t num_roots = 100;
+
+  std::default_random_engine random_generator(42);
+  std::vector<std::vector<std::uintptr_t>> deps(num_nodes);
+  for (std::size_t i = 1; i < num_nodes; ++i) {
+    std::size_t num_deps = std::uniform_int_distribution<std::size_t>(0, std::min(i, std::size_t(4)))(random_generator);
+    for (std::size_t j = 0; j < num_deps; ++j) {
+      // Mostly close dependencies, like the types of the same component.
+      std::size_t max_distance = std::min(i, std::size_t(200));
+      std::size_t dep = i - std::uniform_int_distribution<std::size_t>(1, max_distance)(random_generator);
+      if (std::find(deps[i].begin(), deps[i].end(), nodeIdFor(dep)) == deps[i].end()) {
+        deps[i].push_back(nodeIdFor(dep));
+      }
+    }
+  }
+
+  std::vector<BenchNode> nodes;
+  for (std::size_t i = 0; i < num_nodes; ++i) {
+    nodes.push_back(BenchNode{nodeIdFor(i), BenchNodeValue{deps[i].size(), i}, &deps[i]});
+  }
+  std::vector<std::uintptr_t> roots;
+  for (std::size_t i = num_nodes - num_roots; i < num_nodes; ++i) {
+    roots.push_back(nodeIdFor(i));
+  }
+
+  std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+  Graph graph(nodes.begin(), nodes.end(), roots);
+  double constructionTime = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+  std::uintptr_t result = 0;
+  start_time = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < num_loops; i++) {
+    std::vector<bool> visited(graph.size(), false);
+    for (std::uintptr_t root : roots) {
+      result += visit(graph, graph.at(root), visited);
+    }
+  }
+  double walkTime = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+  std::cout << std::fixed;
+  std::cout << std::setprecision(15);
+  std::cout << "Construction    = " << constructionTime << std::endl;
+  std::cout << "Walk            = " << walkTime / num_loops << std::endl;
+  std::cout << "Bytes per node  = " << graph.getAllocatedBytes() * 1.0 / num_nodes << std::endl;
+  // Printing this prevents the compiler from optimizing out the loops above.
+  std::cout << "Checksum        = " << result << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/data_structures/semistatic_map.h>
+#include <fruit/impl/data_structures/semistatic_map.templates.h>
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+// Measures the construction of a SemistaticMap and the lookups with at() and find(), for maps with 8 to 100k keys.
+// The keys are spaced like the addresses of the TypeInfo objects used as keys by injectors.
+// The second set of maps uses keys where groups of 16 keys have the same std::hash, so the map scans buckets instead
+// of using perfect hashing. Run this under `perf stat -e branches,branch-misses' to see the branch misses of the scans.
+
+using namespace fruit::impl;
+
+struct CollidingKey {
+  std::uintptr_t x;
+
+  bool operator==(const CollidingKey& other) const {
+    return x == other.x;
+  }
+};
+
+namespace std {
+template <>
+struct hash<CollidingKey> {
+  size_t operator()(const CollidingKey& key) const {
+    return key.x / (16 * 24);
+  }
+};
+}
+
+std::uintptr_t toUintptr(std::uintptr_t key) {
+  return key;
+}
+
+std::uintptr_t toUintptr(CollidingKey key) {
+  return key.x;
+}
+
+double secondsSince(std::chrono::high_resolution_clock::time_point start_time) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start_time).count();
+}
+
+template <typename Key>
+void run(std::size_t num_keys, std::size_t num_loops) {
+  using Map = SemistaticMap<Key, std::uintptr_t>;
+  std::vector<std::pair<Key, std::uintptr_t>> values;
+  for (std::size_t i = 0; i < num_keys; ++i) {
+    values.emplace_back(Key{0x400000 + i * 24}, i);
+  }
+
+  std::vector<Key> keys;
+  for (const auto& p : values) {
+    keys.push_back(p.first);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(42));
+
+  std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+  Map map(values.begin(), values.size());
+  double constructionTime = secondsSince(start_time);
+
+  std::uintptr_t result = 0;
+
+  start_time = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < num_loops; i++) {
+    for (Key key : keys) {
+      result += map.at(key);
+    }
+  }
+  double atTime = secondsSince(start_time);
+
+  start_time = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < num_loops; i++) {
+    for (Key key : keys) {
+      result += *map.find(key);
+    }
+  }
+  double findTime = secondsSince(start_time);
+
+  start_time = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < num_loops; i++) {
+    for (Key key : keys) {
+      result += (map.find(Key{toUintptr(key) + 8}) == nullptr);
+    }
+  }
+  double findMissingTime = secondsSince(start_time);
+
+  std::size_t num_lookups = num_loops * num_keys;
+  std::cout << std::fixed;
+  std::cout << std::setprecision(15);
+  std::cout << "Keys            = " << num_keys << (std::is_same<Key, CollidingKey>::value ? " (colliding)" : "") << std::endl;
+  std::cout << "Construction    = " << constructionTime << std::endl;
+  std::cout << "At              = " << atTime / num_lookups << std::endl;
+  std::cout << "Find            = " << findTime / num_lookups << std::endl;
+  std::cout << "FindMissing     = " << findMissingTime / num_lookups << std::endl;
+  std::cout << "Bytes per key   = " << map.getAllocatedBytes() * 1.0 / num_keys << std::endl;
+  // Printing this prevents the compiler from optimizing out the loops above.
+  std::cout << "Checksum        = " << result << std::endl;
+}
+
+int main(int argc, const char* argv[]) {
+  if (argc != 2) {
+    std::cout << "Error: you need to specify the number of loops as argument." << std::endl;
+    return 1;
+  }
+  std::size_t num_loops = std::atoi(argv[1]);
+
+  for (std::size_t num_keys : {8, 16, 32, 100, 1000, 10000, 100000}) {
+    // Roughly the same number of lookups for each map size.
+    run<std::uintptr_t>(num_keys, std::max(num_loops * 100 / num_keys, std::size_t(1)));
+  }
+  for (std::size_t num_keys : {100, 1000, 10000, 100000}) {
+    run<CollidingKey>(num_keys, std::max(num_loops * 100 / num_keys, std::size_t(1)));
+  }
+
+  return 0;
+}
@@ -25,6 +25,7 @@
 #include <fruit/impl/meta/component.h>
 #include <fruit/impl/storage/component_storage.h>
 #include <fruit/impl/storage/partial_component_storage.h>
+#include <fruit/impl/util/lambda_invoker.h>
 #include <fruit/impl/component_functors.defn.h>
 
 namespace fruit {
@@ -288,6 +289,38 @@ class PartialComponent {
   template<typename AnnotatedSignature, typename Lambda>
   PartialComponent<fruit::impl::RegisterProvider<AnnotatedSignature, Lambda>, Bindings...> registerProvider(Lambda lambda);
 
+  /**
+   * Similar to registerProvider(), but for a provider that starts constructing the object (e.g. doing some I/O in another
+   * thread) and returns a std::future<C> or a std::shared_future<C> (or another type with a get() method returning a C or a
+   * C*) instead of a C. This binds C (not the future), waiting for the result when the object is injected.
+   * 
+   * Example:
+   * 
+   * registerAsyncProvider([](Config* config) {
+   *    return std::async(std::launch::async, [config]() {
+   *      return Cache::loadFromDisk(config->cachePath());
+   *    });
+   * })
+   * 
+   * The lambda is called (starting the computation) when the object is first needed, or by Injector::eagerlyInjectAll()
+   * before any object waits for an async result, so that the async computations of all the async providers overlap.
+   * The future is waited for in the thread that needs the object, so the waits for independent objects also overlap when
+   * they are injected concurrently, e.g. with Injector::eagerlyInjectAll(num_threads) or Injector::getAsync().
+   * 
+   * As for registerProvider(), the lambda must not have captures (but the function that computes the result can).
+   */
+  template<typename Lambda>
+  PartialComponent<fruit::impl::RegisterAsyncProvider<Lambda>, Bindings...> registerAsyncProvider(Lambda lambda);
+
+  /**
+   * Similar to the previous version of registerAsyncProvider(), but allows to specify an annotated type for the provider,
+   * as in the annotated version of registerProvider(). The signature must have the type C (annotated or not) as the return
+   * type, not the type of the future.
+   */
+  template<typename AnnotatedSignature, typename Lambda>
+  PartialComponent<fruit::impl::RegisterAsyncProvider<AnnotatedSignature, Lambda>, Bindings...>
+      registerAsyncProvider(Lambda lambda);
+
   /**
    * Similar to bind<I, C>(), but adds a multibinding instead.
    * 
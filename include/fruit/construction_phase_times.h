@@ -0,0 +1,81 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_CONSTRUCTION_PHASE_TIMES_H
+#define FRUIT_CONSTRUCTION_PHASE_TIMES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace fruit {
+
+/**
+ * How long the construction of a NormalizedComponent or an Injector took, split by phase, as returned by
+ * NormalizedComponent::getConstructionPhaseTimes() and Injector::getConstructionPhaseTimes().
+ * All durations are in nanoseconds. The phases don't cover the whole construction (e.g. the computation of the
+ * construction schedule of a NormalizedComponent is only included in total_ns).
+ * 
+ * Example usage:
+ * 
+ * Injector<Foo> injector(normalized_component, getRequestComponent());
+ * if (injector.getConstructionPhaseTimes().total_ns > 1000 * 1000) {
+ *   std::cerr << "Slow injector construction: " << injector.getConstructionPhaseTimes() << std::endl;
+ * }
+ */
+struct ConstructionPhaseTimes {
+  // The whole construction.
+  std::uint64_t total_ns = 0;
+  
+  // Removing duplicate bindings (and checking that they're consistent), both within the new bindings and between the new
+  // bindings and the ones of the NormalizedComponent (or parent injector) if any.
+  std::uint64_t duplicate_detection_ns = 0;
+  
+  // Finding and performing binding compressions, and undoing the ones of the NormalizedComponent that no longer apply.
+  std::uint64_t binding_compression_ns = 0;
+  
+  // Sorting and merging the multibindings.
+  std::uint64_t multibindings_ns = 0;
+  
+  // Constructing the graph of the bindings, including the hash selection below.
+  std::uint64_t graph_construction_ns = 0;
+  
+  // Selecting a hash function for the hash tables of the graph. A random hash function is tried until one doesn't
+  // put too many keys in the same bucket, so this is usually very fast but it can take a few attempts.
+  std::uint64_t hash_selection_ns = 0;
+  
+  // The number of hash tables constructed (each one selects its own hash function). Tables with only a few keys (e.g.
+  // most of the ones constructed for each injector) don't need a hash function, so they are not counted here.
+  std::size_t num_hash_selections = 0;
+  
+  // The number of random hash functions that were tried and rejected (in total, for all the hash tables).
+  std::size_t num_rejected_hash_functions = 0;
+  
+  // The number of bindings (after normalization) added to the graph, on top of the ones of the NormalizedComponent (or
+  // parent injector) that the graph extends. For a NormalizedComponent, and for an Injector constructed from a Component,
+  // these are all the bindings. An Injector constructed from a NormalizedComponent and instances of its required types
+  // usually adds none: the instances are just stored in the nodes that the NormalizedComponent reserved for them.
+  std::size_t num_new_bindings = 0;
+};
+
+/**
+ * Writes the times in a human-readable form, on a single line (without a trailing newline). Meant for logging.
+ */
+std::ostream& operator<<(std::ostream& os, const ConstructionPhaseTimes& times);
+
+} // namespace fruit
+
+#endif // FRUIT_CONSTRUCTION_PHASE_TIMES_H
@@ -26,9 +26,13 @@
 
 #include <fruit/fruit_forward_decls.h>
 #include <fruit/component.h>
+#include <fruit/construction_phase_times.h>
 #include <fruit/normalized_component.h>
 #include <fruit/macro.h>
 #include <fruit/injector.h>
+#include <fruit/injector_memory_usage.h>
+#include <fruit/injection_events.h>
+#include <fruit/injection_profile.h>
 #include <fruit/provider.h>
 
 #endif // FRUIT_FRUIT_H
@@ -53,6 +53,14 @@ class Provider;
 template <typename... P>
 class Injector;
 
+class InjectionProfile;
+
+struct ConstructionPhaseTimes;
+
+class InjectorMemoryUsage;
+
+struct InjectionEvent;
+
 } // namespace fruit
 
 #endif // FRUIT_FRUIT_FORWARD_DECLS_H
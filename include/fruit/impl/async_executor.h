@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_ASYNC_EXECUTOR_H
+#define FRUIT_ASYNC_EXECUTOR_H
+
+#ifndef IN_FRUIT_CPP_FILE
+// This is only used by InjectorStorage, so there's no need to include it in public headers.
+#error "async_executor.h included in non-cpp file."
+#endif
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * Runs tasks in up to max_threads threads. The threads are only created when needed: when a task is scheduled and all
+ * the existing threads are busy. Once the limit is reached, the tasks are queued and run in order.
+ * Used to run the injections requested with Injector::getAsync().
+ */
+class AsyncExecutor {
+public:
+  explicit AsyncExecutor(std::size_t max_threads);
+  
+  AsyncExecutor(const AsyncExecutor&) = delete;
+  AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+  
+  // Runs the tasks that are still queued and then joins all threads.
+  ~AsyncExecutor();
+  
+  // Runs `task' in one of the threads. The task must not throw. This can be called concurrently from multiple threads.
+  void schedule(std::function<void()> task);
+  
+private:
+  std::size_t max_threads;
+  
+  // Guards the fields below.
+  std::mutex mutex;
+  
+  // Notified when a task is queued, or when the destructor starts.
+  std::condition_variable cond;
+  
+  std::deque<std::function<void()>> tasks;
+  
+  std::vector<std::thread> threads;
+  
+  // The threads that are waiting for a task.
+  std::size_t num_idle_threads = 0;
+  
+  bool stopping = false;
+  
+  // The loop run by each thread.
+  void runTasks();
+};
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_ASYNC_EXECUTOR_H
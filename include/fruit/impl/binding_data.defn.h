@@ -25,30 +25,43 @@ namespace fruit {
 namespace impl {
 
 template <typename L>
-struct GetBindingDepsHelper;
+struct GetTypeIdArrayHelper;
 
 template <typename... Ts>
-struct GetBindingDepsHelper<fruit::impl::meta::Vector<fruit::impl::meta::Type<Ts>...>> {
-  inline const BindingDeps* operator()() {
+struct GetTypeIdArrayHelper<fruit::impl::meta::Vector<fruit::impl::meta::Type<Ts>...>> {
+  static constexpr std::size_t size = sizeof...(Ts);
+  
+  inline const TypeId* operator()() {
     static const TypeId types[] = {getTypeId<Ts>()..., nullptr};
-    static const BindingDeps deps = {types, sizeof...(Ts)};
-    return &deps;
+    return types;
   }
 };
 
 // We specialize the "no Ts" case to avoid declaring types[] as an array of length 0.
 template <>
-struct GetBindingDepsHelper<fruit::impl::meta::Vector<>> {
-  inline const BindingDeps* operator()() {
+struct GetTypeIdArrayHelper<fruit::impl::meta::Vector<>> {
+  static constexpr std::size_t size = 0;
+  
+  inline const TypeId* operator()() {
     static const TypeId types[] = {nullptr};
-    static const BindingDeps deps = {types, 0};
+    return types;
+  }
+};
+
+template <typename Deps, typename EagerDeps, bool StartsAsyncProvider>
+struct GetBindingDepsHelper {
+  inline const BindingDeps* operator()() {
+    // When EagerDeps is the same as Deps, both point to the same array.
+    static const BindingDeps deps = {GetTypeIdArrayHelper<Deps>()(), GetTypeIdArrayHelper<Deps>::size,
+                                     GetTypeIdArrayHelper<EagerDeps>()(), GetTypeIdArrayHelper<EagerDeps>::size,
+                                     StartsAsyncProvider};
     return &deps;
   }
 };
 
-template <typename Deps>
+template <typename Deps, typename EagerDeps, bool StartsAsyncProvider>
 inline const BindingDeps* getBindingDeps() {
-  return GetBindingDepsHelper<Deps>()();
+  return GetBindingDepsHelper<Deps, EagerDeps, StartsAsyncProvider>()();
 }
 
 inline BindingData::BindingData(create_t create, const BindingDeps* deps, bool needs_allocation)
@@ -111,10 +124,9 @@ inline BindingData::object_t NormalizedBindingData::getObject() const {
   return reinterpret_cast<BindingData::object_t>(p);
 }
 
-inline void NormalizedBindingData::create(InjectorStorage& storage,
-                                          SemistaticGraph<TypeId, NormalizedBindingData>::node_iterator node_itr) {
-  BindingData::object_t obj = getCreate()(storage, node_itr);
-  p = reinterpret_cast<void*>(obj);
+inline BindingData::object_t NormalizedBindingData::create(InjectorStorage& storage,
+                                                           SemistaticGraph<TypeId, NormalizedBindingData>::node_iterator node_itr) const {
+  return getCreate()(storage, node_itr);
 }
 
 inline bool NormalizedBindingData::operator==(const NormalizedBindingData& other) const {
@@ -43,9 +43,22 @@ struct BindingDeps {
   
   // The size of the above array.
   std::size_t num_deps;
+  
+  // The deps that are injected before constructing the object, i.e. the ones in `deps' except those only injected
+  // lazily through a Provider. This is a C-style array too, and it can be the same array as `deps'.
+  const TypeId* eager_deps;
+  
+  // The size of the above array.
+  std::size_t num_eager_deps;
+  
+  // True for the bindings of the AsyncProviderFuture types, whose objects are constructed by calling the lambda of an
+  // async provider (see PartialComponent::registerAsyncProvider()). Constructing them just starts the async computation,
+  // so when eagerly injecting they are constructed before the other objects.
+  bool starts_async_provider;
 };
 
-template <typename Deps>
+// EagerDeps must be the subset of Deps that is injected before constructing the object (see BindingDeps::eager_deps).
+template <typename Deps, typename EagerDeps = Deps, bool StartsAsyncProvider = false>
 const BindingDeps* getBindingDeps();
 
 class BindingData {
@@ -135,10 +148,11 @@ public:
   // This assumes that the graph node is terminal (i.e. that there is an object in this BindingData).
   BindingData::object_t getObject() const;
   
-  // This assumes that the graph node is NOT terminal (i.e. that there is no object yet).
-  // This changes the graph node to terminal. Registers the destroy operation in InjectorStorage if needed.
-  void create(InjectorStorage& storage, 
-              typename SemistaticGraph<TypeId, NormalizedBindingData>::node_iterator node_itr);
+  // This assumes that the graph node is NOT terminal (i.e. that there is no object in this BindingData).
+  // Constructs the object and returns it. Registers the destroy operation in InjectorStorage if needed.
+  // The graph node is not modified; the caller is responsible for storing the result.
+  BindingData::object_t create(InjectorStorage& storage, 
+                               typename SemistaticGraph<TypeId, NormalizedBindingData>::node_iterator node_itr) const;
   
   bool operator==(const NormalizedBindingData& other) const;
 };
@@ -193,6 +207,14 @@ struct NormalizedMultibindingData {
   // A (casted) pointer to the std::vector<T*> of objects, or nullptr if the vector hasn't been constructed yet.
   // Can't be empty.
   std::shared_ptr<char> v;
+  
+  // True if `v' was filled before the last InjectorStorage::reset(), so its elements are stale. The vector is then refilled
+  // in place (it already has the right capacity) instead of being constructed again.
+  bool v_is_stale = false;
+  
+  // Only used for injectors with concurrent injection enabled, where it guards the construction of `v'.
+  // See InjectorStorage::getMultibindingsConcurrently().
+  int concurrent_construction_state = 0;
 };
 
 
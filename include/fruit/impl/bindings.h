@@ -66,6 +66,23 @@ struct RegisterProvider<Lambda> {};
 template <typename AnnotatedSignature, typename Lambda>
 struct RegisterProvider<Lambda, AnnotatedSignature> {};
 
+template <typename... Params>
+struct RegisterAsyncProvider;
+
+/**
+ * Registers `provider' as an async provider of C, where provider is a lambda with no captures returning
+ * a future of C or C* (see AsyncProviderTraits).
+ */
+template <typename Lambda>
+struct RegisterAsyncProvider<Lambda> {};
+
+/**
+ * Similar to RegisterAsyncProvider<Lambda>, but Lambda must have the signature AnnotatedSignature (ignoring annotations),
+ * except that it returns a future instead of the signature's return type.
+ */
+template <typename AnnotatedSignature, typename Lambda>
+struct RegisterAsyncProvider<AnnotatedSignature, Lambda> {};
+
 /**
  * Adds a multibinding for an instance (as a C&).
  */
@@ -145,6 +145,29 @@ PartialComponent<Bindings...>::registerProvider(Lambda) {
   return {{storage}};
 }
 
+template <typename... Bindings>
+template <typename Lambda>
+inline PartialComponent<fruit::impl::RegisterAsyncProvider<Lambda>, Bindings...>
+PartialComponent<Bindings...>::registerAsyncProvider(Lambda) {
+  // This checks that Lambda itself is a valid provider (e.g. that it has no captures).
+  using LambdaOp = OpFor<fruit::impl::RegisterProvider<Lambda>>;
+  (void)typename fruit::impl::meta::CheckIfError<LambdaOp>::type();
+  using Op = OpFor<fruit::impl::RegisterAsyncProvider<Lambda>>;
+  (void)typename fruit::impl::meta::CheckIfError<Op>::type();
+  return {{storage}};
+}
+
+template <typename... Bindings>
+template <typename AnnotatedSignature, typename Lambda>
+inline PartialComponent<fruit::impl::RegisterAsyncProvider<AnnotatedSignature, Lambda>, Bindings...>
+PartialComponent<Bindings...>::registerAsyncProvider(Lambda) {
+  using LambdaOp = OpFor<fruit::impl::RegisterProvider<Lambda>>;
+  (void)typename fruit::impl::meta::CheckIfError<LambdaOp>::type();
+  using Op = OpFor<fruit::impl::RegisterAsyncProvider<AnnotatedSignature, Lambda>>;
+  (void)typename fruit::impl::meta::CheckIfError<Op>::type();
+  return {{storage}};
+}
+
 template <typename... Bindings>
 template <typename AnnotatedI, typename AnnotatedC>
 inline PartialComponent<fruit::impl::AddMultibinding<AnnotatedI, AnnotatedC>, Bindings...>
@@ -277,6 +277,52 @@ struct DeferredRegisterProvider {
   };
 };
 
+struct AsyncProviderSignature {
+  template <typename Lambda>
+  struct apply {
+    using type = Type<typename fruit::impl::AsyncProviderTraits<UnwrapType<Lambda>>::Signature>;
+  };
+};
+
+struct AsyncProviderStartSignature {
+  template <typename AnnotatedSignature, typename Lambda>
+  struct apply {
+    using type = Type<typename fruit::impl::AsyncProviderSignatures<UnwrapType<AnnotatedSignature>,
+                                                                    UnwrapType<Lambda>>::StartSignature>;
+  };
+};
+
+struct AsyncProviderJoinSignature {
+  template <typename AnnotatedSignature, typename Lambda>
+  struct apply {
+    using type = Type<typename fruit::impl::AsyncProviderSignatures<UnwrapType<AnnotatedSignature>,
+                                                                    UnwrapType<Lambda>>::JoinSignature>;
+  };
+};
+
+// Registers the 2 providers described in AsyncProviderFuture, deferring the registration as for registerProvider().
+struct DeferredRegisterAsyncProviderWithAnnotations {
+  template <typename Comp, typename AnnotatedSignature, typename Lambda>
+  struct apply {
+    using Start = Type<fruit::impl::AsyncProviderStart<UnwrapType<AnnotatedSignature>, UnwrapType<Lambda>>>;
+    using Join = Type<fruit::impl::AsyncProviderJoin<UnwrapType<AnnotatedSignature>, UnwrapType<Lambda>>>;
+    using F1 = ComponentFunctor(DeferredRegisterProviderWithAnnotations,
+                                AsyncProviderStartSignature(AnnotatedSignature, Lambda), Start);
+    using F2 = ComponentFunctor(DeferredRegisterProviderWithAnnotations,
+                                AsyncProviderJoinSignature(AnnotatedSignature, Lambda), Join);
+    using type = If(Not(IsValidSignature(AnnotatedSignature)),
+                    ConstructError(NotASignatureErrorTag, AnnotatedSignature),
+                 Call(ComposeFunctors(F1, F2), Comp));
+  };
+};
+
+struct DeferredRegisterAsyncProvider {
+  template <typename Comp, typename Lambda>
+  struct apply {
+    using type = DeferredRegisterAsyncProviderWithAnnotations(Comp, AsyncProviderSignature(Lambda), Lambda);
+  };
+};
+
 // T can't be any injectable type, it must match the return type of the provider in one of
 // the registerMultibindingProvider() overloads in ComponentStorage.
 struct RegisterMultibindingProviderWithAnnotations {
@@ -1021,6 +1067,16 @@ struct ProcessBinding {
     using type = ComponentFunctor(DeferredRegisterProviderWithAnnotations, Type<AnnotatedSignature>, Type<Lambda>);
   };
 
+  template <typename Lambda>
+  struct apply<fruit::impl::RegisterAsyncProvider<Lambda>> {
+    using type = ComponentFunctor(DeferredRegisterAsyncProvider, Type<Lambda>);
+  };
+
+  template <typename AnnotatedSignature, typename Lambda>
+  struct apply<fruit::impl::RegisterAsyncProvider<AnnotatedSignature, Lambda>> {
+    using type = ComponentFunctor(DeferredRegisterAsyncProviderWithAnnotations, Type<AnnotatedSignature>, Type<Lambda>);
+  };
+
   template <typename AnnotatedC>
   struct apply<fruit::impl::AddInstanceMultibinding<AnnotatedC>> {
     using type = ComponentFunctorIdentity;
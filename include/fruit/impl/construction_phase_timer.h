@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_CONSTRUCTION_PHASE_TIMER_H
+#define FRUIT_CONSTRUCTION_PHASE_TIMER_H
+
+#ifndef IN_FRUIT_CPP_FILE
+// This is only used in the construction of NormalizedComponentStorage and InjectorStorage, so there's no need to include
+// it in public headers.
+#error "construction_phase_timer.h included in non-cpp file."
+#endif
+
+#include <fruit/construction_phase_times.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * Measures the construction of a NormalizedComponentStorage or InjectorStorage, from the constructor of this object to its
+ * destructor, recording the results in a ConstructionPhaseTimes object.
+ * The phases are measured with Phase objects, that don't need a reference to the timer: they're attributed to the
+ * innermost timer of the current thread (if any), so that the code shared with other constructions (e.g. SemistaticMap)
+ * doesn't need to pass the timer around.
+ */
+class ConstructionPhaseTimer {
+public:
+  /**
+   * Measures a single phase, from the constructor of this object to its destructor, adding the elapsed time to the
+   * specified field of the innermost timer's times. If there's no timer in the current thread, this does nothing (it
+   * doesn't even read the clock).
+   */
+  class Phase {
+  private:
+    std::uint64_t* ns;
+    std::chrono::steady_clock::time_point start;
+    
+  public:
+    explicit Phase(std::uint64_t ConstructionPhaseTimes::* field);
+    
+    Phase(const Phase&) = delete;
+    Phase& operator=(const Phase&) = delete;
+    
+    ~Phase();
+    
+    // Ends the phase before the destruction of this object. After this call, the destructor does nothing.
+    void end();
+  };
+  
+  // `times' is reset, and it's filled in when this timer is destroyed.
+  explicit ConstructionPhaseTimer(ConstructionPhaseTimes& times);
+  
+  ConstructionPhaseTimer(const ConstructionPhaseTimer&) = delete;
+  ConstructionPhaseTimer& operator=(const ConstructionPhaseTimer&) = delete;
+  
+  ~ConstructionPhaseTimer();
+  
+  // Records that a hash table selected its hash function, after rejecting `num_rejected' ones.
+  static void recordHashSelection(std::size_t num_rejected);
+  
+private:
+  ConstructionPhaseTimes& times;
+  
+  // The enclosing timer in this thread, if any.
+  ConstructionPhaseTimer* parent;
+  
+  std::chrono::steady_clock::time_point start;
+  
+  // The innermost timer of the current thread (or nullptr).
+  static thread_local ConstructionPhaseTimer* current;
+};
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_CONSTRUCTION_PHASE_TIMER_H
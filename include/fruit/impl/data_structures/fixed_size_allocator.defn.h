@@ -18,6 +18,7 @@
 #define FRUIT_FIXED_SIZE_ALLOTATOR_DEFN_H
 
 #include <fruit/impl/fruit_assert.h>
+#include <fruit/impl/util/atomic_ops.h>
 
 #include <cassert>
 
@@ -74,21 +75,54 @@ inline std::size_t FixedSizeAllocator::FixedSizeAllocatorData::maximumRequiredSp
   return type.type_info->alignment() + type.type_info->size() - 1;
 }
 
+template <typename T>
+inline T* FixedSizeAllocator::allocate(TypeId type) {
+  if (concurrent) {
+    char* last_used = atomicLoadAcquire(&storage_last_used);
+    char* p;
+    do {
+      p = last_used + alignof(T) - std::uintptr_t(last_used) % alignof(T);
+      // On failure, this updates `last_used' with the current value of storage_last_used.
+    } while (!atomicCompareExchange(&storage_last_used, last_used, p + sizeof(T) - 1));
+    FruitAssert(std::uintptr_t(p) % alignof(T) == 0);
+    if (profiling || accounting != nullptr) {
+      recordAllocation(type, p + sizeof(T) - 1 - last_used, sizeof(T));
+    }
+    return reinterpret_cast<T*>(p);
+  }
+  
+  char* p = storage_last_used;
+  size_t misalignment = std::uintptr_t(p) % alignof(T);
+  p += alignof(T) - misalignment;
+  FruitAssert(std::uintptr_t(p) % alignof(T) == 0);
+  if (profiling || accounting != nullptr) {
+    recordAllocation(type, p + sizeof(T) - 1 - storage_last_used, sizeof(T));
+  }
+  storage_last_used = p + sizeof(T) - 1;
+  return reinterpret_cast<T*>(p);
+}
+
+inline void FixedSizeAllocator::registerDestruction(destroy_t destroy, void* p) {
+  if (concurrent) {
+    on_destruction.concurrent_push_back(std::pair<destroy_t, void*>{destroy, p});
+  } else {
+    on_destruction.push_back(std::pair<destroy_t, void*>{destroy, p});
+  }
+}
+
 template <typename AnnotatedT, typename... Args>
 inline fruit::impl::meta::UnwrapType<fruit::impl::meta::Eval<fruit::impl::meta::RemoveAnnotations(fruit::impl::meta::Type<AnnotatedT>)>>* 
 FixedSizeAllocator::constructObject(Args&&... args) {
   using T = fruit::impl::meta::UnwrapType<fruit::impl::meta::Eval<fruit::impl::meta::RemoveAnnotations(fruit::impl::meta::Type<AnnotatedT>)>>;
   
-  char* p = storage_last_used;
-  size_t misalignment = std::uintptr_t(p) % alignof(T);
 #ifdef FRUIT_EXTRA_DEBUG
-  FruitAssert(remaining_types[getTypeId<AnnotatedT>()] != 0);
-  remaining_types[getTypeId<AnnotatedT>()]--;
+  // remaining_types is not thread-safe, so this check is skipped for concurrent allocations.
+  if (!concurrent) {
+    FruitAssert(remaining_types[getTypeId<AnnotatedT>()] != 0);
+    remaining_types[getTypeId<AnnotatedT>()]--;
+  }
 #endif
-  p += alignof(T) - misalignment;
-  FruitAssert(std::uintptr_t(p) % alignof(T) == 0);
-  T* x = reinterpret_cast<T*>(p);
-  storage_last_used = p + sizeof(T) - 1;
+  T* x = allocate<T>(getTypeId<AnnotatedT>());
   
   // This runs arbitrary code (T's constructor), which might end up calling
   // constructObject recursively. We must make sure all invariants are satisfied before
@@ -98,50 +132,33 @@ FixedSizeAllocator::constructObject(Args&&... args) {
   // We still run this later though, since if T's constructor throws we don't want to
   // destruct this object in FixedSizeAllocator's destructor.
   if (!std::is_trivially_destructible<T>::value) {
-    on_destruction.push_back(
-        std::pair<destroy_t, void*>{destroyObject<T>, x});
+    registerDestruction(destroyObject<T>, x);
   }
   return x;
 }
 
 template <typename T>
 inline void FixedSizeAllocator::registerExternallyAllocatedObject(T* p) {
-  on_destruction.push_back(std::pair<destroy_t, void*>{destroyExternalObject<T>, p});
+  if (profiling || accounting != nullptr) {
+    recordExternallyAllocatedObject(getTypeId<T>(), sizeof(T));
+  }
+  registerDestruction(destroyExternalObject<T>, p);
 }
 
-inline FixedSizeAllocator::FixedSizeAllocator(FixedSizeAllocatorData allocator_data)
-  : on_destruction(allocator_data.num_types_to_destroy) {
-  // The +1 is because we waste the first byte (storage_last_used points to the beginning of storage).
-  storage_begin = new char[allocator_data.total_size + 1];
-  storage_last_used = storage_begin;
-#ifdef FRUIT_EXTRA_DEBUG
-  remaining_types = allocator_data.types;
-  std::cerr << "Constructing allocator for types:";
-  for (auto x : remaining_types) {
-    std::cerr << " " << x.first;
-  }
-  std::cerr << std::endl;
-#endif
+inline void FixedSizeAllocator::enableConcurrentAllocations() {
+  concurrent = true;
 }
 
-inline FixedSizeAllocator::FixedSizeAllocator(FixedSizeAllocator&& x)
-  : FixedSizeAllocator() {
-  std::swap(storage_begin, x.storage_begin);
-  std::swap(storage_last_used, x.storage_last_used);
-  std::swap(on_destruction, x.on_destruction);
-#ifdef FRUIT_EXTRA_DEBUG
-  std::swap(remaining_types, x.remaining_types);
-#endif
+inline void FixedSizeAllocator::enableProfiling() {
+  profiling = true;
 }
 
-inline FixedSizeAllocator& FixedSizeAllocator::operator=(FixedSizeAllocator&& x) {
-  std::swap(storage_begin, x.storage_begin);
-  std::swap(storage_last_used, x.storage_last_used);
-  std::swap(on_destruction, x.on_destruction);
-#ifdef FRUIT_EXTRA_DEBUG
-  std::swap(remaining_types, x.remaining_types);
-#endif
-  return *this;
+inline std::size_t FixedSizeAllocator::getReservedBytes() const {
+  return storage_size;
+}
+
+inline std::size_t FixedSizeAllocator::getUsedBytes() const {
+  return storage_last_used - storage_begin;
 }
 
 
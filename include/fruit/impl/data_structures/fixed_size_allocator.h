@@ -21,6 +21,10 @@
 #include <fruit/impl/data_structures/fixed_size_vector.h>
 #include <fruit/impl/meta/component.h>
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #ifdef FRUIT_EXTRA_DEBUG
 #include <unordered_map>
 #endif
@@ -35,15 +39,55 @@ class FixedSizeAllocator {
 public:
   using destroy_t = void(*)(void*);  
   
+  // The allocations of a type, as reported by getTypeStats().
+  struct TypeStats {
+    // Objects constructed in the storage of this allocator.
+    std::size_t num_objects = 0;
+    
+    // The space reserved for those objects in FixedSizeAllocatorData (that's more than they need, to allow aligning them
+    // wherever they end up).
+    std::size_t reserved_bytes = 0;
+    
+    // The space actually used by those objects, including the padding needed to align them.
+    std::size_t used_bytes = 0;
+    
+    // The part of used_bytes that's padding.
+    std::size_t padding_bytes = 0;
+    
+    // Objects allocated elsewhere, registered with registerExternallyAllocatedObject().
+    std::size_t num_external_objects = 0;
+    
+    // The total sizeof() of the externally-allocated objects.
+    std::size_t external_bytes = 0;
+  };
+  
 private:
+  // Collects the TypeStats, see enableAccounting(). Defined in fixed_size_allocator.cpp.
+  class Accounting;
+  
   // A pointer to the last used byte in the allocated memory chunk starting at storage_begin.
   char* storage_last_used = nullptr;
   
   // The chunk of memory that will be used for all allocations.
   char* storage_begin = nullptr;
   
+  // The size of the chunk starting at storage_begin.
+  std::size_t storage_size = 0;
+  
+  // If true, constructObject() and registerExternallyAllocatedObject() may be called concurrently from multiple threads.
+  bool concurrent = false;
+  
+  // If true, the allocations are reported to InjectionProfiler::recordAllocation().
+  bool profiling = false;
+  
+  // If not nullptr, each allocation is recorded here.
+  std::unique_ptr<Accounting> accounting;
+  
 #ifdef FRUIT_EXTRA_DEBUG
    std::unordered_map<TypeId, std::size_t> remaining_types;
+   
+   // The types passed at construction, used to reset remaining_types in clear().
+   std::unordered_map<TypeId, std::size_t> all_types;
 #endif
   
   // This vector contains the destroy operations that have to be performed at destruction, and
@@ -59,6 +103,20 @@ private:
   template <typename C>
   static void destroyExternalObject(void* p);
   
+  // Reserves (suitably aligned) space for a T, without constructing it. `type' is only used when recording the allocation.
+  template <typename T>
+  T* allocate(TypeId type);
+  
+  void registerDestruction(destroy_t destroy, void* p);
+  
+  // Destroys all the objects registered in on_destruction, in reverse order. Used by the destructor and by clear().
+  void destroyObjects();
+  
+  // Reports an allocation to the profiler and/or to `accounting', if enabled. used_bytes includes the alignment padding.
+  // These are not inline so that this header doesn't depend on the profiler.
+  void recordAllocation(TypeId type, std::size_t used_bytes, std::size_t object_size);
+  void recordExternallyAllocatedObject(TypeId type, std::size_t object_size);
+  
 public:
   // Data used to construct an allocator for a fixed set of types.
   class FixedSizeAllocatorData {
@@ -87,7 +145,7 @@ public:
   };
   
   // Constructs an empty allocator (no allocations are allowed).
-  FixedSizeAllocator() = default;
+  FixedSizeAllocator();
   
   // Constructs an allocator for the type set in FixedSizeAllocatorData.
   FixedSizeAllocator(FixedSizeAllocatorData allocator_data);
@@ -102,6 +160,11 @@ public:
   // registerExternallyAllocatedObject() are destroyed.
   ~FixedSizeAllocator();
   
+  // Destroys all objects (as the destructor does), and then makes all the space available again, so that the same
+  // objects can be constructed again. This doesn't allocate or free any memory.
+  // This must not be called concurrently with other methods.
+  void clear();
+  
   // Allocates an object of type T, constructing it with the specified arguments. Similar to:
   // new C(args...)
   template <typename AnnotatedT, typename... Args>
@@ -109,6 +172,28 @@ public:
   
   template <typename T>
   void registerExternallyAllocatedObject(T* p);
+  
+  // After this call, constructObject() and registerExternallyAllocatedObject() can be called concurrently from multiple
+  // threads. This must be called before any such concurrent use.
+  void enableConcurrentAllocations();
+  
+  // After this call, the space used by each allocation (and the size of each externally-allocated object) is reported to
+  // the innermost construction measured by InjectionProfiler in the current thread.
+  void enableProfiling();
+  
+  // After this call, the allocations are recorded by type (see getTypeStats()). This must be called before any
+  // allocation, and not concurrently with other methods.
+  void enableAccounting();
+  
+  // The size of the storage for the objects constructed by this allocator.
+  std::size_t getReservedBytes() const;
+  
+  // The part of the storage used so far, including alignment padding.
+  std::size_t getUsedBytes() const;
+  
+  // Returns the allocations recorded since enableAccounting() (or since the last clear()), in no particular order.
+  // Returns an empty vector if enableAccounting() wasn't called.
+  std::vector<std::pair<TypeId, TypeStats>> getTypeStats() const;
 };
 
 } // namespace impl
@@ -20,10 +20,12 @@
 #include <fruit/impl/data_structures/fixed_size_vector.h>
 
 #include <fruit/impl/fruit_assert.h>
+#include <fruit/impl/util/atomic_ops.h>
 
 #include <utility>
 #include <cassert>
 #include <cstring>
+#include <new>
 
 namespace fruit {
 namespace impl {
@@ -97,6 +99,18 @@ inline void FixedSizeVector<T>::push_back(T x) {
 #endif
 }
 
+template <typename T>
+inline void FixedSizeVector<T>::concurrent_push_back(T x) {
+  T* p = atomicLoadAcquire(&v_end);
+  // On failure, this updates `p' with the current value of v_end.
+  while (!atomicCompareExchange(&v_end, p, p + 1)) {
+  }
+#ifdef FRUIT_EXTRA_DEBUG
+  FruitAssert(p + 1 <= v_end_of_storage);
+#endif
+  new (p) T(x);
+}
+
 // This method is covered by tests, even though lcov doesn't detect that.
 template <typename T>
 inline T* FixedSizeVector<T>::data() {
@@ -65,6 +65,10 @@ public:
   // This yields undefined behavior (instead of reallocating) if the vector's capacity is exceeded.
   void push_back(T x);
   
+  // Similar to push_back(), but multiple threads can call this concurrently (as long as no other method is called
+  // concurrently). The relative order of elements added by concurrent calls is unspecified.
+  void concurrent_push_back(T x);
+  
   void swap(FixedSizeVector& x);
   
   // Removes all elements, so size() becomes 0 (but maintains the capacity).
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INSTANCE_TABLE_DEFN_H
+#define FRUIT_INSTANCE_TABLE_DEFN_H
+
+#include <fruit/impl/data_structures/instance_table.h>
+#include <fruit/impl/fruit_assert.h>
+#include <fruit/impl/util/atomic_ops.h>
+
+#include <utility>
+
+namespace fruit {
+namespace impl {
+
+inline InstanceTable::InstanceTable(InstanceTable&& other)
+  : InstanceTable() {
+  std::swap(objects, other.objects);
+  std::swap(in_progress, other.in_progress);
+}
+
+inline InstanceTable& InstanceTable::operator=(InstanceTable&& other) {
+  std::swap(objects, other.objects);
+  std::swap(in_progress, other.in_progress);
+  return *this;
+}
+
+inline void* InstanceTable::get(std::size_t index) const {
+  return atomicLoadAcquire(&objects[index]);
+}
+
+inline void InstanceTable::set(std::size_t index, void* object) {
+  FruitAssert(object != nullptr);
+  atomicStoreRelease(&objects[index], object);
+}
+
+inline bool InstanceTable::tryMarkAsInProgress(std::size_t index) {
+  std::uint64_t bit = std::uint64_t(1) << (index % bits_per_word);
+  return (atomicFetchOr(&in_progress[index / bits_per_word], bit) & bit) == 0;
+}
+
+inline void InstanceTable::clearInProgress(std::size_t index) {
+  std::uint64_t bit = std::uint64_t(1) << (index % bits_per_word);
+  FruitAssert((in_progress[index / bits_per_word] & bit) != 0);
+  atomicFetchAnd(&in_progress[index / bits_per_word], ~bit);
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_INSTANCE_TABLE_DEFN_H
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INSTANCE_TABLE_H
+#define FRUIT_INSTANCE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * A table of object pointers indexed by a number in [0, size), where all elements are initially nullptr. Each element
+ * also has an "in progress" bit, used to construct each object at most once when multiple threads need it.
+ * 
+ * The object pointers and the bitmap are stored in a single zero-initialized allocation. For large tables the zeroing is
+ * done lazily by the OS (calloc() gets fresh zero pages), so only the parts of the table that are actually used are
+ * touched.
+ * 
+ * All methods except the constructors, the destructor and the assignment operator can be called concurrently from
+ * multiple threads.
+ */
+class InstanceTable {
+private:
+  static constexpr std::size_t bits_per_word = 64;
+  
+  // objects[i] is the object for index i, or nullptr if none was stored yet.
+  // This points to the beginning of the allocation.
+  void** objects = nullptr;
+  
+  // Bit (i % bits_per_word) of in_progress[i / bits_per_word] is set iff index i is marked as in progress.
+  // This points into the same allocation as `objects', right after the last object.
+  std::uint64_t* in_progress = nullptr;
+  
+public:
+  // Constructs an *invalid* table (as if it was just moved from).
+  InstanceTable() = default;
+  
+  explicit InstanceTable(std::size_t size);
+  
+  InstanceTable(InstanceTable&& other);
+  InstanceTable(const InstanceTable&) = delete;
+  
+  InstanceTable& operator=(InstanceTable&& other);
+  InstanceTable& operator=(const InstanceTable&) = delete;
+  
+  ~InstanceTable();
+  
+  // Returns the object stored for the specified index, or nullptr if none was stored yet.
+  void* get(std::size_t index) const;
+  
+  // Stores an object for the specified index. `object' must not be nullptr.
+  // Any thread that sees this object in a get() also sees all writes made by this thread before the set().
+  void set(std::size_t index, void* object);
+  
+  // Marks the specified index as in progress. Returns false if it was already marked (so the mark is owned by someone else).
+  bool tryMarkAsInProgress(std::size_t index);
+  
+  // Removes the mark set by a successful tryMarkAsInProgress() call.
+  void clearInProgress(std::size_t index);
+  
+  // Sets all elements back to nullptr and removes all marks, reusing the same allocation.
+  // This must not be called concurrently with other methods.
+  void clear();
+  
+  // Returns the size of the memory allocated for this table.
+  std::size_t getAllocatedBytes() const;
+};
+
+} // namespace impl
+} // namespace fruit
+
+#include <fruit/impl/data_structures/instance_table.defn.h>
+
+#endif // FRUIT_INSTANCE_TABLE_H
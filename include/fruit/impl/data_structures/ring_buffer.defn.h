@@ -0,0 +1,73 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_RING_BUFFER_DEFN_H
+#define FRUIT_RING_BUFFER_DEFN_H
+
+#include <fruit/impl/data_structures/ring_buffer.h>
+
+#include <fruit/impl/fruit_assert.h>
+
+namespace fruit {
+namespace impl {
+
+template <typename T>
+inline RingBuffer<T>::RingBuffer(std::size_t capacity)
+  : elements(new T[capacity]), mask(capacity - 1), head(0), tail(0) {
+  FruitAssert(capacity != 0 && (capacity & mask) == 0);
+}
+
+template <typename T>
+inline RingBuffer<T>::~RingBuffer() {
+  delete [] elements;
+}
+
+template <typename T>
+inline std::size_t RingBuffer<T>::capacity() const {
+  return mask + 1;
+}
+
+template <typename T>
+inline bool RingBuffer<T>::tryPush(const T& x) {
+  // Only this thread modifies head.
+  std::size_t current_head = head.load(std::memory_order_relaxed);
+  // Synchronizes with the release store in popAll(), so that the consumer is done reading the slot before we overwrite
+  // it.
+  if (current_head - tail.load(std::memory_order_acquire) > mask) {
+    return false;
+  }
+  elements[current_head & mask] = x;
+  head.store(current_head + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+template <typename F>
+inline std::size_t RingBuffer<T>::popAll(F f) {
+  // Only this thread modifies tail.
+  std::size_t current_tail = tail.load(std::memory_order_relaxed);
+  std::size_t current_head = head.load(std::memory_order_acquire);
+  for (std::size_t i = current_tail; i != current_head; ++i) {
+    f(elements[i & mask]);
+  }
+  tail.store(current_head, std::memory_order_release);
+  return current_head - current_tail;
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_RING_BUFFER_DEFN_H
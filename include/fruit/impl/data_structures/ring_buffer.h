@@ -0,0 +1,77 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_RING_BUFFER_H
+#define FRUIT_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * A fixed-capacity FIFO queue with a single producer thread and a single consumer thread, that can run concurrently.
+ * Neither side ever blocks or allocates: when the buffer is full, tryPush() fails instead.
+ * The type T must be trivially copyable.
+ */
+template <typename T>
+class RingBuffer {
+private:
+  T* elements;
+  
+  // The capacity minus 1. The capacity is a power of 2, so this is a bitmask to go from positions to indexes.
+  std::size_t mask;
+  
+  // head and tail are in separate cache lines, so that the producer and the consumer don't keep invalidating each
+  // other's cache.
+  static constexpr std::size_t cache_line_size = 64;
+  
+  // The number of elements pushed so far. Only modified by the producer.
+  std::atomic<std::size_t> head;
+  char head_padding[cache_line_size - sizeof(std::atomic<std::size_t>)];
+  
+  // The number of elements popped so far. Only modified by the consumer.
+  std::atomic<std::size_t> tail;
+  char tail_padding[cache_line_size - sizeof(std::atomic<std::size_t>)];
+  
+public:
+  // The capacity must be a power of 2.
+  explicit RingBuffer(std::size_t capacity);
+  ~RingBuffer();
+  
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+  
+  std::size_t capacity() const;
+  
+  // Appends x to the buffer, unless it's full. Returns false if it was full.
+  // Must only be called by the producer thread.
+  bool tryPush(const T& x);
+  
+  // Removes all the elements in the buffer (in FIFO order), calling f(element) on each of them.
+  // The elements pushed concurrently with this call might or might not be included.
+  // Returns the number of elements removed. Must only be called by the consumer thread.
+  template <typename F>
+  std::size_t popAll(F f);
+};
+
+} // namespace impl
+} // namespace fruit
+
+#include <fruit/impl/data_structures/ring_buffer.defn.h>
+
+#endif // FRUIT_RING_BUFFER_H
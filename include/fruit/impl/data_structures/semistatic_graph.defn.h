@@ -31,8 +31,8 @@ inline bool SemistaticGraphInternalNodeId::operator<(const SemistaticGraphIntern
 }
 
 template <typename NodeId, typename Node>
-inline SemistaticGraph<NodeId, Node>::node_iterator::node_iterator(NodeData* itr) 
-  : itr(itr) {
+inline SemistaticGraph<NodeId, Node>::node_iterator::node_iterator(NodeData* itr, std::size_t index) 
+  : itr(itr), index(index) {
 }
 
 template <typename NodeId, typename Node>
@@ -48,9 +48,8 @@ inline bool SemistaticGraph<NodeId, Node>::node_iterator::isTerminal() {
 }
 
 template <typename NodeId, typename Node>
-inline void SemistaticGraph<NodeId, Node>::node_iterator::setTerminal() {
-  FruitAssert(itr->edges_begin != 1);
-  itr->edges_begin = 0;
+inline std::size_t SemistaticGraph<NodeId, Node>::node_iterator::getIndex() {
+  return index;
 }
 
 template <typename NodeId, typename Node>
@@ -95,8 +94,8 @@ inline SemistaticGraph<NodeId, Node>::edge_iterator::edge_iterator(InternalNodeI
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::edge_iterator::getNodeIterator(
-    node_iterator nodes_begin) {
-  return node_iterator{nodeAtId(nodes_begin.itr, *itr)};
+    SemistaticGraph& graph) {
+  return node_iterator{graph.nodeAtId(*itr), itr->id};
 }
 
 template <typename NodeId, typename Node>
@@ -106,41 +105,41 @@ inline void SemistaticGraph<NodeId, Node>::edge_iterator::operator++() {
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::edge_iterator::getNodeIterator(
-    std::size_t i, node_iterator nodes_begin) {
+    std::size_t i, SemistaticGraph& graph) {
   itr += i;
-  return getNodeIterator(nodes_begin);
+  return getNodeIterator(graph);
 }
 
 template <typename NodeId, typename Node>
-inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::begin() {
-  return node_iterator{nodes.begin()};
+inline std::size_t SemistaticGraph<NodeId, Node>::size() const {
+  return first_unused_index;
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::end() {
-  return node_iterator{nodes.end()};
+  return node_iterator{nullptr, 0};
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::const_node_iterator SemistaticGraph<NodeId, Node>::end() const {
-  return const_node_iterator{nodes.end()};
+  return const_node_iterator{nullptr};
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::at(NodeId nodeId) {
-  InternalNodeId internalNodeId = node_index_map.at(nodeId);
-  return node_iterator{nodeAtId(internalNodeId)};
+  InternalNodeId internalNodeId = nodeIndexMap().at(nodeId);
+  return node_iterator{nodeAtId(internalNodeId), internalNodeId.id};
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::const_node_iterator SemistaticGraph<NodeId, Node>::find(NodeId nodeId) const {
-  const InternalNodeId* internalNodeIdPtr = node_index_map.find(nodeId);
+  const InternalNodeId* internalNodeIdPtr = nodeIndexMap().find(nodeId);
   if (internalNodeIdPtr == nullptr) {
-    return const_node_iterator{nodes.end()};
+    return end();
   } else {
     const NodeData* p = nodeAtId(*internalNodeIdPtr);
     if (p->edges_begin == 1) {
-      return const_node_iterator{nodes.end()};
+      return end();
     }
     return const_node_iterator{p};
   }
@@ -148,44 +147,75 @@ inline typename SemistaticGraph<NodeId, Node>::const_node_iterator SemistaticGra
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::find(NodeId nodeId) {
-  const InternalNodeId* internalNodeIdPtr = node_index_map.find(nodeId);
+  const InternalNodeId* internalNodeIdPtr = nodeIndexMap().find(nodeId);
   if (internalNodeIdPtr == nullptr) {
-    return node_iterator{nodes.end()};
+    return end();
   } else {
     NodeData* p = nodeAtId(*internalNodeIdPtr);
     if (p->edges_begin == 1) {
-      return node_iterator{nodes.end()};
+      return end();
     }
-    return node_iterator{p};
+    return node_iterator{p, internalNodeIdPtr->id};
+  }
+}
+
+template <typename NodeId, typename Node>
+inline typename SemistaticGraph<NodeId, Node>::node_iterator
+SemistaticGraph<NodeId, Node>::findIncludingReferencedNodes(NodeId nodeId) {
+  const InternalNodeId* internalNodeIdPtr = nodeIndexMap().find(nodeId);
+  if (internalNodeIdPtr == nullptr) {
+    return end();
   }
+  return node_iterator{nodeAtId(*internalNodeIdPtr), internalNodeIdPtr->id};
+}
+
+template <typename NodeId, typename Node>
+inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::atIndex(std::size_t index) {
+  FruitAssert(index < size());
+  NodeData* nodeData = nodeAtId(internalNodeIdForIndex(index));
+  FruitAssert(nodeData->edges_begin != 1);
+  return node_iterator{nodeData, index};
+}
+
+template <typename NodeId, typename Node>
+inline void SemistaticGraph<NodeId, Node>::setTerminalNodeValue(std::size_t index, Node value) {
+  NodeData* nodeData = nodeAtId(internalNodeIdForIndex(index));
+  FruitAssert(nodeData->edges_begin == 0);
+  FruitAssert(owned_nodes.data() <= nodeData && nodeData < owned_nodes.data() + owned_nodes.size());
+  nodeData->node = value;
+}
+
+template <typename NodeId, typename Node>
+inline const SemistaticMap<NodeId, typename SemistaticGraph<NodeId, Node>::InternalNodeId>&
+SemistaticGraph<NodeId, Node>::nodeIndexMap() const {
+  return (base_node_index_map != nullptr) ? *base_node_index_map : node_index_map;
+}
+
+template <typename NodeId, typename Node>
+inline typename SemistaticGraph<NodeId, Node>::InternalNodeId
+SemistaticGraph<NodeId, Node>::internalNodeIdForIndex(std::size_t index) {
+  FruitAssert(index <= std::numeric_limits<std::uint32_t>::max());
+  return InternalNodeId{static_cast<std::uint32_t>(index)};
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::NodeData* SemistaticGraph<NodeId, Node>::nodeAtId(InternalNodeId internalNodeId) {
-  return nodeAtId(nodes.data(), internalNodeId);
+  return nodeAtId(node_pages.data(), internalNodeId);
 }
 
 template <typename NodeId, typename Node>
 inline const typename SemistaticGraph<NodeId, Node>::NodeData* SemistaticGraph<NodeId, Node>::nodeAtId(InternalNodeId internalNodeId) const {
-  return nodeAtId(nodes.data(), internalNodeId);
+  return nodeAtId(node_pages.data(), internalNodeId);
 }
 
 template <typename NodeId, typename Node>
-inline typename SemistaticGraph<NodeId, Node>::NodeData* SemistaticGraph<NodeId, Node>::nodeAtId(NodeData* nodes_begin, InternalNodeId internalNodeId) {
-  FruitAssert(internalNodeId.id % sizeof(NodeData) == 0);
-  NodeData* p = reinterpret_cast<NodeData*>(reinterpret_cast<char*>(nodes_begin) + internalNodeId.id);
-  // The code above is faster (the compiler doesn't have to worry about internalNodeId.id%sizeof(NodeData), that we know to be 0).
-  FruitAssert(p == nodes_begin + internalNodeId.id/sizeof(NodeData));
-  return p;
+inline typename SemistaticGraph<NodeId, Node>::NodeData* SemistaticGraph<NodeId, Node>::nodeAtId(NodeData* const* node_pages, InternalNodeId internalNodeId) {
+  return node_pages[internalNodeId.id >> node_page_bits] + (internalNodeId.id & (node_page_size - 1));
 }
 
 template <typename NodeId, typename Node>
-inline const typename SemistaticGraph<NodeId, Node>::NodeData* SemistaticGraph<NodeId, Node>::nodeAtId(const NodeData* nodes_begin, InternalNodeId internalNodeId) {
-  FruitAssert(internalNodeId.id % sizeof(NodeData) == 0);
-  const NodeData* p = reinterpret_cast<const NodeData*>(reinterpret_cast<const char*>(nodes_begin) + internalNodeId.id);
-  // The code above is faster (the compiler doesn't have to worry about internalNodeId.id%sizeof(NodeData), that we know to be 0).
-  FruitAssert(p == nodes_begin + internalNodeId.id/sizeof(NodeData));
-  return p;
+inline const typename SemistaticGraph<NodeId, Node>::NodeData* SemistaticGraph<NodeId, Node>::nodeAtId(const NodeData* const* node_pages, InternalNodeId internalNodeId) {
+  return node_pages[internalNodeId.id >> node_page_bits] + (internalNodeId.id & (node_page_size - 1));
 }
 
 } // namespace impl
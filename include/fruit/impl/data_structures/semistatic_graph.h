@@ -19,6 +19,9 @@
 
 #include <fruit/impl/data_structures/semistatic_map.h>
 
+#include <cstdint>
+#include <limits>
+
 #ifdef FRUIT_EXTRA_DEBUG
 #include <iostream>
 #endif
@@ -26,40 +29,47 @@
 namespace fruit {
 namespace impl {
 
-// The alignas ensures that a SemistaticGraphInternalNodeId* always has 0 in the low-order bit.
-struct alignas(2) alignas(alignof(std::size_t)) SemistaticGraphInternalNodeId {
-  // This stores the index in the vector times sizeof(NodeData).
-  std::size_t id;
+// Identifies a node by its index, so it doesn't depend on where the node is stored and it stays valid in the graphs that
+// extend this one. Terminal nodes are marked with edges_begin==0 in NodeData, not with a tag in the id.
+struct SemistaticGraphInternalNodeId {
+  // The index of the node (see SemistaticGraph::node_iterator::getIndex()).
+  // This is 32-bit so that edges_storage (where each edge is an InternalNodeId) takes half the space, since a graph never
+  // has 2^32 nodes.
+  std::uint32_t id;
   
   bool operator==(const SemistaticGraphInternalNodeId& x) const;
   bool operator<(const SemistaticGraphInternalNodeId& x) const;
 };
 
 /**
- * A direct graph implementation where most of the graph is fixed at construction time, but a few nodes and edges can be added
- * later.
+ * A direct graph implementation where the graph is fixed at construction time. Nodes can be added by constructing a new graph
+ * that extends an existing one; the new graph shares most of its data with the existing one.
  * 
  * Also, nodes can either be normal nodes or terminal nodes. Terminal nodes can't have outgoing edges. Note that a node with no
  * outgoing edges may or may not be marked as terminal.
  * 
- * While insertion of elements after construction is supported, inserting or changing the neighbors of more than O(1) nodes
- * after construction will raise the cost of any further operations to more than O(1).
- * 
- * Even though adding nodes/edges after construction is inefficient, it is efficient to turn non-terminal nodes into terminal ones
- * (and therefore removing all the outgoing edges from the node) after construction.
+ * Each node has an index in [0, size()). Nodes are stored in pages of node_page_size nodes, so that a graph that extends another
+ * one only needs to store the pages containing the new or changed nodes.
  * 
- * NodeId and Node must be default constructible and trivially copyable.
+ * NodeId and Node must be default constructible and trivially copyable, and NodeId must be ordered by operator<.
  */
 template <typename NodeId, typename Node>
 class SemistaticGraph {
 private:
   using InternalNodeId = SemistaticGraphInternalNodeId;
   
-  // The node data for nodeId is in nodes[node_index_map.at(nodeId)/sizeof(NodeData)].
-  // To avoid hash table lookups, the edges in edges_storage are stored as indexes of `nodes' instead of as NodeIds.
-  // node_index_map contains all known NodeIds, including ones known only due to an outgoing edge ending there from another node.
+  static constexpr std::size_t node_page_bits = 6;
+  static constexpr std::size_t node_page_size = std::size_t(1) << node_page_bits;
+  
+  // The node data for nodeId is at nodeAtId(nodeIndexMap().at(nodeId)).
+  // To avoid hash table lookups, the edges in edges_storage are stored as node indexes instead of as NodeIds.
+  // nodeIndexMap() contains all known NodeIds, including ones known only due to an outgoing edge ending there from another node.
   SemistaticMap<NodeId, InternalNodeId> node_index_map;
   
+  // If this graph extends another one but has no NodeIds of its own, node_index_map is left empty and this points to the
+  // map of the extended graph instead, so that lookups don't need to probe an empty table first. Otherwise, nullptr.
+  const SemistaticMap<NodeId, InternalNodeId>* base_node_index_map = nullptr;
+  
   struct NodeData {
 #ifdef FRUIT_EXTRA_DEBUG
     NodeId key;
@@ -79,10 +89,15 @@ private:
   
   std::size_t first_unused_index;
   
-  FixedSizeVector<NodeData> nodes;
+  // node_pages[i] points to the NodeData elements for the nodes with index in [i*node_page_size, (i+1)*node_page_size).
+  // A page can be either in owned_nodes or in the owned_nodes of the graph that this graph extends.
+  FixedSizeVector<NodeData*> node_pages;
+  
+  // The pages owned by this graph, stored contiguously.
+  FixedSizeVector<NodeData> owned_nodes;
   
   // Stores vectors of edges as contiguous chunks of node IDs.
-  // The NodeData elements in `nodes' contain indexes into this vector (stored as already multiplied by sizeof(NodeData)).
+  // The NodeData elements in `owned_nodes' point to elements of this vector.
   // The first element is unused.
   FixedSizeVector<InternalNodeId> edges_storage;
   
@@ -91,11 +106,20 @@ private:
   void printGraph(NodeIter first, NodeIter last);
 #endif
   
+  // Returns the map that contains all the NodeIds of this graph: *base_node_index_map if set, node_index_map otherwise.
+  const SemistaticMap<NodeId, InternalNodeId>& nodeIndexMap() const;
+  
+  // Returns the InternalNodeId for the node with the specified index. Precondition: index < 2^32.
+  static InternalNodeId internalNodeIdForIndex(std::size_t index);
+  
+  // Appends a page to owned_nodes (and node_pages), with all nodes marked as non-existent.
+  void addEmptyPage();
+  
   NodeData* nodeAtId(InternalNodeId internalNodeId);
   const NodeData* nodeAtId(InternalNodeId internalNodeId) const;
   
-  static NodeData* nodeAtId(NodeData* nodes_begin, InternalNodeId internalNodeId);  
-  static const NodeData* nodeAtId(const NodeData* nodes_begin, InternalNodeId internalNodeId);
+  static NodeData* nodeAtId(NodeData* const* node_pages, InternalNodeId internalNodeId);
+  static const NodeData* nodeAtId(const NodeData* const* node_pages, InternalNodeId internalNodeId);
     
 public:
   
@@ -104,18 +128,20 @@ public:
   class node_iterator {
   private:
     NodeData* itr;
+    std::size_t index;
     
     friend class SemistaticGraph<NodeId, Node>;
     
-    node_iterator(NodeData* itr);
+    node_iterator(NodeData* itr, std::size_t index);
     
   public:
     Node& getNode();
     
     bool isTerminal();
     
-    // Turns the node into a terminal node, also removing all the deps.
-    void setTerminal();
+    // Returns the index of this node. Indexes are in [0, size()) and are preserved in graphs that extend this one, so they
+    // can be used to store additional (e.g. mutable) data for each node outside of the graph.
+    std::size_t getIndex();
   
     // Assumes !isTerminal().
     // neighborsEnd() is NOT provided/stored for efficiency, the client code is expected to know the number of neighbors.
@@ -151,13 +177,14 @@ public:
     edge_iterator(InternalNodeId* itr);
 
   public:
-    // getNodeIterator(graph.nodes.begin()) returns the first neighbor.
-    node_iterator getNodeIterator(node_iterator nodes_begin);
+    // getNodeIterator(graph) returns the first neighbor.
+    // `graph' must be the graph containing the node, or a graph that extends it.
+    node_iterator getNodeIterator(SemistaticGraph& graph);
     
     void operator++();
     
-    // Equivalent to i times operator++ followed by getNodeIterator(nodes_begin).
-    node_iterator getNodeIterator(std::size_t i, node_iterator nodes_begin);
+    // Equivalent to i times operator++ followed by getNodeIterator(graph).
+    node_iterator getNodeIterator(std::size_t i, SemistaticGraph& graph);
   };
   
   // Constructs an *invalid* graph (as if this graph was just moved from).
@@ -169,29 +196,42 @@ public:
   // * x.isTerminal(), returning a bool
   // * x.getEdgesBegin() and x.getEdgesEnd(), that if !x.isTerminal() define a range of values of type NodeId (the outgoing edges).
   // 
+  // 
+  // The nodes are stored in DFS post-order, starting from the nodes in `roots' (e.g. the exposed types of an injector),
+  // so that a node and the nodes it depends on are close in memory. Roots that are not nodes of the graph are ignored.
+  // 
   // This constructor is *not* defined in semistatic_graph.templates.h, but only in semistatic_graph.cc.
   // All instantiations must have a matching instantiation in semistatic_graph.cc.
   template <typename NodeIter>
-  SemistaticGraph(NodeIter first, NodeIter last, NodeId invalidNodeId1, NodeId invalidNodeId2);
+  SemistaticGraph(NodeIter first, NodeIter last, const std::vector<NodeId>& roots = std::vector<NodeId>{});
   
   SemistaticGraph(SemistaticGraph&&) = default;
   SemistaticGraph(const SemistaticGraph&) = delete;
   
-  // Creates a copy of x with the additional nodes in [first, last). The requirements on NodeIter as the same as for the 2-arg
-  // constructor.
-  // The nodes in [first, last) must NOT be already in x, but can be neighbors of nodes in x.
-  // The new graph will share data with `x', so must be destroyed before `x' is destroyed.
-  // Also, after this is called, `x' must not be modified until this object has been destroyed.
+  // Creates a graph with the nodes of x and the additional nodes in [first, last). The requirements on NodeIter as the same as
+  // for the 2-arg constructor.
+  // The nodes in [first, last) can be neighbors of nodes in x. They can also be already in x, in which case they replace the
+  // corresponding node of x (in the new graph only).
+  // The new graph will share data with `x', so must be destroyed before `x' is destroyed. Only the pages containing new or
+  // replaced nodes are copied.
+  // Also, after this is called, `x' must not be modified or moved until this object has been destroyed.
   template <typename NodeIter>
   SemistaticGraph(const SemistaticGraph& x, NodeIter first, NodeIter last);
   
+  // Creates a graph with the nodes of x, where the nodes with index terminal_nodes[i].first (for i in
+  // [0, num_terminal_nodes)) are replaced by terminal nodes with value terminal_nodes[i].second. These indexes must be
+  // indexes of nodes of x, or of nodes that are only referenced by an edge in x.
+  // Unlike the previous constructor, this doesn't need to look up any NodeId, and the NodeIds of the new graph are looked
+  // up in x's map. As for the previous constructor, the new graph shares data with `x'.
+  SemistaticGraph(const SemistaticGraph& x, const std::pair<std::size_t, Node>* terminal_nodes, std::size_t num_terminal_nodes);
+  
   ~SemistaticGraph();
   
   SemistaticGraph& operator=(const SemistaticGraph&) = delete;
   SemistaticGraph& operator=(SemistaticGraph&&) = default;
   
-  // The result is unspecified. The only guarantee is that it's the right value to pass to edge_iterator's getNodeIterator() methods.
-  node_iterator begin();
+  // Returns the number of node indexes used by this graph; all node indexes are smaller than this.
+  std::size_t size() const;
   
   node_iterator end();
   const_node_iterator end() const;
@@ -205,6 +245,33 @@ public:
   node_iterator find(NodeId nodeId);
   const_node_iterator find(NodeId nodeId) const;
   
+  // Similar to find(), but also finds the nodes that are only referenced by an edge of another node (for which find()
+  // returns end()). For such nodes, only getIndex() can be called on the result.
+  node_iterator findIncludingReferencedNodes(NodeId nodeId);
+  
+  // Returns the node with the specified index. Precondition: the node with that index must exist in the graph (not just
+  // be referenced by an edge).
+  node_iterator atIndex(std::size_t index);
+  
+  // Changes the value of the terminal node with the specified index. The node must be in a page owned by this graph, e.g.
+  // one of the nodes set by the constructor that takes terminal nodes by index.
+  void setTerminalNodeValue(std::size_t index, Node value);
+  
+  // Returns a vector v of size size() where v[i] is the NodeId of the node with index i (including nodes that are only
+  // referenced by an edge). This is slow, don't use it in the injection path.
+  // This is only defined in semistatic_graph.templates.h.
+  std::vector<NodeId> getNodeIds() const;
+  
+  // Returns the number of bytes allocated by this graph, excluding the data shared with the graph that it extends (if any).
+  // This is only defined in semistatic_graph.templates.h.
+  std::size_t getAllocatedBytes() const;
+  
+  // Calls f(index, num_bytes) for each node stored in a page owned by this graph (i.e. not shared with the graph that it
+  // extends), where num_bytes is the space used by the node and by the outgoing edges stored in this graph.
+  // This is slow, don't use it in the injection path. This is only defined in semistatic_graph.templates.h.
+  template <typename F>
+  void forEachOwnedNode(F f) const;
+  
 #ifdef FRUIT_EXTRA_DEBUG
   // Emits a runtime error if some node was not created but there is an edge pointing to it.
   void checkFullyConstructed();
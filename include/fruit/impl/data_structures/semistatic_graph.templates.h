@@ -23,8 +23,12 @@
 
 #include <fruit/impl/data_structures/semistatic_graph.h>
 #include <fruit/impl/data_structures/semistatic_map.templates.h>
-#include <fruit/impl/util/sparsehash_helpers.h>
 #include <fruit/impl/data_structures/fixed_size_vector.templates.h>
+#include <fruit/impl/util/radix_sort.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
 
 #ifdef FRUIT_EXTRA_DEBUG
 #include <iostream>
@@ -33,21 +37,6 @@
 namespace fruit {
 namespace impl {
 
-template <typename Iter, std::size_t index_increment>
-struct indexing_iterator {
-  Iter iter;
-  std::size_t index;
-  
-  void operator++() {
-    ++iter;
-    index += index_increment;
-  }
-  
-  auto operator*() -> decltype(std::make_pair(*iter, SemistaticGraphInternalNodeId{index})) {
-    return std::make_pair(*iter, SemistaticGraphInternalNodeId{index});
-  }
-};
-
 #ifdef FRUIT_EXTRA_DEBUG
 template <typename NodeId, typename Node>
 template <typename NodeIter>
@@ -73,54 +62,186 @@ void SemistaticGraph<NodeId, Node>::printGraph(NodeIter first, NodeIter last) {
 }
 #endif // FRUIT_EXTRA_DEBUG
 
+template <typename NodeId, typename Node>
+void SemistaticGraph<NodeId, Node>::addEmptyPage() {
+  node_pages.push_back(owned_nodes.data() + owned_nodes.size());
+  for (std::size_t i = 0; i < node_page_size; ++i) {
+    owned_nodes.push_back(NodeData{
+#ifdef FRUIT_EXTRA_DEBUG
+      NodeId(),
+#endif
+      1,
+      Node()});
+  }
+}
+
 template <typename NodeId, typename Node>
 template <typename NodeIter>
-SemistaticGraph<NodeId, Node>::SemistaticGraph(
-  NodeIter first, NodeIter last, NodeId invalidNodeId1, NodeId invalidNodeId2) {
-  std::size_t num_edges = 0;
-  
+SemistaticGraph<NodeId, Node>::SemistaticGraph(NodeIter first, NodeIter last, const std::vector<NodeId>& roots) {
   // Step 1: assign IDs to all nodes, fill node_index_map and set first_unused_index.
-  HashSet<NodeId> node_ids = createHashSet(last - first, invalidNodeId1, invalidNodeId2);
+  // IDs are assigned in DFS post-order, starting from the roots and then from the other nodes in [first, last). So the
+  // nodes reachable from a node usually get the IDs right before it, and are stored in the same or in nearby cache lines.
+  
+  // Step 1a: number the NodeIds without using hash tables. All the NodeIds (one entry for each node and one for each
+  // edge) are gathered in a single vector and sorted by (std::hash<NodeId>, NodeId), and then each NodeId gets a "rank"
+  // (its position among the distinct NodeIds). Entry i is the i-th node of [first, last) for i < num_nodes, and the
+  // edges of the i-th node are the entries in [edges_begin_by_node[i], edges_begin_by_node[i+1]).
+  std::size_t num_nodes = last - first;
+  std::vector<std::size_t> edges_begin_by_node;
+  edges_begin_by_node.reserve(num_nodes + 1);
+  std::size_t num_entries = num_nodes;
+  for (NodeIter i = first; i != last; ++i) {
+    edges_begin_by_node.push_back(num_entries);
+    if (!i->isTerminal()) {
+      num_entries += i->getEdgesEnd() - i->getEdgesBegin();
+    }
+  }
+  edges_begin_by_node.push_back(num_entries);
+  std::size_t num_edges = num_entries - num_nodes;
+  
+  std::vector<std::pair<NodeId, std::size_t>> entries;
+  entries.reserve(num_entries);
+  for (NodeIter i = first; i != last; ++i) {
+    entries.emplace_back(i->getId(), entries.size());
+  }
   for (NodeIter i = first; i != last; ++i) {
-    node_ids.insert(i->getId());
     if (!i->isTerminal()) {
       for (auto j = i->getEdgesBegin(); j != i->getEdgesEnd(); ++j) {
-        node_ids.insert(*j);
-        ++num_edges;
+        entries.emplace_back(*j, entries.size());
       }
     }
   }
+  std::hash<NodeId> hash;
+  radixSort(entries, [&hash](const std::pair<NodeId, std::size_t>& entry) {
+    return hash(entry.first);
+  });
+  // Different NodeIds can have the same hash, so the entries with the same hash are also sorted by NodeId (so that equal
+  // NodeIds are adjacent). This is rarely needed: TypeIds only have the same hash with FRUIT_HASH_TYPE_IDS_BY_FINGERPRINT,
+  // for types with the same name in different translation units (e.g. in anonymous namespaces).
+  for (auto run_begin = entries.begin(); run_begin != entries.end(); /* no increment */) {
+    std::size_t run_hash = hash(run_begin->first);
+    bool all_equal = true;
+    auto run_end = run_begin + 1;
+    for (; run_end != entries.end() && hash(run_end->first) == run_hash; ++run_end) {
+      all_equal = all_equal && run_end->first == run_begin->first;
+    }
+    if (!all_equal) {
+      std::sort(run_begin, run_end);
+    }
+    run_begin = run_end;
+  }
+  auto nodeIdLessThan = [&hash](NodeId x, NodeId y) {
+    return hash(x) < hash(y) || (hash(x) == hash(y) && x < y);
+  };
+  
+  std::vector<NodeId> node_id_by_rank;
+  std::vector<std::size_t> rank_by_entry(num_entries);
+  for (const std::pair<NodeId, std::size_t>& entry : entries) {
+    if (node_id_by_rank.empty() || !(node_id_by_rank.back() == entry.first)) {
+      node_id_by_rank.push_back(entry.first);
+    }
+    rank_by_entry[entry.second] = node_id_by_rank.size() - 1;
+  }
+  std::size_t num_ranks = node_id_by_rank.size();
   
-  using itr_t = typename HashSet<NodeId>::iterator;
-  node_index_map = SemistaticMap<NodeId, InternalNodeId>(indexing_iterator<itr_t, sizeof(NodeData)>{node_ids.begin(), 0},
-                                                         node_ids.size());
+  // node_by_rank[rank] is the position of the node in [first, last), or num_nodes for NodeIds that are only referenced
+  // by an edge.
+  std::vector<std::size_t> node_by_rank(num_ranks, num_nodes);
+  for (std::size_t i = 0; i < num_nodes; ++i) {
+    node_by_rank[rank_by_entry[i]] = i;
+  }
+  
+  // Step 1b: assign IDs with a DFS.
+  std::vector<bool> visited(num_ranks, false);
+  std::vector<InternalNodeId> internal_node_id_by_rank(num_ranks);
+  std::vector<std::pair<NodeId, InternalNodeId>> node_ids;
+  node_ids.reserve(num_ranks);
+  
+  struct DfsStackEntry {
+    std::size_t rank;
+    // The edges that haven't been visited yet (as a range of entries).
+    std::size_t edges_begin;
+    std::size_t edges_end;
+  };
+  std::vector<DfsStackEntry> dfs_stack;
+  
+  auto assignId = [&](std::size_t rank) {
+    internal_node_id_by_rank[rank] = internalNodeIdForIndex(node_ids.size());
+    node_ids.emplace_back(node_id_by_rank[rank], internal_node_id_by_rank[rank]);
+  };
+  // Visits the node with the specified rank (if not visited yet). If it has outgoing edges, it's pushed to dfs_stack and
+  // it's assigned an ID once its neighbors have been visited. Otherwise (e.g. if it's only referenced by an edge) it's
+  // assigned an ID immediately.
+  auto enterNode = [&](std::size_t rank) {
+    if (visited[rank]) {
+      return;
+    }
+    visited[rank] = true;
+    std::size_t node = node_by_rank[rank];
+    if (node == num_nodes || edges_begin_by_node[node] == edges_begin_by_node[node + 1]) {
+      assignId(rank);
+    } else {
+      dfs_stack.push_back(DfsStackEntry{rank, edges_begin_by_node[node], edges_begin_by_node[node + 1]});
+    }
+  };
+  auto visitFrom = [&](std::size_t rank) {
+    enterNode(rank);
+    while (!dfs_stack.empty()) {
+      DfsStackEntry& entry = dfs_stack.back();
+      if (entry.edges_begin == entry.edges_end) {
+        assignId(entry.rank);
+        dfs_stack.pop_back();
+      } else {
+        std::size_t neighbor_rank = rank_by_entry[entry.edges_begin];
+        ++entry.edges_begin;
+        enterNode(neighbor_rank);
+      }
+    }
+  };
+  
+  for (NodeId root : roots) {
+    std::size_t rank = std::lower_bound(node_id_by_rank.begin(), node_id_by_rank.end(), root, nodeIdLessThan)
+        - node_id_by_rank.begin();
+    if (rank != num_ranks && node_id_by_rank[rank] == root && node_by_rank[rank] != num_nodes) {
+      visitFrom(rank);
+    }
+  }
+  for (std::size_t i = 0; i < num_nodes; ++i) {
+    visitFrom(rank_by_entry[i]);
+  }
+  
+  node_index_map = SemistaticMap<NodeId, InternalNodeId>(node_ids.begin(), node_ids.size());
   
   first_unused_index = node_ids.size();
   
-  // Step 2: fill `nodes' and edges_storage.
+  // Step 2: fill `owned_nodes', `node_pages' and edges_storage.
   
-  // Note that not all of these will be assigned in the loop below.
-  nodes = FixedSizeVector<NodeData>(first_unused_index, NodeData{
-#ifdef FRUIT_EXTRA_DEBUG
-    NodeId(),
-#endif
-    1,
-    Node()});
+  std::size_t num_pages = (first_unused_index + node_page_size - 1) >> node_page_bits;
+  node_pages = FixedSizeVector<NodeData*>(num_pages);
+  owned_nodes = FixedSizeVector<NodeData>(num_pages * node_page_size);
+  // Note that not all of these nodes will be assigned in the loop below.
+  for (std::size_t i = 0; i < num_pages; ++i) {
+    addEmptyPage();
+  }
   
   // edges_storage[0] is unused, that's the reason for the +1
   edges_storage = FixedSizeVector<InternalNodeId>(num_edges + 1);
   edges_storage.push_back(InternalNodeId());
   
-  for (NodeIter i = first; i != last; ++i) {
-    NodeData& nodeData = *nodeAtId(node_index_map.at(i->getId()));
+  std::size_t node = 0;
+  for (NodeIter i = first; i != last; ++i, ++node) {
+    NodeData& nodeData = *nodeAtId(internal_node_id_by_rank[rank_by_entry[node]]);
     nodeData.node = i->getValue();
     if (i->isTerminal()) {
       nodeData.edges_begin = 0;
+    } else if (i->getEdgesBegin() == i->getEdgesEnd()) {
+      // Nodes with no edges point to the unused first element, so that each node's edges start at a different position
+      // (see forEachOwnedNode()).
+      nodeData.edges_begin = reinterpret_cast<std::uintptr_t>(edges_storage.data());
     } else {
       nodeData.edges_begin = reinterpret_cast<std::uintptr_t>(edges_storage.data() + edges_storage.size());
-      for (auto j = i->getEdgesBegin(); j != i->getEdgesEnd(); ++j) {
-        InternalNodeId other_node_id = node_index_map.at(*j);
-        edges_storage.push_back(other_node_id);
+      for (std::size_t j = edges_begin_by_node[node]; j < edges_begin_by_node[node + 1]; ++j) {
+        edges_storage.push_back(internal_node_id_by_rank[rank_by_entry[j]]);
       }
     }
   }
@@ -141,15 +262,19 @@ SemistaticGraph<NodeId, Node>::SemistaticGraph(const SemistaticGraph& x, NodeIte
   
   // Step 1: assign IDs to new nodes, fill `node_index_map' and update `first_unused_index'.
   
-  // Step 1a: collect all new node IDs.
+  // Step 1a: collect all new node IDs, and the pages of `x' containing nodes that will be replaced.
   std::vector<std::pair<NodeId, InternalNodeId>> node_ids;
+  std::vector<std::size_t> pages_to_copy;
   for (NodeIter i = first; i != last; ++i) {
-    if (x.node_index_map.find(i->getId()) == nullptr) {
+    const InternalNodeId* internalNodeIdPtr = x.nodeIndexMap().find(i->getId());
+    if (internalNodeIdPtr == nullptr) {
       node_ids.push_back(std::make_pair(i->getId(), InternalNodeId()));
+    } else {
+      pages_to_copy.push_back(internalNodeIdPtr->id >> node_page_bits);
     }
     if (!i->isTerminal()) {
       for (auto j = i->getEdgesBegin(); j != i->getEdgesEnd(); ++j) {
-        if (x.node_index_map.find(*j) == nullptr) {
+        if (x.nodeIndexMap().find(*j) == nullptr) {
           node_ids.push_back(std::make_pair(*j, InternalNodeId()));
         }
         ++num_new_edges;
@@ -163,23 +288,40 @@ SemistaticGraph<NodeId, Node>::SemistaticGraph(const SemistaticGraph& x, NodeIte
   
   // Step 1c: assign new IDs.
   for (auto& p : node_ids) {
-    p.second = InternalNodeId{first_unused_index*sizeof(NodeData)};
+    p.second = internalNodeIdForIndex(first_unused_index);
     ++first_unused_index;
   }
   
-  // Step 1d: actually populate node_index_map.
-  node_index_map = SemistaticMap<NodeId, InternalNodeId>(x.node_index_map, std::move(node_ids));
+  // The last page of `x' might be partially filled; if so, and there are new nodes, the new nodes will be stored there.
+  if (!node_ids.empty() && (x.first_unused_index & (node_page_size - 1)) != 0) {
+    pages_to_copy.push_back(x.first_unused_index >> node_page_bits);
+  }
+  std::sort(pages_to_copy.begin(), pages_to_copy.end());
+  pages_to_copy.erase(std::unique(pages_to_copy.begin(), pages_to_copy.end()), pages_to_copy.end());
   
-  // Step 2: fill `nodes' and `edges_storage'
-  nodes = FixedSizeVector<NodeData>(x.nodes, first_unused_index);
-  // Note that the loop below does not necessarily assign all of these.
-  for (std::size_t i = x.nodes.size(); i < first_unused_index; ++i) {
-    nodes.push_back(NodeData{
-#ifdef FRUIT_EXTRA_DEBUG
-        NodeId(),
-#endif
-        1,
-        Node()});
+  // Step 1d: actually populate node_index_map (if there are new NodeIds).
+  if (node_ids.empty()) {
+    base_node_index_map = &x.nodeIndexMap();
+  } else {
+    node_index_map = SemistaticMap<NodeId, InternalNodeId>(x.nodeIndexMap(), std::move(node_ids));
+  }
+  
+  // Step 2: fill `node_pages', `owned_nodes' and `edges_storage'.
+  // The pages of `x' are shared, except those in pages_to_copy (that are copied and then modified).
+  std::size_t num_pages = (first_unused_index + node_page_size - 1) >> node_page_bits;
+  std::size_t num_owned_pages = pages_to_copy.size() + (num_pages - x.node_pages.size());
+  node_pages = FixedSizeVector<NodeData*>(x.node_pages, num_pages);
+  owned_nodes = FixedSizeVector<NodeData>(num_owned_pages * node_page_size);
+  for (std::size_t page_index : pages_to_copy) {
+    const NodeData* page = x.node_pages[page_index];
+    node_pages[page_index] = owned_nodes.data() + owned_nodes.size();
+    for (std::size_t i = 0; i < node_page_size; ++i) {
+      owned_nodes.push_back(page[i]);
+    }
+  }
+  // Note that not all of these nodes will be assigned in the loop below.
+  for (std::size_t i = x.node_pages.size(); i < num_pages; ++i) {
+    addEmptyPage();
   }
   
   // edges_storage[0] is unused, that's the reason for the +1
@@ -187,14 +329,18 @@ SemistaticGraph<NodeId, Node>::SemistaticGraph(const SemistaticGraph& x, NodeIte
   edges_storage.push_back(InternalNodeId());
   
   for (NodeIter i = first; i != last; ++i) {
-    NodeData& nodeData = *nodeAtId(node_index_map.at(i->getId()));
+    NodeData& nodeData = *nodeAtId(nodeIndexMap().at(i->getId()));
     nodeData.node = i->getValue();
     if (i->isTerminal()) {
       nodeData.edges_begin = 0;
+    } else if (i->getEdgesBegin() == i->getEdgesEnd()) {
+      // Nodes with no edges point to the unused first element, so that each node's edges start at a different position
+      // (see forEachOwnedNode()).
+      nodeData.edges_begin = reinterpret_cast<std::uintptr_t>(edges_storage.data());
     } else {
       nodeData.edges_begin = reinterpret_cast<std::uintptr_t>(edges_storage.data() + edges_storage.size());
       for (auto j = i->getEdgesBegin(); j != i->getEdgesEnd(); ++j) {
-        InternalNodeId otherNodeId = node_index_map.at(*j);
+        InternalNodeId otherNodeId = nodeIndexMap().at(*j);
         edges_storage.push_back(otherNodeId);
       }
     }
@@ -205,11 +351,104 @@ SemistaticGraph<NodeId, Node>::SemistaticGraph(const SemistaticGraph& x, NodeIte
 #endif  
 }
 
+template <typename NodeId, typename Node>
+SemistaticGraph<NodeId, Node>::SemistaticGraph(const SemistaticGraph& x,
+                                               const std::pair<std::size_t, Node>* terminal_nodes,
+                                               std::size_t num_terminal_nodes)
+  : base_node_index_map(&x.nodeIndexMap()),
+    first_unused_index(x.first_unused_index) {
+  
+  std::vector<std::size_t> pages_to_copy;
+  for (std::size_t i = 0; i < num_terminal_nodes; ++i) {
+    FruitAssert(terminal_nodes[i].first < first_unused_index);
+    pages_to_copy.push_back(terminal_nodes[i].first >> node_page_bits);
+  }
+  std::sort(pages_to_copy.begin(), pages_to_copy.end());
+  pages_to_copy.erase(std::unique(pages_to_copy.begin(), pages_to_copy.end()), pages_to_copy.end());
+  
+  node_pages = FixedSizeVector<NodeData*>(x.node_pages, x.node_pages.size());
+  owned_nodes = FixedSizeVector<NodeData>(pages_to_copy.size() * node_page_size);
+  for (std::size_t page_index : pages_to_copy) {
+    const NodeData* page = x.node_pages[page_index];
+    node_pages[page_index] = owned_nodes.data() + owned_nodes.size();
+    for (std::size_t i = 0; i < node_page_size; ++i) {
+      owned_nodes.push_back(page[i]);
+    }
+  }
+  
+  // There are no new edges, so edges_storage stays empty.
+  
+  for (std::size_t i = 0; i < num_terminal_nodes; ++i) {
+    NodeData& nodeData = *nodeAtId(internalNodeIdForIndex(terminal_nodes[i].first));
+    nodeData.node = terminal_nodes[i].second;
+    nodeData.edges_begin = 0;
+  }
+}
+
+template <typename NodeId, typename Node>
+std::vector<NodeId> SemistaticGraph<NodeId, Node>::getNodeIds() const {
+  std::vector<NodeId> result(first_unused_index);
+  nodeIndexMap().forEachElement([&result](NodeId node_id, InternalNodeId internal_node_id) {
+    result[internal_node_id.id] = node_id;
+  });
+  return result;
+}
+
+template <typename NodeId, typename Node>
+std::size_t SemistaticGraph<NodeId, Node>::getAllocatedBytes() const {
+  return node_pages.size() * sizeof(NodeData*)
+      + owned_nodes.size() * sizeof(NodeData)
+      + edges_storage.size() * sizeof(InternalNodeId)
+      + node_index_map.getAllocatedBytes();
+}
+
+template <typename NodeId, typename Node>
+template <typename F>
+void SemistaticGraph<NodeId, Node>::forEachOwnedNode(F f) const {
+  std::uintptr_t edges_storage_begin = reinterpret_cast<std::uintptr_t>(edges_storage.data());
+  std::uintptr_t edges_storage_end = reinterpret_cast<std::uintptr_t>(edges_storage.data() + edges_storage.size());
+  
+  // The edges of each node are stored contiguously, so the edges of a node end where the edges of the next one (by
+  // position in edges_storage) begin.
+  std::vector<std::pair<std::uintptr_t, std::size_t>> owned_edges_begin;
+  std::vector<std::size_t> owned_node_indexes;
+  for (std::size_t page_index = 0; page_index < node_pages.size(); ++page_index) {
+    const NodeData* page = node_pages[page_index];
+    if (page < owned_nodes.data() || page >= owned_nodes.data() + owned_nodes.size()) {
+      // A page shared with the graph that this one extends.
+      continue;
+    }
+    for (std::size_t i = 0; i < node_page_size; ++i) {
+      std::size_t index = (page_index << node_page_bits) + i;
+      if (index >= first_unused_index || page[i].edges_begin == 1) {
+        // Not a node.
+        continue;
+      }
+      owned_node_indexes.push_back(index);
+      // Nodes with no edges point to edges_storage[0].
+      if (page[i].edges_begin > edges_storage_begin && page[i].edges_begin < edges_storage_end) {
+        owned_edges_begin.emplace_back(page[i].edges_begin, index);
+      }
+    }
+  }
+  std::sort(owned_edges_begin.begin(), owned_edges_begin.end());
+  
+  std::vector<std::size_t> num_edges_by_index(first_unused_index, 0);
+  for (std::size_t i = 0; i < owned_edges_begin.size(); ++i) {
+    std::uintptr_t edges_end = (i + 1 < owned_edges_begin.size()) ? owned_edges_begin[i + 1].first : edges_storage_end;
+    num_edges_by_index[owned_edges_begin[i].second] = (edges_end - owned_edges_begin[i].first) / sizeof(InternalNodeId);
+  }
+  
+  for (std::size_t index : owned_node_indexes) {
+    f(index, sizeof(NodeData) + num_edges_by_index[index] * sizeof(InternalNodeId));
+  }
+}
+
 #ifdef FRUIT_EXTRA_DEBUG
 template <typename NodeId, typename Node>
 void SemistaticGraph<NodeId, Node>::checkFullyConstructed() {
-  for (NodeData& data : nodes) {
-    if (data.edges_begin == 1) {
+  for (std::size_t i = 0; i < first_unused_index; ++i) {
+    if (nodeAtId(internalNodeIdForIndex(i))->edges_begin == 1) {
       std::cerr << "Fruit bug: the dependency graph was not fully constructed." << std::endl;
       abort();
     }
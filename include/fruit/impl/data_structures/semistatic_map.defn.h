@@ -37,6 +37,17 @@ inline typename SemistaticMap<Key, Value>::Unsigned SemistaticMap<Key, Value>::h
   return hash_function.hash(std::hash<typename std::remove_cv<Key>::type>()(key));
 }
 
+template <typename Key, typename Value>
+inline typename SemistaticMap<Key, Value>::Unsigned SemistaticMap<Key, Value>::slot(const Key& key) const {
+  Unsigned x = std::hash<typename std::remove_cv<Key>::type>()(key);
+  return (Unsigned)(displacements[hash_function.hash(x)] * x) >> slot_shift;
+}
+
+template <typename Key, typename Value>
+inline bool SemistaticMap<Key, Value>::usesPerfectHashing() const {
+  return displacements.size() != 0;
+}
+
 } // namespace impl
 } // namespace fruit
 
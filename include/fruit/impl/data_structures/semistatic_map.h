@@ -18,22 +18,44 @@
 #define SEMISTATIC_MAP_H
 
 #include <fruit/impl/data_structures/fixed_size_vector.h>
+#include <fruit/impl/fruit_internal_forward_decls.h>
 
 #include <vector>
 #include <limits>
 #include <climits>
 #include <cstdint>
+#include <type_traits>
 
 namespace fruit {
 namespace impl {
 
+// True if two keys compare equal iff they have the same object representation, so SemistaticMap can compare them with
+// SIMD instructions. This doesn't hold e.g. for floating point numbers or for structs with padding, so other types must
+// opt in with a specialization.
+template <typename Key>
+struct HasBitwiseEquality : public std::integral_constant<bool, std::is_integral<Key>::value
+                                                                || std::is_pointer<Key>::value> {};
+
+// TypeId::operator== compares the TypeInfo pointers.
+template <>
+struct HasBitwiseEquality<TypeId> : public std::true_type {};
+
 /**
  * Provides a subset of the interface of std::map, and also has these additional assumptions:
  * - Key must be default constructible and trivially copyable
  * - Value must be default constructible and trivially copyable
  * 
- * Also, while insertion of elements after construction is supported, inserting more than O(1) elements
- * after construction will raise the cost of any further lookups to more than O(1).
+ * Elements can't be inserted after construction, but it's possible to create a map that extends an existing one with
+ * additional elements, without copying the existing one (see the 2-argument constructor).
+ * 
+ * Keys are first hashed to a bucket of less than beta keys. Then, if possible, the map uses hash-and-displace perfect
+ * hashing: each bucket has a displacement (the multiplier of a second hash function) that sends its keys to distinct
+ * slots of `values', so lookups check a single key. Otherwise (e.g. if some keys have the same std::hash) the keys of
+ * each bucket are stored contiguously in `values', and also in `keys' so that lookups can compare the key with the
+ * whole bucket using SIMD instructions.
+ * Maps with at most max_single_bucket_size keys (e.g. most of the maps constructed for each injector) put all keys in
+ * the same bucket, so the constructor only needs to find 1 displacement. Lookups are the same as in other perfect
+ * hashed maps.
  */
 template <typename Key, typename Value>
 class SemistaticMap {
@@ -43,6 +65,21 @@ private:
   using value_type = std::pair<Key, Value>;
   
   static constexpr unsigned char beta = 4;
+  
+  // The maximum number of hash functions tried by the constructor. If none of them keeps all buckets below beta keys
+  // (this only happens in very big maps, or with keys that have the same std::hash), the one that came closest is used.
+  static constexpr std::size_t max_hash_attempts = 16;
+  
+  // The maximum number of displacements tried for each bucket when building the perfect hash table. The slot table is
+  // at most half full, so this is only reached in practice if some keys have the same std::hash.
+  static constexpr std::size_t max_displacement_attempts = 256;
+  
+  // Maps with at most this many keys use a single bucket. These maps have 4 slots per key (instead of 2) so that a
+  // displacement that sends all keys to distinct slots is found in a few attempts.
+  static constexpr std::size_t max_single_bucket_size = 16;
+  
+  static_assert(4 * max_single_bucket_size <= 64,
+                "The slots of a single-bucket map must fit in a std::uint64_t bitmask.");
     
   static_assert(std::numeric_limits<NumBits>::max() >= sizeof(Unsigned)*CHAR_BIT,
                 "An unsigned char is not enough to contain the number of bits in your platform. Please report this issue.");
@@ -65,30 +102,83 @@ private:
 
   HashFunction hash_function;
   // Given a key x, if p=lookup_table[hash_function.hash(x)] the candidate places for x are [p.first, p.second). These pointers
-  // point to the values[] vector, but it might be either the one of this object or the one of an object that was shallow-copied
-  // into this one.
+  // point to the values[] vector.
+  // This is empty if the map uses perfect hashing.
   FixedSizeVector<CandidateValuesRange> lookup_table;
+  // If the map uses perfect hashing, the only candidate place for x is values[slot(x)], where
+  // slot(x)==(displacements[hash_function.hash(x)] * x) >> slot_shift.
+  // This is empty if the map doesn't use perfect hashing.
+  FixedSizeVector<Unsigned> displacements;
+  NumBits slot_shift = 0;
+  // If the map uses perfect hashing, this is the slot table; the unused slots contain a copy of an element of the map, so
+  // that looking up a key in the wrong slot never finds it.
   FixedSizeVector<value_type> values;
+  // If the map doesn't use perfect hashing, keys[i]==values[i].first. Otherwise this is empty.
+  FixedSizeVector<Key> keys;
+  
+  // If this map was constructed as an extension of another map, this points to that map and lookup_table/values only
+  // contain the additional elements. Otherwise, this is nullptr.
+  const SemistaticMap* base_map = nullptr;
   
   Unsigned hash(const Key& key) const;
   
-  // Inserts a range [elems_begin, elems_end) of new (key,value) pairs with hash h. The keys must not exist in the map.
-  // Before calling this, ensure that the capacity of `values' is sufficient to contain the new values without re-allocating.
-  void insert(std::size_t h, const value_type* elems_begin, const value_type* elems_end);
+  // Precondition: the map uses perfect hashing.
+  Unsigned slot(const Key& key) const;
+  
+  bool usesPerfectHashing() const;
+  
+  // Tries to store the specified values in a perfect hashed map with a single bucket. If a displacement can't be found
+  // (e.g. because some keys have the same std::hash), returns false and leaves the map unchanged.
+  // Precondition: this map is empty, and 0 < num_values <= max_single_bucket_size.
+  template <typename Iter>
+  bool initSingleBucket(Iter values_begin, std::size_t num_values);
+  
+  // Tries to switch the map (just constructed with lookup_table) to perfect hashing. If a displacement can't be found
+  // for some bucket, the map is left unchanged.
+  void buildPerfectHashTable();
+  
+  // Similar to find(), but ignores base_map.
+  const Value* findInLookupTable(Key key) const;
+  
+  // Similar to forEachElement(), but ignores base_map.
+  template <typename F>
+  void forEachElementInLookupTable(F f) const;
+  
+  // Returns the position of `key' in [p, p_end), or p_end if not found. If Key has 64 bits and HasBitwiseEquality<Key>,
+  // this compares several keys at a time using SIMD instructions (if available).
+  static const Key* findKey(const Key* p, const Key* p_end, Key key);
+  
+  // Precondition: the map doesn't use perfect hashing.
+  // Returns the index in `values' of the element with the specified key in the bucket with hash h, or
+  // lookup_table[h].end - values.data() if not found.
+  std::size_t findInBucket(Unsigned h, Key key) const;
+  
+  // Adds the number of keys in each bucket to `count', stopping as soon as a bucket gets max_count keys.
+  // Returns the number of keys counted (num_values, if no bucket reached max_count).
+  template <typename Iter>
+  std::size_t countKeysInBuckets(Iter values_begin, std::size_t num_values, FixedSizeVector<Unsigned>& count,
+                                 Unsigned max_count) const;
   
 public:
   // Constructs an *invalid* map (as if this map was just moved from).
   SemistaticMap() = default;
   
   // Iter must be a forward iterator with value type std::pair<Key, Value>.
+  // The hash functions are tried in a fixed order, so the map (and the time it takes to construct it) only depends on the
+  // keys and on hash_multiplier_hint: the hint (if not 0) is tried first, then a sequence of random multipliers from a
+  // generator seeded with FRUIT_SEMISTATIC_MAP_SEED.
   template <typename Iter>
-  SemistaticMap(Iter begin, std::size_t num_values);
+  SemistaticMap(Iter begin, std::size_t num_values, Unsigned hash_multiplier_hint = 0);
   
-  // Creates a shallow copy of `map' with the additional elements in new_elements.
+  // Creates a map with the elements of `map' and the additional elements in new_elements.
   // The keys in new_elements must be unique and must not be present in `map'.
-  // The new map will share data with `map', so must be destroyed before `map' is destroyed.
-  // NOTE: If more than O(1) elements are added, calls to at() and find() on the result will *not* be O(1).
-  // This is O(new_elements.size()*log(new_elements.size())).
+  // `map' is not copied: the new map only stores the new elements in its own (perfect hashed, if possible) table, and
+  // looks up other keys in `map'. So `map' must not be modified, moved or destroyed while the new map exists.
+  // If `map' itself extends another map, the new map also stores the elements that `map' stores, and extends the same
+  // map as `map' instead. So there are at most 2 tables to probe, however many times a map is extended.
+  // This is O(new_elements.size()) (plus the number of elements stored by `map', if it extends another map). Lookups for
+  // keys stored in the new map are about as fast as lookups in `map', other lookups need one additional (unsuccessful)
+  // probe. Unless the new elements fit in a single bucket, the hash function of `map' is tried first.
   SemistaticMap(const SemistaticMap<Key, Value>& map, std::vector<value_type>&& new_elements);
   
   SemistaticMap(SemistaticMap&&) = default;
@@ -106,6 +196,14 @@ public:
   // Prefer using at() when possible, this is slightly slower.
   // Returns nullptr if the key was not found.
   const Value* find(Key key) const;
+  
+  // Calls f(key, value) for each element of the map (including the ones in the map that this one extends, if any), in no
+  // particular order. This is slow, don't use it in the injection path.
+  template <typename F>
+  void forEachElement(F f) const;
+  
+  // Returns the number of bytes allocated by this map, excluding the map that this one extends (if any).
+  std::size_t getAllocatedBytes() const;
 };
 
 } // namespace impl
@@ -23,7 +23,7 @@
 
 #include <algorithm>
 #include <cassert>
-#include <chrono>
+#include <cstring>
 #include <random>
 #include <utility>
 // This include is not necessary for GCC/Clang, but it's necessary for MSVC.
@@ -31,15 +31,27 @@
 
 #include <fruit/impl/data_structures/semistatic_map.h>
 
+#include <fruit/impl/fruit-config.h>
 #include <fruit/impl/fruit_assert.h>
+#include <fruit/impl/construction_phase_timer.h>
 #include <fruit/impl/data_structures/fixed_size_vector.templates.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace fruit {
 namespace impl {
 
 template <typename Key, typename Value>
 template <typename Iter>
-SemistaticMap<Key, Value>::SemistaticMap(Iter values_begin, std::size_t num_values) {
+SemistaticMap<Key, Value>::SemistaticMap(Iter values_begin, std::size_t num_values, Unsigned hash_multiplier_hint) {
+  if (num_values != 0 && num_values <= max_single_bucket_size && initSingleBucket(values_begin, num_values)) {
+    return;
+  }
+  
   NumBits num_bits = pickNumBits(num_values);
   std::size_t num_buckets = size_t(1) << num_bits;
   
@@ -47,29 +59,49 @@ SemistaticMap<Key, Value>::SemistaticMap(Iter values_begin, std::size_t num_valu
   
   hash_function.shift = (sizeof(Unsigned)*CHAR_BIT - num_bits);
   
-  // The cast is a no-op in some systems (e.g. GCC and Clang under Linux 64bit) but it's needed in other systems (e.g. MSVC).
-  unsigned seed = (unsigned) std::chrono::system_clock::now().time_since_epoch().count();
-  std::default_random_engine random_generator(seed);
+  bool hint_tried = false;
+  std::default_random_engine random_generator(FRUIT_SEMISTATIC_MAP_SEED);
   std::uniform_int_distribution<Unsigned> random_distribution;
   
-  while (1) {
-    hash_function.a = random_distribution(random_generator);
-    
-    Iter itr = values_begin;
-    for (std::size_t i = 0; i < num_values; ++i, ++itr) {
-      Unsigned& this_count = count[hash((*itr).first)];
-      ++this_count;
-      if (this_count == beta) {
-        goto pick_another;
+  // The rejected multiplier that counted the most keys before a bucket reached beta keys.
+  Unsigned best_multiplier = 0;
+  std::size_t best_num_keys = 0;
+  
+  std::size_t num_rejected = 0;
+  bool buckets_below_beta = true;
+  {
+    ConstructionPhaseTimer::Phase phase(&ConstructionPhaseTimes::hash_selection_ns);
+    while (1) {
+      if (num_rejected + 1 == max_hash_attempts) {
+        // Give up on keeping all buckets below beta keys, so that the construction time is bounded.
+        hash_function.a = best_multiplier;
+        countKeysInBuckets(values_begin, num_values, count, std::numeric_limits<Unsigned>::max());
+        buckets_below_beta = false;
+        break;
+      }
+      
+      if (!hint_tried && hash_multiplier_hint != 0) {
+        hash_function.a = hash_multiplier_hint;
+      } else {
+        hash_function.a = random_distribution(random_generator);
+      }
+      hint_tried = true;
+      
+      std::size_t num_keys = countKeysInBuckets(values_begin, num_values, count, beta);
+      if (num_keys == num_values) {
+        break;
+      }
+      if (num_keys >= best_num_keys) {
+        best_multiplier = hash_function.a;
+        best_num_keys = num_keys;
+      }
+      ++num_rejected;
+      for (std::size_t i = 0; i < num_buckets; ++i) {
+        count[i] = 0;
       }
-    }
-    break;
-    
-pick_another:
-    for (std::size_t i = 0; i < num_buckets; ++i) {
-      count[i] = 0;
     }
   }
+  ConstructionPhaseTimer::recordHashSelection(num_rejected);
   
   values = FixedSizeVector<value_type>(num_values, value_type());
   
@@ -90,94 +122,259 @@ pick_another:
     FruitAssert(first_value_ptr < values.data() + values.size());
     *first_value_ptr = *itr;
   }
+  
+  if (buckets_below_beta && num_values != 0) {
+    ConstructionPhaseTimer::Phase phase(&ConstructionPhaseTimes::hash_selection_ns);
+    buildPerfectHashTable();
+  }
+  
+  if (!usesPerfectHashing()) {
+    keys = FixedSizeVector<Key>(values.size());
+    for (const value_type& p : values) {
+      keys.push_back(p.first);
+    }
+  }
 }
 
 template <typename Key, typename Value>
-SemistaticMap<Key, Value>::SemistaticMap(const SemistaticMap<Key, Value>& map,
-                                         std::vector<value_type>&& new_elements)
-  : hash_function(map.hash_function), lookup_table(map.lookup_table, map.lookup_table.size()) {
-    
-  // Sort by hash.
-  std::sort(new_elements.begin(), new_elements.end(), [this](const value_type& x, const value_type& y) {
-    return hash(x.first) < hash(y.first);
-  });
-  
-  std::size_t num_additional_values = new_elements.size();
-  // Add the space needed to store copies of the old buckets.
-  for (auto itr = new_elements.begin(), itr_end = new_elements.end(); itr != itr_end; /* no increment */) {
-    Unsigned h = hash(itr->first);
-    auto p = map.lookup_table[h];
-    num_additional_values += (p.end - p.begin);
-    for (; itr != itr_end && hash(itr->first) == h; ++itr) {
-    }
-  }
+template <typename Iter>
+bool SemistaticMap<Key, Value>::initSingleBucket(Iter values_begin, std::size_t num_values) {
+  ConstructionPhaseTimer::Phase phase(&ConstructionPhaseTimes::hash_selection_ns);
   
-  values = FixedSizeVector<value_type>(num_additional_values);
+  NumBits num_slot_bits = pickNumBits(num_values) + 2;
+  NumBits new_slot_shift = sizeof(Unsigned)*CHAR_BIT - num_slot_bits;
   
-  // Now actually perform the insertions.
-
-  if (new_elements.empty()) {
-    // This is to workaround a bug in the STL shipped with GCC <4.8.2, where calling data() on an
-    // empty vector causes undefined behavior (https://gcc.gnu.org/bugzilla/show_bug.cgi?id=59829).
-    return;
+  Unsigned key_hashes[max_single_bucket_size];
+  Iter itr = values_begin;
+  for (std::size_t i = 0; i < num_values; ++i, ++itr) {
+    key_hashes[i] = std::hash<typename std::remove_cv<Key>::type>()((*itr).first);
   }
-  for (value_type *itr = new_elements.data(), *itr_end = new_elements.data() + new_elements.size();
-       itr != itr_end;
-       /* no increment */) {
-    Unsigned h = hash(itr->first);
-    auto p = map.lookup_table[h];
-    num_additional_values += (p.end - p.begin);
-    value_type* first = itr;
-    for (; itr != itr_end && hash(itr->first) == h; ++itr) {
+  
+  std::default_random_engine random_generator(FRUIT_SEMISTATIC_MAP_SEED);
+  std::uniform_int_distribution<Unsigned> random_distribution;
+  
+  for (std::size_t num_attempts = 0; num_attempts < max_displacement_attempts; ++num_attempts) {
+    Unsigned d = random_distribution(random_generator);
+    std::uint64_t slots_used = 0;
+    std::size_t i = 0;
+    for (; i < num_values; ++i) {
+      std::uint64_t slot_bit = std::uint64_t(1) << ((Unsigned)(d * key_hashes[i]) >> new_slot_shift);
+      if ((slots_used & slot_bit) != 0) {
+        break;
+      }
+      slots_used |= slot_bit;
+    }
+    if (i != num_values) {
+      continue;
+    }
+    
+    // With a multiplier of 0, all keys are in bucket 0.
+    hash_function.a = 0;
+    hash_function.shift = sizeof(Unsigned)*CHAR_BIT - 1;
+    displacements = FixedSizeVector<Unsigned>(1, d);
+    slot_shift = new_slot_shift;
+    values = FixedSizeVector<value_type>(std::size_t(1) << num_slot_bits, *values_begin);
+    itr = values_begin;
+    for (std::size_t j = 0; j < num_values; ++j, ++itr) {
+      values[(Unsigned)(d * key_hashes[j]) >> new_slot_shift] = *itr;
     }
-    value_type* last = itr;
-    insert(h, first, last);
+    return true;
   }
+  return false;
 }
 
 template <typename Key, typename Value>
-void SemistaticMap<Key, Value>::insert(std::size_t h, const value_type* elems_begin, const value_type* elems_end) {
+void SemistaticMap<Key, Value>::buildPerfectHashTable() {
+  NumBits num_slot_bits = pickNumBits(values.size()) + 1;
+  std::size_t num_slots = std::size_t(1) << num_slot_bits;
+  NumBits new_slot_shift = sizeof(Unsigned)*CHAR_BIT - num_slot_bits;
   
-  value_type* old_bucket_begin = lookup_table[h].begin;
-  value_type* old_bucket_end = lookup_table[h].end;
+  FixedSizeVector<Unsigned> new_displacements(lookup_table.size(), 0);
+  FixedSizeVector<value_type> slots(num_slots, values[0]);
+  FixedSizeVector<bool> slot_used(num_slots, false);
   
-  lookup_table[h].begin = values.data() + values.size();
+  std::default_random_engine random_generator(FRUIT_SEMISTATIC_MAP_SEED);
+  std::uniform_int_distribution<Unsigned> random_distribution;
   
-  // Step 1: re-insert all keys with the same hash at the end (if any).
-  for (value_type* p = old_bucket_begin; p != old_bucket_end; ++p) {
-    values.push_back(*p);
+  // The buckets with more keys are placed first, while most slots are still free.
+  for (std::size_t bucket_size = beta - 1; bucket_size > 0; --bucket_size) {
+    for (std::size_t h = 0; h < lookup_table.size(); ++h) {
+      const value_type* bucket_begin = lookup_table[h].begin;
+      if (std::size_t(lookup_table[h].end - bucket_begin) != bucket_size) {
+        continue;
+      }
+      
+      Unsigned bucket_slots[beta - 1];
+      std::size_t num_attempts = 0;
+      while (1) {
+        if (num_attempts == max_displacement_attempts) {
+          return;
+        }
+        ++num_attempts;
+        
+        Unsigned d = random_distribution(random_generator);
+        bool ok = true;
+        for (std::size_t i = 0; i < bucket_size && ok; ++i) {
+          Unsigned x = std::hash<typename std::remove_cv<Key>::type>()(bucket_begin[i].first);
+          bucket_slots[i] = (Unsigned)(d * x) >> new_slot_shift;
+          ok = !slot_used[bucket_slots[i]];
+          for (std::size_t j = 0; j < i && ok; ++j) {
+            ok = (bucket_slots[j] != bucket_slots[i]);
+          }
+        }
+        if (ok) {
+          new_displacements[h] = d;
+          break;
+        }
+      }
+      
+      for (std::size_t i = 0; i < bucket_size; ++i) {
+        slot_used[bucket_slots[i]] = true;
+        slots[bucket_slots[i]] = bucket_begin[i];
+      }
+    }
   }
   
-  // Step 2: also insert the new keys and values
-  for (auto itr = elems_begin; itr != elems_end; ++itr) {
-    values.push_back(*itr);
+  slot_shift = new_slot_shift;
+  displacements = std::move(new_displacements);
+  values = std::move(slots);
+  lookup_table = FixedSizeVector<CandidateValuesRange>();
+}
+
+template <typename Key, typename Value>
+SemistaticMap<Key, Value>::SemistaticMap(const SemistaticMap<Key, Value>& map,
+                                         std::vector<value_type>&& new_elements) {
+  if (map.base_map != nullptr) {
+    map.forEachElementInLookupTable([&new_elements](Key key, Value value) {
+      new_elements.emplace_back(key, value);
+    });
   }
-  
-  lookup_table[h].end = values.data() + values.size();
-  
-  // The old sequence is no longer pointed to by any index in the lookup table, but recompacting the vectors would be too slow.
+  *this = SemistaticMap(new_elements.begin(), new_elements.size(), map.hash_function.a);
+  base_map = (map.base_map != nullptr) ? map.base_map : &map;
 }
 
 template <typename Key, typename Value>
 const Value& SemistaticMap<Key, Value>::at(Key key) const {
-  Unsigned h = hash(key);
-  for (const value_type* p = lookup_table[h].begin; /* p!=lookup_table[h].end but no need to check */; ++p) {
-    FruitAssert(p != lookup_table[h].end);
-    if (p->first == key) {
-      return p->second;
-    }
+  if (base_map != nullptr) {
+    const Value* result = findInLookupTable(key);
+    return (result != nullptr) ? *result : base_map->at(key);
   }
+  if (usesPerfectHashing()) {
+    return values[slot(key)].second;
+  }
+  std::size_t i = findInBucket(hash(key), key);
+  FruitAssert(i < values.size());
+  return values[i].second;
 }
 
 template <typename Key, typename Value>
 const Value* SemistaticMap<Key, Value>::find(Key key) const {
+  const Value* result = findInLookupTable(key);
+  if (result == nullptr && base_map != nullptr) {
+    result = base_map->find(key);
+  }
+  return result;
+}
+
+template <typename Key, typename Value>
+const Value* SemistaticMap<Key, Value>::findInLookupTable(Key key) const {
+  if (usesPerfectHashing()) {
+    const value_type& candidate = values[slot(key)];
+    return (candidate.first == key) ? &(candidate.second) : nullptr;
+  }
   Unsigned h = hash(key);
-  for (const value_type *p = lookup_table[h].begin, *p_end = lookup_table[h].end; p != p_end; ++p) {
-    if (p->first == key) {
-      return &(p->second);
+  std::size_t i = findInBucket(h, key);
+  return (values.data() + i != lookup_table[h].end) ? &(values[i].second) : nullptr;
+}
+
+template <typename Key, typename Value>
+std::size_t SemistaticMap<Key, Value>::findInBucket(Unsigned h, Key key) const {
+  const Key* p = findKey(keys.data() + (lookup_table[h].begin - values.data()),
+                         keys.data() + (lookup_table[h].end - values.data()),
+                         key);
+  return p - keys.data();
+}
+
+template <typename Key, typename Value>
+const Key* SemistaticMap<Key, Value>::findKey(const Key* p, const Key* p_end, Key key) {
+#if defined(__AVX2__) || defined(__SSE2__)
+  // Compare the key with 4 (AVX2) or 2 (SSE2) keys at a time. When a group contains the key, the scalar
+  // loop below finds its position.
+  if (sizeof(Key) == sizeof(std::uint64_t) && HasBitwiseEquality<typename std::remove_cv<Key>::type>::value) {
+    std::uint64_t key_bits;
+    std::memcpy(&key_bits, &key, sizeof(key_bits));
+#if defined(__AVX2__)
+    __m256i key_x4 = _mm256_set1_epi64x(key_bits);
+    for (; p_end - p >= 4; p += 4) {
+      __m256i candidates = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi64(candidates, key_x4)) != 0) {
+        break;
+      }
+    }
+#else
+    __m128i key_x2 = _mm_set1_epi64x(key_bits);
+    for (; p_end - p >= 2; p += 2) {
+      __m128i candidates = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      // SSE2 can only compare 32-bit lanes; a 64-bit key matches iff both of its halves do.
+      __m128i equal_halves = _mm_cmpeq_epi32(candidates, key_x2);
+      __m128i equal = _mm_and_si128(equal_halves, _mm_shuffle_epi32(equal_halves, _MM_SHUFFLE(2, 3, 0, 1)));
+      if (_mm_movemask_epi8(equal) != 0) {
+        break;
+      }
+    }
+#endif
+  }
+#endif
+  
+  for (; p != p_end; ++p) {
+    if (*p == key) {
+      break;
+    }
+  }
+  return p;
+}
+
+template <typename Key, typename Value>
+template <typename F>
+void SemistaticMap<Key, Value>::forEachElement(F f) const {
+  forEachElementInLookupTable(f);
+  if (base_map != nullptr) {
+    base_map->forEachElement(f);
+  }
+}
+
+template <typename Key, typename Value>
+template <typename F>
+void SemistaticMap<Key, Value>::forEachElementInLookupTable(F f) const {
+  for (const value_type& p : values) {
+    // With perfect hashing, the unused slots contain copies of elements stored elsewhere.
+    if (!usesPerfectHashing() || &values[slot(p.first)] == &p) {
+      f(p.first, p.second);
     }
   }
-  return nullptr;
+}
+
+template <typename Key, typename Value>
+template <typename Iter>
+std::size_t SemistaticMap<Key, Value>::countKeysInBuckets(Iter values_begin,
+                                                          std::size_t num_values,
+                                                          FixedSizeVector<Unsigned>& count,
+                                                          Unsigned max_count) const {
+  Iter itr = values_begin;
+  for (std::size_t i = 0; i < num_values; ++i, ++itr) {
+    Unsigned& this_count = count[hash((*itr).first)];
+    ++this_count;
+    if (this_count == max_count) {
+      return i;
+    }
+  }
+  return num_values;
+}
+
+template <typename Key, typename Value>
+std::size_t SemistaticMap<Key, Value>::getAllocatedBytes() const {
+  return lookup_table.size() * sizeof(CandidateValuesRange) + displacements.size() * sizeof(Unsigned)
+      + values.size() * sizeof(value_type) + keys.size() * sizeof(Key);
 }
 
 template <typename Key, typename Value>
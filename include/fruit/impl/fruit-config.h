@@ -42,4 +42,44 @@
 #define FRUIT_IS_TRIVIALLY_COPYABLE(T) std::is_trivially_copyable<T>::value
 #endif
 
+#ifndef FRUIT_HAS_COROUTINES
+// Coroutine support needs both the compiler (e.g. GCC with -std=c++20) and the <coroutine> header.
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define FRUIT_HAS_COROUTINES 1
+#endif
+#endif
+#endif
+
+#ifndef FRUIT_HAS_COROUTINES
+#define FRUIT_HAS_COROUTINES 0
+#endif
+
+#ifndef FRUIT_ENABLE_INJECTION_EVENTS
+#define FRUIT_ENABLE_INJECTION_EVENTS 0
+#endif
+
+#ifndef FRUIT_SEMISTATIC_MAP_SEED
+// The seed of the generator of the hash functions tried by SemistaticMap. This is fixed (instead of e.g. depending on
+// the current time) so that the construction of injectors takes the same time in each run.
+#define FRUIT_SEMISTATIC_MAP_SEED 0x5bd1e995u
+#endif
+
+#ifndef FRUIT_ENABLE_TYPE_FINGERPRINTS
+// If this is 1, each TypeInfo also stores a fingerprint of the type computed at compile time (see getTypeFingerprint()).
+// This needs GCC or Clang, and it's off by default since it makes the compilation of each type's TypeInfo slower.
+#define FRUIT_ENABLE_TYPE_FINGERPRINTS 0
+#endif
+
+#ifndef FRUIT_HASH_TYPE_IDS_BY_FINGERPRINT
+// If this is 1, std::hash<TypeId> returns the fingerprint of the type instead of hashing the address of its TypeInfo.
+// So the hash functions chosen by SemistaticMap (and the layout of its tables) are the same in every run, even with
+// ASLR. This is off by default since hashing a TypeId then needs a load of the TypeInfo.
+#define FRUIT_HASH_TYPE_IDS_BY_FINGERPRINT 0
+#endif
+
+#if FRUIT_HASH_TYPE_IDS_BY_FINGERPRINT && !FRUIT_ENABLE_TYPE_FINGERPRINTS
+#error "FRUIT_HASH_TYPE_IDS_BY_FINGERPRINT requires FRUIT_ENABLE_TYPE_FINGERPRINTS."
+#endif
+
 #endif // FRUIT_CONFIG_H
@@ -26,6 +26,8 @@ namespace impl {
 class ComponentStorage;
 class NormalizedComponentStorage;
 class InjectorStorage;
+class InjectionProfiler;
+class AsyncExecutor;
 struct TypeId;
 
 namespace meta {
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTION_AWAITABLE_DEFN_H
+#define FRUIT_INJECTION_AWAITABLE_DEFN_H
+
+// Redundant, but makes KDevelop happy.
+#include <fruit/impl/injection_awaitable.h>
+
+namespace fruit {
+namespace impl {
+
+template <typename Injector, typename AnnotatedT, typename Scheduler>
+inline InjectionAwaitable<Injector, AnnotatedT, Scheduler>::InjectionAwaitable(Injector& injector, Scheduler& scheduler)
+  : injector(injector), scheduler(scheduler) {
+}
+
+template <typename Injector, typename AnnotatedT, typename Scheduler>
+inline void InjectionAwaitable<Injector, AnnotatedT, Scheduler>::inject() {
+  try {
+    if constexpr (std::is_reference<T>::value) {
+      result.emplace(&injector.template get<AnnotatedT>());
+    } else {
+      result.emplace(injector.template get<AnnotatedT>());
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+}
+
+template <typename Injector, typename AnnotatedT, typename Scheduler>
+inline bool InjectionAwaitable<Injector, AnnotatedT, Scheduler>::await_ready() const noexcept {
+  return false;
+}
+
+template <typename Injector, typename AnnotatedT, typename Scheduler>
+inline void InjectionAwaitable<Injector, AnnotatedT, Scheduler>::await_suspend(std::coroutine_handle<> handle) {
+  scheduler.schedule([this, handle]() {
+    inject();
+    // This might destroy *this, so it must be the last thing that the task does.
+    handle.resume();
+  });
+}
+
+template <typename Injector, typename AnnotatedT, typename Scheduler>
+inline auto InjectionAwaitable<Injector, AnnotatedT, Scheduler>::await_resume() -> T {
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if constexpr (std::is_reference<T>::value) {
+    return **result;
+  } else {
+    return std::move(*result);
+  }
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_INJECTION_AWAITABLE_DEFN_H
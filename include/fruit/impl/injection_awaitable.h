@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTION_AWAITABLE_H
+#define FRUIT_INJECTION_AWAITABLE_H
+
+#include <fruit/impl/fruit-config.h>
+
+#if FRUIT_HAS_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * The awaitable returned by Injector::getAsync(scheduler).
+ * When awaited, the awaiting coroutine is suspended and the injection of AnnotatedT (that also constructs the instances
+ * that AnnotatedT depends on) is passed to the scheduler as a task; that task then resumes the coroutine.
+ */
+template <typename Injector, typename AnnotatedT, typename Scheduler>
+class InjectionAwaitable {
+private:
+  using T = decltype(std::declval<Injector&>().template get<AnnotatedT>());
+  
+  // std::optional can't hold references, so we store a pointer instead.
+  using StoredT = typename std::conditional<std::is_reference<T>::value,
+                                            typename std::remove_reference<T>::type*,
+                                            T>::type;
+  
+  Injector& injector;
+  Scheduler& scheduler;
+  std::optional<StoredT> result;
+  std::exception_ptr error;
+  
+  // Runs the injection, storing the result (or the exception thrown) in this object.
+  void inject();
+  
+public:
+  InjectionAwaitable(Injector& injector, Scheduler& scheduler);
+  
+  bool await_ready() const noexcept;
+  void await_suspend(std::coroutine_handle<> handle);
+  T await_resume();
+};
+
+} // namespace impl
+} // namespace fruit
+
+#include <fruit/impl/injection_awaitable.defn.h>
+
+#endif // FRUIT_HAS_COROUTINES
+
+#endif // FRUIT_INJECTION_AWAITABLE_H
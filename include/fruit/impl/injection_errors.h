@@ -187,6 +187,30 @@ struct UnsatisfiedRequirementsInNormalizedComponentError {
     "not provided by the Component (second parameter of the Injector constructor).");
 };
 
+template <typename... UnsatisfiedRequirements>
+struct UnsatisfiedRequirementsInChildInjectorError {
+  static_assert(
+    AlwaysFalse<UnsatisfiedRequirements...>::value,
+    "The requirements in UnsatisfiedRequirements are required by the Component (second parameter of the Injector "
+    "constructor) but are not provided by the parent Injector.");
+};
+
+template <typename... MissingTypes>
+struct MissingRequiredInstancesError {
+  static_assert(
+    AlwaysFalse<MissingTypes...>::value,
+    "The types in MissingTypes are required by the NormalizedComponent, but no instance of them was passed to the "
+    "Injector constructor.");
+};
+
+template <typename... NotRequiredTypes>
+struct InstancesOfTypesNotRequiredError {
+  static_assert(
+    AlwaysFalse<NotRequiredTypes...>::value,
+    "Instances of the types in NotRequiredTypes were passed to the Injector constructor, but these types are not "
+    "required by the NormalizedComponent.");
+};
+
 template <typename... TypesNotProvided>
 struct TypesInInjectorNotProvidedError {
   static_assert(
@@ -357,6 +381,21 @@ struct UnsatisfiedRequirementsInNormalizedComponentErrorTag {
   using apply = UnsatisfiedRequirementsInNormalizedComponentError<UnsatisfiedRequirements...>;
 };
 
+struct UnsatisfiedRequirementsInChildInjectorErrorTag {
+  template <typename... UnsatisfiedRequirements>
+  using apply = UnsatisfiedRequirementsInChildInjectorError<UnsatisfiedRequirements...>;
+};
+
+struct MissingRequiredInstancesErrorTag {
+  template <typename... MissingTypes>
+  using apply = MissingRequiredInstancesError<MissingTypes...>;
+};
+
+struct InstancesOfTypesNotRequiredErrorTag {
+  template <typename... NotRequiredTypes>
+  using apply = InstancesOfTypesNotRequiredError<NotRequiredTypes...>;
+};
+
 struct TypesInInjectorNotProvidedErrorTag {
   template <typename... TypesNotProvided>
   using apply = TypesInInjectorNotProvidedError<TypesNotProvided...>;
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTION_EVENT_LOG_H
+#define FRUIT_INJECTION_EVENT_LOG_H
+
+#ifndef IN_FRUIT_CPP_FILE
+// This is only used by InjectorStorage and FixedSizeAllocator, so there's no need to include it in public headers.
+#error "injection_event_log.h included in non-cpp file."
+#endif
+
+#include <fruit/injection_events.h>
+
+#if FRUIT_ENABLE_INJECTION_EVENTS
+
+namespace fruit {
+namespace impl {
+
+// Records an event in the ring buffer of the current thread (see drainInjectionEvents()).
+// This doesn't lock nor allocate, except for the first event recorded by each thread.
+void recordInjectionEvent(InjectionEvent::Kind kind, TypeId type, const void* object);
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_ENABLE_INJECTION_EVENTS
+
+#endif // FRUIT_INJECTION_EVENT_LOG_H
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTION_PROFILER_H
+#define FRUIT_INJECTION_PROFILER_H
+
+#ifndef IN_FRUIT_CPP_FILE
+// This is only used by InjectorStorage and FixedSizeAllocator, so there's no need to include it in public headers.
+#error "injection_profiler.h included in non-cpp file."
+#endif
+
+#include <fruit/impl/util/type_info.h>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * Records the constructions performed by an injector, when profiling is enabled (see InjectorStorage::enableProfiling()).
+ * Constructions can be recorded concurrently from multiple threads.
+ */
+class InjectionProfiler {
+public:
+  // Value of Record::node_index for multibindings.
+  static constexpr std::size_t NO_NODE = std::size_t(-1);
+
+  struct Record {
+    // For multibindings, the type of the multibinding. For bindings, this is not set: the type is determined later from
+    // node_index.
+    TypeId type;
+
+    // The index of the constructed node in the injector's graph, or NO_NODE for multibindings.
+    std::size_t node_index;
+
+    std::uint64_t start_ns;
+    std::uint64_t total_ns;
+    std::uint64_t self_ns;
+    std::size_t allocated_bytes;
+    std::size_t thread_index;
+  };
+
+  /**
+   * Measures a single construction, from the constructor of this object to the call to end().
+   * The constructions that start in the same thread before end() are nested in this one: their time is excluded from the
+   * self time of this one, and their allocations aren't attributed to this one.
+   * If end() is not called (e.g. because the construction threw an exception), nothing is recorded.
+   */
+  class Scope {
+  private:
+    InjectionProfiler& profiler;
+
+    // The enclosing scope in this thread, if any.
+    Scope* parent;
+
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t nested_ns = 0;
+    std::size_t allocated_bytes = 0;
+    bool ended = false;
+
+    // The innermost scope of the current thread (or nullptr).
+    static thread_local Scope* current;
+
+    std::uint64_t elapsedNs() const;
+
+    friend class InjectionProfiler;
+
+  public:
+    explicit Scope(InjectionProfiler& profiler);
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope();
+
+    void end(TypeId type, std::size_t node_index);
+  };
+
+  InjectionProfiler();
+
+  // Attributes `bytes' bytes to the innermost construction currently measured in this thread (if any).
+  static void recordAllocation(std::size_t bytes);
+
+  // Returns the records so far, in the order in which they were added.
+  std::vector<Record> getRecords();
+
+private:
+  std::chrono::steady_clock::time_point profiling_start;
+
+  // Guards the fields below.
+  std::mutex mutex;
+
+  std::vector<Record> records;
+
+  // The threads that added a record so far, in the order of their first record (so that thread_ids[i] has thread index i).
+  std::vector<std::thread::id> thread_ids;
+
+  void addRecord(Record record);
+};
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_INJECTION_PROFILER_H
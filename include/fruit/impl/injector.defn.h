@@ -27,7 +27,8 @@ namespace fruit {
 template <typename... P>
 inline Injector<P...>::Injector(const Component<P...>& component)
   : storage(new fruit::impl::InjectorStorage(component.storage,
-                                             std::initializer_list<fruit::impl::TypeId>{fruit::impl::getTypeId<P>()...})) {
+                                             std::initializer_list<fruit::impl::TypeId>{fruit::impl::getTypeId<P>()...})),
+    exposed_type_nodes{{storage->template lazyGetPtr<P>()...}} {
 }
 
 namespace impl {
@@ -59,6 +60,55 @@ struct InjectorImplHelper {
         None)))>;
   };
   
+  // This performs all checks needed in the constructor of Injector that takes a parent injector.
+  template <typename ParentComp, typename Comp>
+  struct CheckConstructionFromParentInjector {
+    using Op = InstallComponent(Comp, ParentComp);
+    
+    // The calculation of MergedComp will also do some checks, e.g. multiple bindings for the same type.
+    using MergedComp = GetResult(Op);
+    
+    using TypesNotProvided = SetDifference(Vector<Type<P>...>,
+                                           GetComponentPs(MergedComp));
+    using MergedCompRs = SetDifference(GetComponentRsSuperset(MergedComp),
+                                       GetComponentPs(MergedComp));
+    
+    using type = Eval<
+        If(Not(IsEmptySet(MergedCompRs)),
+           ConstructErrorWithArgVector(UnsatisfiedRequirementsInChildInjectorErrorTag, SetToVector(MergedCompRs)),
+        If(Not(IsContained(VectorToSetUnchecked(Vector<Type<P>...>), GetComponentPs(MergedComp))),
+           ConstructErrorWithArgVector(TypesInInjectorNotProvidedErrorTag, SetToVector(TypesNotProvided)),
+        None))>;
+  };
+  
+  // This performs all checks needed in the constructor of Injector that takes a NormalizedComponent and instances of its
+  // required types.
+  template <typename NormalizedComp, typename... RequiredTypes>
+  struct CheckConstructionFromRequiredInstances {
+    using NormalizedCompRs = SetDifference(GetComponentRsSuperset(NormalizedComp),
+                                           GetComponentPs(NormalizedComp));
+    using InstanceTypes = VectorToSetUnchecked(Vector<Type<RequiredTypes>...>);
+    using MissingTypes = SetDifference(NormalizedCompRs, InstanceTypes);
+    using NotRequiredTypes = SetDifference(InstanceTypes, NormalizedCompRs);
+    using InjectorPs = SetUnion(GetComponentPs(NormalizedComp), NormalizedCompRs);
+    using TypesNotProvided = SetDifference(Vector<Type<P>...>, InjectorPs);
+    
+    using type = Eval<
+        If(Not(IsEmptySet(MissingTypes)),
+           ConstructErrorWithArgVector(MissingRequiredInstancesErrorTag, SetToVector(MissingTypes)),
+        If(Not(IsEmptySet(NotRequiredTypes)),
+           ConstructErrorWithArgVector(InstancesOfTypesNotRequiredErrorTag, SetToVector(NotRequiredTypes)),
+        If(Not(IsContained(VectorToSetUnchecked(Vector<Type<P>...>), InjectorPs)),
+           ConstructErrorWithArgVector(TypesInInjectorNotProvidedErrorTag, SetToVector(TypesNotProvided)),
+        None)))>;
+  };
+  
+  // True if all the types exposed by Comp are also exposed by the injector.
+  template <typename Comp>
+  struct ExposesAllTypesOf {
+    static constexpr bool value = Eval<IsContained(GetComponentPs(Comp), VectorToSetUnchecked(Vector<Type<P>...>))>::value;
+  };
+  
   template <typename T>
   struct CheckGet {
     using Comp = ConstructComponentImpl(Type<P>...);
@@ -83,7 +133,8 @@ inline Injector<P...>::Injector(const NormalizedComponent<NormalizedComponentPar
                                                  fruit::impl::meta::ConcatVectors(
                                                     fruit::impl::meta::SetToVector(fruit::impl::meta::GetComponentPs(fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<ComponentParams>...))),
                                                     fruit::impl::meta::SetToVector(fruit::impl::meta::GetComponentPs(fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<NormalizedComponentParams>...))))
-                                             >>())) {
+                                             >>())),
+    exposed_type_nodes{{storage->template lazyGetPtr<P>()...}} {
     
   using NormalizedComp = fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<NormalizedComponentParams>...);
   using Comp = fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<ComponentParams>...);
@@ -92,6 +143,55 @@ inline Injector<P...>::Injector(const NormalizedComponent<NormalizedComponentPar
   
   using E = typename fruit::impl::meta::InjectorImplHelper<P...>::template CheckConstructionFromNormalizedComponent<NormalizedComp, Comp>::type;
   (void)typename fruit::impl::meta::CheckIfError<E>::type();
+  
+  if (!fruit::impl::meta::InjectorImplHelper<P...>::template ExposesAllTypesOf<NormalizedComp>::value) {
+    // The construction schedule of the NormalizedComponent might contain types that are not reachable from P...
+    storage->ignoreConstructionSchedule();
+  }
+}
+
+template <typename... P>
+template <typename... ParentP, typename... ComponentParams>
+inline Injector<P...>::Injector(Injector<ParentP...>& parent, Component<ComponentParams...> component)
+  : storage(new fruit::impl::InjectorStorage(*(parent.storage),
+                                             std::move(component.storage), 
+                                             fruit::impl::getTypeIdsForList<fruit::impl::meta::Eval<
+                                                 fruit::impl::meta::ConcatVectors(
+                                                    fruit::impl::meta::SetToVector(fruit::impl::meta::GetComponentPs(fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<ComponentParams>...))),
+                                                    fruit::impl::meta::SetToVector(fruit::impl::meta::GetComponentPs(fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<ParentP>...))))
+                                             >>())),
+    exposed_type_nodes{{storage->template lazyGetPtr<P>()...}} {
+    
+  using ParentComp = fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<ParentP>...);
+  using Comp = fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<ComponentParams>...);
+  // We don't check whether the construction of ParentComp or Comp resulted in errors here; if they did, the instantiation
+  // of Injector<ParentP...> or Component<ComponentParams...> would have resulted in an error already.
+  
+  using E = typename fruit::impl::meta::InjectorImplHelper<P...>::template CheckConstructionFromParentInjector<ParentComp, Comp>::type;
+  (void)typename fruit::impl::meta::CheckIfError<E>::type();
+}
+
+template <typename... P>
+template <typename... NormalizedComponentParams, typename... RequiredTypes>
+inline Injector<P...>::Injector(const NormalizedComponent<NormalizedComponentParams...>& normalized_component,
+                                RequiredTypes&... required_instances)
+  : storage(new fruit::impl::InjectorStorage(*(normalized_component.storage.storage),
+                                             std::array<std::pair<fruit::impl::TypeId, void*>, sizeof...(RequiredTypes)>{{
+                                                 std::make_pair(fruit::impl::getTypeId<RequiredTypes>(),
+                                                                reinterpret_cast<void*>(&required_instances))...
+                                             }}.data(),
+                                             sizeof...(RequiredTypes))),
+    exposed_type_nodes{{storage->template lazyGetPtr<P>()...}} {
+    
+  using NormalizedComp = fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<NormalizedComponentParams>...);
+  
+  using E = typename fruit::impl::meta::InjectorImplHelper<P...>::template CheckConstructionFromRequiredInstances<NormalizedComp, RequiredTypes...>::type;
+  (void)typename fruit::impl::meta::CheckIfError<E>::type();
+  
+  if (!fruit::impl::meta::InjectorImplHelper<P...>::template ExposesAllTypesOf<NormalizedComp>::value) {
+    // The construction schedule of the NormalizedComponent might contain types that are not reachable from P...
+    storage->ignoreConstructionSchedule();
+  }
 }
 
 template <typename... P>
@@ -100,9 +200,50 @@ inline Injector<P...>::RemoveAnnotations<T> Injector<P...>::get() {
 
   using E = typename fruit::impl::meta::InjectorImplHelper<P...>::template CheckGet<T>::type;
   (void)typename fruit::impl::meta::CheckIfError<E>::type();
-  return storage->template get<T>();
+  
+  // The checks above guarantee that NormalizeType<T> is one of the types in P..., so this is never -1 (unless there was an
+  // error above).
+  using Index = fruit::impl::meta::Eval<fruit::impl::meta::FindInVector(fruit::impl::meta::NormalizeType(fruit::impl::meta::Type<T>),
+                                                                        fruit::impl::meta::Vector<fruit::impl::meta::Type<P>...>)>;
+  return storage->template get<RemoveAnnotations<T>>(exposed_type_nodes[Index::value]);
 }
 
+template <typename... P>
+template <typename T>
+inline Injector<P...>::FutureOfRemoveAnnotations<T> Injector<P...>::getAsync() {
+  
+  using E = typename fruit::impl::meta::InjectorImplHelper<P...>::template CheckGet<T>::type;
+  (void)typename fruit::impl::meta::CheckIfError<E>::type();
+  
+  using Index = fruit::impl::meta::Eval<fruit::impl::meta::FindInVector(fruit::impl::meta::NormalizeType(fruit::impl::meta::Type<T>),
+                                                                        fruit::impl::meta::Vector<fruit::impl::meta::Type<P>...>)>;
+  // The task doesn't capture `this', since the injector might be moved before it runs. The storage and the nodes don't move.
+  fruit::impl::InjectorStorage* storage_ptr = storage.get();
+  fruit::impl::InjectorStorage::Graph::node_iterator node = exposed_type_nodes[Index::value];
+  // std::function must be copyable, while std::packaged_task is move-only.
+  auto task = std::make_shared<std::packaged_task<RemoveAnnotations<T>()>>([storage_ptr, node]() -> RemoveAnnotations<T> {
+    return storage_ptr->template get<RemoveAnnotations<T>>(node);
+  });
+  FutureOfRemoveAnnotations<T> result = task->get_future();
+  storage->runAsync([task]() {
+    (*task)();
+  });
+  return result;
+}
+
+#if FRUIT_HAS_COROUTINES
+template <typename... P>
+template <typename T, typename Scheduler>
+inline fruit::impl::InjectionAwaitable<Injector<P...>, T, Scheduler> Injector<P...>::getAsync(Scheduler& scheduler) {
+  
+  using E = typename fruit::impl::meta::InjectorImplHelper<P...>::template CheckGet<T>::type;
+  (void)typename fruit::impl::meta::CheckIfError<E>::type();
+  
+  storage->checkConcurrentInjectionEnabled();
+  return fruit::impl::InjectionAwaitable<Injector<P...>, T, Scheduler>(*this, scheduler);
+}
+#endif
+
 template <typename... P>
 template <typename C>
 inline Injector<P...>::RemoveAnnotations<C>* Injector<P...>::unsafeGet() {
@@ -123,6 +264,9 @@ inline const std::vector<typename Injector<P...>::template RemoveAnnotations<Ann
 
 template <typename... P>
 inline void Injector<P...>::eagerlyInjectAll() {
+  // This constructs most (or all) of the objects needed below, so that the calls to get() below don't need to recurse.
+  storage->eagerlyInjectConstructionSchedule();
+  
   // Eagerly inject normal bindings.
   void* unused[] = {reinterpret_cast<void*>(storage->template get<fruit::impl::meta::UnwrapType<fruit::impl::meta::Eval<fruit::impl::meta::AddPointerInAnnotatedType(fruit::impl::meta::Type<P>)>>>())...};
   (void)unused;
@@ -130,6 +274,63 @@ inline void Injector<P...>::eagerlyInjectAll() {
   storage->eagerlyInjectMultibindings();
 }
 
+template <typename... P>
+inline void Injector<P...>::eagerlyInjectAll(std::size_t num_threads) {
+  storage->enableConcurrentInjection();
+  storage->eagerlyInjectConstructionScheduleInParallel(num_threads);
+  eagerlyInjectAll();
+}
+
+template <typename... P>
+inline void Injector<P...>::enableConcurrentInjection() {
+  storage->enableConcurrentInjection();
+}
+
+template <typename... P>
+inline void Injector<P...>::enableConcurrentInjection(std::size_t max_async_threads) {
+  storage->enableConcurrentInjection(max_async_threads);
+}
+
+template <typename... P>
+inline void Injector<P...>::enableProfiling() {
+  storage->enableProfiling();
+}
+
+template <typename... P>
+inline InjectionProfile Injector<P...>::getProfile() {
+  return storage->getProfile();
+}
+
+template <typename... P>
+inline void Injector<P...>::enableMemoryAccounting() {
+  storage->enableMemoryAccounting();
+}
+
+template <typename... P>
+inline InjectorMemoryUsage Injector<P...>::getMemoryUsage() {
+  return storage->getMemoryUsage();
+}
+
+template <typename... P>
+inline ConstructionPhaseTimes Injector<P...>::getConstructionPhaseTimes() const {
+  return storage->getConstructionPhaseTimes();
+}
+
+template <typename... P>
+template <typename... NormalizedComponentParams, typename... RequiredTypes>
+inline void Injector<P...>::reset(const NormalizedComponent<NormalizedComponentParams...>& normalized_component,
+                                  RequiredTypes&... required_instances) {
+  using NormalizedComp = fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<NormalizedComponentParams>...);
+  
+  using E = typename fruit::impl::meta::InjectorImplHelper<P...>::template CheckConstructionFromRequiredInstances<NormalizedComp, RequiredTypes...>::type;
+  (void)typename fruit::impl::meta::CheckIfError<E>::type();
+  
+  std::array<std::pair<fruit::impl::TypeId, void*>, sizeof...(RequiredTypes)> instances{{
+      std::make_pair(fruit::impl::getTypeId<RequiredTypes>(), reinterpret_cast<void*>(&required_instances))...
+  }};
+  storage->reset(*(normalized_component.storage.storage), instances.data(), instances.size());
+}
+
 } // namespace fruit
 
 
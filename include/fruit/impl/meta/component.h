@@ -430,6 +430,35 @@ struct ExpandProvidersInParams {
   };
 };
 
+// Takes a vector of args, possibly including Provider<>s, and removes the Provider<>s (annotated or not).
+// The types in the result are the ones that are injected before the args are passed, instead of lazily.
+struct RemoveProviders {
+  template <typename V>
+  struct apply {
+    struct Helper {
+      // AnnotatedT is not of the form Provider<C>
+      template <typename CurrentResult, typename AnnotatedT>
+      struct apply {
+        using type = PushBack(CurrentResult, AnnotatedT);
+      };
+
+      // Type of the form Provider<C>
+      template <typename CurrentResult, typename C>
+      struct apply<CurrentResult, Type<fruit::Provider<C>>> {
+        using type = CurrentResult;
+      };
+
+      // Type of the form Annotated<Annotation, Provider<C>>
+      template <typename CurrentResult, typename Annotation, typename C>
+      struct apply<CurrentResult, Type<fruit::Annotated<Annotation, fruit::Provider<C>>>> {
+        using type = CurrentResult;
+      };
+    };
+    
+    using type = FoldVector(V, Helper, Vector<>);
+  };
+};
+
 //********************************************************************************************************************************
 // Part 2: Type functors involving at least one ConsComp.
 //********************************************************************************************************************************
@@ -102,6 +102,27 @@ struct IsInVector {
   };
 };
 
+// Returns the index of the first occurrence of T in V (as an Int<>), or Int<-1> if T is not in V.
+struct FindInVector {
+  template <typename T, typename V>
+  struct apply;
+  
+  template <typename T>
+  struct apply<T, Vector<>> {
+    using type = Int<-1>;
+  };
+  
+  template <typename T, typename... Ts>
+  struct apply<T, Vector<T, Ts...>> {
+    using type = Int<0>;
+  };
+  
+  template <typename T, typename T1, typename... Ts>
+  struct apply<T, Vector<T1, Ts...>> {
+    using type = Int<apply<T, Vector<Ts...>>::type::value == -1 ? -1 : apply<T, Vector<Ts...>>::type::value + 1>;
+  };
+};
+
 struct IsVectorContained {
   template <typename V1, typename V2>
   struct apply;
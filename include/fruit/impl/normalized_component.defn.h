@@ -30,7 +30,22 @@ inline NormalizedComponent<Params...>::NormalizedComponent(const Component<Param
         typename fruit::impl::meta::Eval<fruit::impl::meta::SetToVector(
             typename fruit::impl::meta::Eval<
                 fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<Params>...)
-            >::Ps)>>()) {
+            >::Ps)>>(),
+      fruit::impl::getTypeIdsForList<
+        typename fruit::impl::meta::Eval<fruit::impl::meta::SetToVector(
+            fruit::impl::meta::SetDifference(
+                fruit::impl::meta::GetComponentRsSuperset(fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<Params>...)),
+                fruit::impl::meta::GetComponentPs(fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<Params>...))))>>()) {
+}
+
+template <typename... Params>
+inline void NormalizedComponent<Params...>::shareComponentScopedInstances() {
+  storage.shareComponentScopedInstances();
+}
+
+template <typename... Params>
+inline ConstructionPhaseTimes NormalizedComponent<Params...>::getConstructionPhaseTimes() const {
+  return storage.getConstructionPhaseTimes();
 }
 
 } // namespace fruit
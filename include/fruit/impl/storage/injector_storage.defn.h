@@ -158,8 +158,8 @@ inline InjectorStorage::Graph::node_iterator InjectorStorage::lazyGetPtr() {
 }
 
 template <typename AnnotatedC>
-inline InjectorStorage::Graph::node_iterator InjectorStorage::lazyGetPtr(Graph::edge_iterator deps, std::size_t dep_index, Graph::node_iterator bindings_begin) {
-  Graph::node_iterator itr = deps.getNodeIterator(dep_index, bindings_begin);
+inline InjectorStorage::Graph::node_iterator InjectorStorage::lazyGetPtr(Graph::edge_iterator deps, std::size_t dep_index, Graph& bindings) {
+  Graph::node_iterator itr = deps.getNodeIterator(dep_index, bindings);
   FruitAssert(bindings.find(getTypeId<AnnotatedC>()) == itr);
   FruitAssert(!(bindings.end() == itr));
   return itr;
@@ -204,12 +204,14 @@ inline const std::vector<InjectorStorage::RemoveAnnotations<AnnotatedC>*>& Injec
 }
 
 inline void* InjectorStorage::getPtrInternal(Graph::node_iterator node_itr) {
-  NormalizedBindingData& bindingData = node_itr.getNode();
-  if (!node_itr.isTerminal()) {
-    bindingData.create(*this, node_itr);
-    FruitAssert(node_itr.isTerminal());
+  if (node_itr.isTerminal()) {
+    return node_itr.getNode().getObject();
   }
-  return bindingData.getObject();
+  void* p = instances.get(node_itr.getIndex());
+  if (p == nullptr) {
+    p = createInstance(node_itr);
+  }
+  return p;
 }
 
 inline NormalizedMultibindingData* InjectorStorage::getNormalizedMultibindingData(TypeId type) {
@@ -230,12 +232,23 @@ inline std::shared_ptr<char> InjectorStorage::createMultibindingVector(InjectorS
   // instead of calling this).
   FruitAssert(multibinding != nullptr);
   
-  if (multibinding->v.get() != nullptr) {
+  if (multibinding->v.get() != nullptr && !multibinding->v_is_stale) {
     // Result cached, return early.
     return multibinding->v;
   }
   
-  storage.ensureConstructedMultibinding(*multibinding);
+  storage.ensureConstructedMultibinding(type, *multibinding);
+  
+  if (multibinding->v.get() != nullptr) {
+    // The injector was reset, reuse the vector.
+    std::vector<C*>& s = *reinterpret_cast<std::vector<C*>*>(multibinding->v.get());
+    s.clear();
+    for (const NormalizedMultibindingData::Elem& elem : multibinding->elems) {
+      s.push_back(reinterpret_cast<C*>(elem.object));
+    }
+    multibinding->v_is_stale = false;
+    return multibinding->v;
+  }
   
   std::vector<C*> s;
   s.reserve(multibinding->elems.size());
@@ -259,9 +272,7 @@ inline std::tuple<TypeId, BindingData> InjectorStorage::createBindingDataForBind
   FruitStaticAssert(fruit::impl::meta::Not(fruit::impl::meta::IsPointer(fruit::impl::meta::Type<I>)));
   FruitStaticAssert(fruit::impl::meta::Not(fruit::impl::meta::IsPointer(fruit::impl::meta::Type<C>)));
   auto create = [](InjectorStorage& injector, Graph::node_iterator node_itr) {
-    InjectorStorage::Graph::node_iterator bindings_begin = injector.bindings.begin();
-    C* cPtr = injector.get<C*>(injector.lazyGetPtr<AnnotatedC>(node_itr.neighborsBegin(), 0, bindings_begin));
-    node_itr.setTerminal();
+    C* cPtr = injector.get<C*>(injector.lazyGetPtr<AnnotatedC>(node_itr.neighborsBegin(), 0, injector.bindings));
     // This step is needed when the cast C->I changes the pointer
     // (e.g. for multiple inheritance).
     I* iPtr = static_cast<I*>(cPtr);
@@ -323,11 +334,8 @@ struct InvokeLambdaWithInjectedArgVector<AnnotatedSignature, Lambda, true /* lam
     // `deps' *is* used below, but when there are no AnnotatedArgs some compilers report it as unused.
     (void)deps;
     
-    InjectorStorage::Graph::node_iterator bindings_begin = bindings.begin();
-    // `bindings_begin' *is* used below, but when there are no AnnotatedArgs some compilers report it as unused.
-    (void) bindings_begin;
     CPtr cPtr = constructHelper(injector,
-        injector.lazyGetPtr<InjectorStorage::NormalizeType<fruit::impl::meta::UnwrapType<AnnotatedArgs>>>(deps, indexes, bindings_begin)
+        injector.lazyGetPtr<InjectorStorage::NormalizeType<fruit::impl::meta::UnwrapType<AnnotatedArgs>>>(deps, indexes, bindings)
         ...);
     allocator.registerExternallyAllocatedObject(cPtr);
     
@@ -362,15 +370,12 @@ struct InvokeLambdaWithInjectedArgVector<AnnotatedSignature, Lambda, false /* la
 
   C* operator()(InjectorStorage& injector, SemistaticGraph<TypeId, NormalizedBindingData>& bindings,
                 FixedSizeAllocator& allocator, InjectorStorage::Graph::edge_iterator deps) {
-    InjectorStorage::Graph::node_iterator bindings_begin = bindings.begin();
-    // `bindings_begin' *is* used below, but when there are no AnnotatedArgs some compilers report it as unused.
-    (void) bindings_begin;
     
     // `deps' *is* used below, but when there are no AnnotatedArgs some compilers report it as unused.
     (void)deps;
     
     C* p = constructHelper(injector, allocator,
-        injector.lazyGetPtr<InjectorStorage::NormalizeType<fruit::impl::meta::UnwrapType<AnnotatedArgs>>>(deps, indexes, bindings_begin)
+        injector.lazyGetPtr<InjectorStorage::NormalizeType<fruit::impl::meta::UnwrapType<AnnotatedArgs>>>(deps, indexes, bindings)
         ...);
     return p;
   }
@@ -390,10 +395,10 @@ inline std::tuple<TypeId, BindingData> InjectorStorage::createBindingDataForProv
   auto create = [](InjectorStorage& injector, Graph::node_iterator node_itr) {
     C* cPtr = InvokeLambdaWithInjectedArgVector<AnnotatedSignature, Lambda, std::is_pointer<T>::value>()(
         injector, injector.bindings, injector.allocator, node_itr.neighborsBegin());
-    node_itr.setTerminal();
     return reinterpret_cast<BindingData::object_t>(cPtr);
   };
-  const BindingDeps* deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>>();
+  const BindingDeps* deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>, NormalizedNonProviderSignatureArgs<AnnotatedSignature>,
+                                           IsAsyncProviderFuture<C>::value>();
   bool needs_allocation = !std::is_pointer<T>::value;
   return std::make_tuple(getTypeId<AnnotatedC>(), BindingData(create, deps, needs_allocation));
 }
@@ -413,11 +418,10 @@ inline std::tuple<TypeId, TypeId, BindingData> InjectorStorage::createBindingDat
   auto create = [](InjectorStorage& injector, Graph::node_iterator node_itr) {
     C* cPtr = InvokeLambdaWithInjectedArgVector<AnnotatedSignature, Lambda, std::is_pointer<T>::value>()(
         injector, injector.bindings, injector.allocator, node_itr.neighborsBegin());
-    node_itr.setTerminal();
     I* iPtr = static_cast<I*>(cPtr);
     return reinterpret_cast<BindingData::object_t>(iPtr);
   };
-  const BindingDeps* deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>>();
+  const BindingDeps* deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>, NormalizedNonProviderSignatureArgs<AnnotatedSignature>>();
   bool needs_allocation = !std::is_pointer<T>::value;
   return std::make_tuple(getTypeId<AnnotatedI>(), getTypeId<AnnotatedC>(), BindingData(create, deps, needs_allocation));
 }
@@ -452,11 +456,8 @@ struct InvokeConstructorWithInjectedArgVector<AnnotatedC(AnnotatedArgs...), frui
     // `deps' *is* used below, but when there are no Args some compilers report it as unused.
     (void)deps;
     
-    InjectorStorage::Graph::node_iterator bindings_begin = bindings.begin();
-    // `bindings_begin' *is* used below, but when there are no Args some compilers report it as unused.
-    (void) bindings_begin;
     C* p = constructHelper(injector, allocator,
-        injector.lazyGetPtr<InjectorStorage::NormalizeType<AnnotatedArgs>>(deps, indexes, bindings_begin)
+        injector.lazyGetPtr<InjectorStorage::NormalizeType<AnnotatedArgs>>(deps, indexes, bindings)
         ...);
     return p;
   }
@@ -469,10 +470,9 @@ inline std::tuple<TypeId, BindingData> InjectorStorage::createBindingDataForCons
   auto create = [](InjectorStorage& injector, Graph::node_iterator node_itr) {
     C* cPtr = InvokeConstructorWithInjectedArgVector<AnnotatedSignature>()(injector, 
                   injector.bindings, injector.allocator, node_itr.neighborsBegin());
-    node_itr.setTerminal();
     return reinterpret_cast<BindingData::object_t>(cPtr);
   };
-  const BindingDeps* deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>>();
+  const BindingDeps* deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>, NormalizedNonProviderSignatureArgs<AnnotatedSignature>>();
   return std::make_tuple(getTypeId<AnnotatedC>(), BindingData(create, deps, true /* needs_allocation */));
 }
 
@@ -484,11 +484,10 @@ inline std::tuple<TypeId, TypeId, BindingData> InjectorStorage::createBindingDat
   auto create = [](InjectorStorage& injector, Graph::node_iterator node_itr) {
     C* cPtr = InvokeConstructorWithInjectedArgVector<AnnotatedSignature>()(injector, 
                   injector.bindings, injector.allocator, node_itr.neighborsBegin());
-    node_itr.setTerminal();
     I* iPtr = static_cast<I*>(cPtr);
     return reinterpret_cast<BindingData::object_t>(iPtr);
   };
-  const BindingDeps* deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>>();
+  const BindingDeps* deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>, NormalizedNonProviderSignatureArgs<AnnotatedSignature>>();
   return std::make_tuple(getTypeId<AnnotatedI>(), getTypeId<AnnotatedC>(), BindingData(create, deps, true /* needs_allocation */));
 }
 
@@ -531,7 +530,7 @@ inline std::tuple<TypeId, MultibindingData> InjectorStorage::createMultibindingD
   };
   bool needs_allocation = !std::is_pointer<T>::value;
   return std::make_tuple(getTypeId<AnnotatedC>(),
-                         MultibindingData(create, getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>>(), InjectorStorage::createMultibindingVector<AnnotatedC>,
+                         MultibindingData(create, getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>, NormalizedNonProviderSignatureArgs<AnnotatedSignature>>(), InjectorStorage::createMultibindingVector<AnnotatedC>,
                                           needs_allocation));
 }
 
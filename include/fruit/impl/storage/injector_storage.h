@@ -18,10 +18,16 @@
 #define FRUIT_INJECTOR_STORAGE_H
 
 #include <fruit/fruit_forward_decls.h>
+#include <fruit/construction_phase_times.h>
+#include <fruit/injection_profile.h>
+#include <fruit/injector_memory_usage.h>
+#include <fruit/impl/fruit_internal_forward_decls.h>
 #include <fruit/impl/binding_data.h>
 #include <fruit/impl/data_structures/fixed_size_allocator.h>
+#include <fruit/impl/data_structures/instance_table.h>
 #include <fruit/impl/meta/component.h>
 
+#include <functional>
 #include <vector>
 #include <unordered_map>
 
@@ -66,6 +72,12 @@ public:
       fruit::impl::meta::NormalizeTypeVector(fruit::impl::meta::SignatureArgs(fruit::impl::meta::Type<Signature>))
       >;
   
+  // Similar to NormalizedSignatureArgs, but without the Provider<...> args, whose types are only injected lazily.
+  template <typename Signature>
+  using NormalizedNonProviderSignatureArgs = fruit::impl::meta::Eval<
+      fruit::impl::meta::NormalizeTypeVector(fruit::impl::meta::RemoveProviders(fruit::impl::meta::SignatureArgs(fruit::impl::meta::Type<Signature>)))
+      >;
+  
   // Prints the specified error and calls exit(1).
   static void fatal(const std::string& error);
   
@@ -113,12 +125,64 @@ private:
   FixedSizeAllocator allocator;
   
   // A graph with injected types as nodes (each node stores the NormalizedBindingData for the type) and dependencies as edges.
-  // For types that have a constructed object already, the corresponding node is stored as terminal node.
+  // For types that were bound to an already-constructed object, the corresponding node is stored as terminal node.
+  // This is never modified after construction (except by reset()); when constructing from a NormalizedComponentStorage, most of the graph
+  // is shared with the one in the NormalizedComponentStorage.
   SemistaticGraph<TypeId, NormalizedBindingData> bindings;
   
+  // The objects constructed so far for non-terminal nodes of `bindings', indexed by node index.
+  InstanceTable instances;
+  
   // Maps the type index of a type T to the corresponding NormalizedMultibindingData object (that stores all multibindings).
   std::unordered_map<TypeId, NormalizedMultibindingData> multibindings;
   
+  // The NormalizedComponentStorage that the bindings of this injector were built from (for child injectors, the one of the
+  // root injector). Child injectors use it to undo binding compressions.
+  const NormalizedComponentStorage* normalized_component_storage = nullptr;
+  
+  // If not nullptr, the objects for some nodes (see isParentNode()) are constructed by (and owned by) this other storage.
+  // This is the storage of the parent injector for child injectors, and the storage shared by all injectors of a
+  // NormalizedComponent for component-scoped nodes (see NormalizedComponentStorage::shareComponentScopedInstances()).
+  // Multibindings for types that have no multibindings in this injector are also taken from parent_storage.
+  InjectorStorage* parent_storage = nullptr;
+  
+  // Only used for the storage shared by the injectors of a NormalizedComponent: (*parent_nodes)[i] is true iff the node
+  // with index i is component-scoped. It's nullptr for child injectors.
+  const std::vector<bool>* parent_nodes = nullptr;
+  
+  // Only used for child injectors: the nodes with index smaller than num_parent_nodes are the ones of the parent injector,
+  // and rebound_parent_nodes contains (sorted) the indexes of the ones that are re-bound in this injector instead.
+  // There are usually very few of those (e.g. the ones involved in undoing a binding compression).
+  std::size_t num_parent_nodes = 0;
+  std::vector<std::size_t> rebound_parent_nodes;
+  
+  // If not nullptr, eagerlyInjectConstructionSchedule() constructs the objects for these node indexes, in this order.
+  // See NormalizedComponentStorage::construction_schedule.
+  const std::vector<std::size_t>* construction_schedule = nullptr;
+  
+  // True if this was constructed from a NormalizedComponentStorage and instances of its required types. Only these
+  // injectors can be reset().
+  bool constructed_from_required_instances = false;
+  
+  // If true, get(), unsafeGet(), getMultibindings() and Provider::get() can be called concurrently from multiple threads.
+  bool concurrent_injection_enabled = false;
+  
+  // If not nullptr, each construction performed by this injector is recorded here. See enableProfiling().
+  std::unique_ptr<InjectionProfiler> profiler;
+  
+  // How long the construction of this object took. For the 1-argument constructor, this is the construction of the owned
+  // NormalizedComponentStorage, that's most of the work.
+  ConstructionPhaseTimes construction_phase_times;
+  
+#if FRUIT_ENABLE_INJECTION_EVENTS
+  // The type of each node of `bindings', indexed by node index. Used to record injection events.
+  std::vector<TypeId> node_types;
+#endif
+  
+  // Runs the tasks passed to runAsync(). This is set by enableConcurrentInjection(), and it's declared last so that it's
+  // destroyed first: its destructor waits for the tasks, that use the other fields.
+  std::unique_ptr<AsyncExecutor> async_executor;
+  
 private:
   
   template <typename AnnotatedC>
@@ -138,6 +202,22 @@ private:
   // Similar to the previous, but takes a node_iterator. Use this when the node_iterator is known, it's faster.
   void* getPtrInternal(Graph::node_iterator itr);
   
+  // Calls NormalizedBindingData::create() for the node, measuring it if profiling is enabled. Doesn't store the result.
+  void* invokeCreate(Graph::node_iterator itr);
+  
+  // Used instead of NormalizedBindingData::create() when concurrent injection is enabled.
+  // Constructs the object for a non-terminal node, or waits until another thread that's constructing it is done.
+  // In both cases, returns the object (that is also stored in `instances').
+  void* createConcurrently(Graph::node_iterator itr);
+  
+  // Returns true if the object for the node with the specified index is constructed by parent_storage.
+  // Precondition: parent_storage != nullptr.
+  bool isParentNode(std::size_t index) const;
+  
+  // Used when the object for a non-terminal node was not constructed yet. Constructs it (or gets it from
+  // parent_storage) and stores it in `instances'.
+  void* createInstance(Graph::node_iterator itr);
+  
   // getPtr(typeInfo) is equivalent to getPtr(lazyGetPtr(typeInfo)).
   Graph::node_iterator lazyGetPtr(TypeId type);
   
@@ -152,8 +232,25 @@ private:
   // Returns a std::vector<T*>*, or nullptr if there are no multibindings.
   void* getMultibindings(TypeId type);
   
-  // Constructs any necessary instances, but NOT the instance set.
-  void ensureConstructedMultibinding(NormalizedMultibindingData& multibinding_data);
+  // Similar to getMultibindings(), but used when concurrent injection is enabled. Constructs the vector at most once, even
+  // if multiple threads ask for it concurrently.
+  void* getMultibindingsConcurrently(NormalizedMultibindingData& multibinding_data);
+  
+  // Constructs any necessary instances, but NOT the instance set. `type' is the type of the multibindings.
+  void ensureConstructedMultibinding(TypeId type, NormalizedMultibindingData& multibinding_data);
+  
+  // Normalizes the bindings in `component' that are not in `base_bindings' yet (checking that the ones that are have the
+  // same binding), and adds the ones needed to undo the binding compressions of `normalized_component' that no longer
+  // apply. `base_bindings' is normalized_component.bindings or a graph built on it.
+  // If allocator_data_has_compressed_types is false, this also adds the space for the types whose binding compression is
+  // undone to `fixed_size_allocator_data'.
+  static std::vector<std::pair<TypeId, BindingData>> normalizeAdditionalBindings(
+      const Graph& base_bindings,
+      const NormalizedComponentStorage& normalized_component,
+      const ComponentStorage& component,
+      FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+      bool allocator_data_has_compressed_types,
+      std::vector<TypeId>&& exposed_types);
   
   template <typename T>
   friend struct GetHelper;
@@ -161,6 +258,9 @@ private:
   template <typename T>
   friend class fruit::Provider;
   
+  template <typename... P>
+  friend class fruit::Injector;
+  
 public:
   
   // Wraps a std::vector<std::pair<TypeId, BindingData>>::iterator as an iterator on tuples
@@ -190,6 +290,19 @@ public:
                   const ComponentStorage& storage,
                   std::vector<TypeId>&& exposed_types);
   
+  // Constructs an injector from a NormalizedComponentStorage and an instance of each of its required types.
+  // required_instances[i] is (getTypeId<T>(), &instance) for the instance of type T; the order doesn't matter.
+  // This doesn't normalize any binding.
+  InjectorStorage(const NormalizedComponentStorage& normalized_storage,
+                  const std::pair<TypeId, void*>* required_instances,
+                  std::size_t num_required_instances);
+  
+  // Constructs a child injector of `parent', that has the bindings in `storage' in addition to the ones in `parent'.
+  // `parent' must outlive this object.
+  InjectorStorage(InjectorStorage& parent,
+                  const ComponentStorage& storage,
+                  std::vector<TypeId>&& exposed_types);
+  
   // This is just the default destructor, but we declare it here to avoid including
   // normalized_component_storage.h in fruit.h.
   ~InjectorStorage();
@@ -215,7 +328,7 @@ public:
   // and also                        to get<T>         (lazyGetPtr<Apply<NormalizeType, AnnotatedT>>(deps, dep_index))
   // dep_index is the index of the dep in `deps'.
   template <typename AnnotatedC>
-  Graph::node_iterator lazyGetPtr(Graph::edge_iterator deps, std::size_t dep_index, Graph::node_iterator bindings_begin);
+  Graph::node_iterator lazyGetPtr(Graph::edge_iterator deps, std::size_t dep_index, Graph& bindings);
   
   // Returns nullptr if AnnotatedC was not bound.
   template <typename AnnotatedC>
@@ -225,6 +338,63 @@ public:
   const std::vector<RemoveAnnotations<AnnotatedC>*>& getMultibindings();
   
   void eagerlyInjectMultibindings();
+  
+  // Constructs the objects in the construction schedule of the NormalizedComponentStorage (if any) that weren't
+  // constructed yet. This is equivalent to getting all the types exposed by the NormalizedComponentStorage (or by the
+  // injector, for the 1-argument constructor), but faster.
+  void eagerlyInjectConstructionSchedule();
+  
+  // Similar to eagerlyInjectConstructionSchedule(), but constructs the objects using up to num_threads threads (including
+  // the calling one). Each object is constructed as soon as all the objects it depends on are constructed, so independent
+  // objects are constructed concurrently. Concurrent injection must be enabled already.
+  // If some constructor throws, this waits for the ongoing constructions to finish and then rethrows that exception.
+  void eagerlyInjectConstructionScheduleInParallel(std::size_t num_threads);
+  
+  // Makes eagerlyInjectConstructionSchedule() a no-op. Must be called if the injector doesn't expose all the types exposed
+  // by the NormalizedComponentStorage, since then the schedule might contain types that the injector must not construct.
+  void ignoreConstructionSchedule();
+  
+  // Destroys all the objects constructed by this injector, and replaces the instances of the required types with the
+  // specified ones. Afterwards, this is equivalent to a new injector constructed from normalized_storage and
+  // required_instances, but no memory is allocated: the allocator, the instance table and the graph are reused.
+  // This injector must have been constructed from normalized_storage and instances of its required types.
+  void reset(const NormalizedComponentStorage& normalized_storage,
+             const std::pair<TypeId, void*>* required_instances,
+             std::size_t num_required_instances);
+  
+  // After this call, the injection methods above can be called concurrently from multiple threads.
+  // This must be called before the first concurrent use.
+  void enableConcurrentInjection();
+  
+  // Similar to the above, but runAsync() will use up to max_async_threads threads, instead of
+  // std::thread::hardware_concurrency(). This has no effect if concurrent injection was already enabled.
+  void enableConcurrentInjection(std::size_t max_async_threads);
+  
+  // Runs `task' in another thread, using a bounded number of threads for all the tasks of this injector (see
+  // enableConcurrentInjection()); if more tasks are pending, they're run as soon as a thread is free. Used to implement
+  // Injector::getAsync(). enableConcurrentInjection() must have been called before. The task must not throw.
+  void runAsync(std::function<void()> task);
+  
+  // Reports a fatal error if enableConcurrentInjection() wasn't called. Used by the methods that inject asynchronously.
+  void checkConcurrentInjectionEnabled() const;
+  
+  // After this call, each construction performed by this injector is measured, see getProfile().
+  // This must be called before the first concurrent use, if any.
+  void enableProfiling();
+  
+  // Returns the constructions measured since enableProfiling() was called (that must have been called before).
+  // This must not be called concurrently with other methods.
+  InjectionProfile getProfile();
+  
+  // After this call, the objects allocated by this injector are recorded by type, see getMemoryUsage().
+  // This must be called before any object is constructed.
+  void enableMemoryAccounting();
+  
+  // Returns the memory used by this injector. This must not be called concurrently with other methods.
+  InjectorMemoryUsage getMemoryUsage();
+  
+  // Returns how long the construction of this injector took, split by phase.
+  const ConstructionPhaseTimes& getConstructionPhaseTimes() const;
 };
 
 } // namespace impl
@@ -61,12 +61,59 @@ private:
   // We hold this via a unique_ptr to avoid including Boost's hashmap implementation.
   std::unique_ptr<BindingNormalization::BindingCompressionInfoMap> bindingCompressionInfoMap;
   
+  // component_scoped_nodes[i] is true iff the node with index i in `bindings' is bound in this component, and all its
+  // (direct and indirect) dependencies are bound in this component too. The objects for these nodes don't depend on the
+  // bindings added when constructing an injector, so they can be shared by all injectors created from this component.
+  // Nodes involved in binding compression are never component-scoped, since injectors might need to undo the compression.
+  // This is only computed by shareComponentScopedInstances(). Until then, only the nodes bound to an object are marked.
+  std::vector<bool> component_scoped_nodes;
+  
+  // deps_by_index[i] is the BindingDeps of the node with index i in `bindings', or nullptr if that node is not bound in
+  // this component or it's bound to an object. Only kept until component_scoped_nodes is computed.
+  std::vector<const BindingDeps*> deps_by_index;
+  
+  // The indexes of the non-terminal nodes of `bindings' that are needed to inject the exposed types, where each node comes
+  // after the nodes of its dependencies (except the ones only injected through a Provider, that are not included unless
+  // they're needed by another node). Constructing the objects in this order doesn't need any recursive construction
+  // (except for nodes that an injector replaces, e.g. to undo a binding compression), so eagerlyInjectAll() can just
+  // construct them in a loop.
+  std::vector<std::size_t> construction_schedule;
+  
+  // The dependencies between the nodes in construction_schedule, as (i, j) pairs meaning that the node at position j in
+  // construction_schedule depends on the one at position i. This may contain duplicates. Only used to construct
+  // independent objects concurrently, see InjectorStorage::eagerlyInjectConstructionScheduleInParallel().
+  std::vector<std::pair<std::size_t, std::size_t>> construction_schedule_deps;
+  
+  // The positions in construction_schedule of the nodes that start an async provider (see
+  // BindingDeps::starts_async_provider), in increasing order. Eager injection constructs these first, so that all the
+  // async computations are started before waiting for any of them.
+  std::vector<std::size_t> async_provider_starts;
+  
+  // For each of the Required<...> types of the NormalizedComponent that some type bound in this component depends on, the
+  // TypeId and the index of the corresponding (non-existent) node of `bindings'. An injector constructed from instances
+  // of the required types only needs to turn these nodes into terminal nodes, so it doesn't need to normalize any binding.
+  std::vector<std::pair<TypeId, std::size_t>> required_type_nodes;
+  
+  // False if some Required<...> type is not in required_type_nodes, because no type bound in this component depends on it.
+  bool all_required_types_have_nodes = true;
+  
+  // How long the construction of this object took.
+  ConstructionPhaseTimes construction_phase_times;
+  
+  // If not nullptr, this InjectorStorage constructs and owns the objects for the component-scoped nodes, on behalf of all
+  // the injectors created from this component. See shareComponentScopedInstances().
+  // This is declared last so that it's destroyed first, since it references the other fields.
+  std::unique_ptr<InjectorStorage> shared_instances_storage;
+  
   friend class InjectorStorage;
   
 public:
   NormalizedComponentStorage() = delete;
   
-  NormalizedComponentStorage(const ComponentStorage& component, const std::vector<TypeId>& exposed_types);
+  // `required_types' are the types in the Required<...> of the NormalizedComponent (if any).
+  NormalizedComponentStorage(const ComponentStorage& component,
+                             const std::vector<TypeId>& exposed_types,
+                             const std::vector<TypeId>& required_types);
 
   NormalizedComponentStorage(NormalizedComponentStorage&&) = delete;
   NormalizedComponentStorage(const NormalizedComponentStorage&) = delete;
@@ -77,6 +124,13 @@ public:
   // We don't use the default destructor because that will require the inclusion of
   // the Boost's hashmap header. We define this in the cpp file instead.
   ~NormalizedComponentStorage();
+  
+  // After this call, the instances of component-scoped types (see component_scoped_nodes) are constructed at most once
+  // and shared by all injectors created from this component. Must be called before any such injector is created.
+  void shareComponentScopedInstances();
+  
+  // Returns how long the construction of this object took, split by phase.
+  const ConstructionPhaseTimes& getConstructionPhaseTimes() const;
 };
 
 } // namespace impl
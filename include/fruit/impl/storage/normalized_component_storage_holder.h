@@ -20,6 +20,7 @@
 #include <memory>
 #include <fruit/impl/fruit_internal_forward_decls.h>
 #include <fruit/fruit_forward_decls.h>
+#include <fruit/construction_phase_times.h>
 
 namespace fruit {
 namespace impl {
@@ -41,7 +42,9 @@ private:
 public:
   NormalizedComponentStorageHolder() = delete;
   
-  NormalizedComponentStorageHolder(const ComponentStorage& component, const std::vector<TypeId>& exposed_types);
+  NormalizedComponentStorageHolder(const ComponentStorage& component,
+                                   const std::vector<TypeId>& exposed_types,
+                                   const std::vector<TypeId>& required_types);
 
   NormalizedComponentStorageHolder(NormalizedComponentStorage&&) = delete;
   NormalizedComponentStorageHolder(const NormalizedComponentStorage&) = delete;
@@ -52,6 +55,12 @@ public:
   // We don't use the default destructor because that would require the inclusion of
   // normalized_component_storage.h. We define this in the cpp file instead.
   ~NormalizedComponentStorageHolder();
+  
+  // See NormalizedComponentStorage::shareComponentScopedInstances().
+  void shareComponentScopedInstances();
+  
+  // See NormalizedComponentStorage::getConstructionPhaseTimes().
+  ConstructionPhaseTimes getConstructionPhaseTimes() const;
 };
 
 } // namespace impl
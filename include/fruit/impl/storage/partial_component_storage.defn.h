@@ -122,6 +122,21 @@ public:
   }
 };
 
+template <typename... Params, typename... PreviousBindings>
+class PartialComponentStorage<RegisterAsyncProvider<Params...>, PreviousBindings...> {
+private:
+  PartialComponentStorage<PreviousBindings...> &previous_storage;
+
+public:
+  PartialComponentStorage(PartialComponentStorage<PreviousBindings...>& previous_storage)
+      : previous_storage(previous_storage) {
+  }
+
+  void addBindings(ComponentStorage& storage) const {
+    previous_storage.addBindings(storage);
+  }
+};
+
 template <typename C, typename... PreviousBindings>
 class PartialComponentStorage<AddInstanceMultibinding<C>, PreviousBindings...> {
 private:
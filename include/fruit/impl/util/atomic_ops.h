@@ -0,0 +1,60 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_ATOMIC_OPS_H
+#define FRUIT_ATOMIC_OPS_H
+
+namespace fruit {
+namespace impl {
+
+// Atomic operations on plain (non-std::atomic) fields.
+// We can't use std::atomic<T> for these fields, since they're stored in structs that must be trivially copyable (e.g. the
+// nodes of a SemistaticGraph). All accesses that can race with each other must go through these functions.
+// These use the GCC/Clang builtins, since MSVC is not supported anyway.
+
+template <typename T>
+inline T atomicLoadAcquire(const T* p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+template <typename T>
+inline void atomicStoreRelease(T* p, T value) {
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+// If *p==expected, sets *p to `desired' and returns true. Otherwise, stores the current value of *p in `expected' and
+// returns false.
+template <typename T>
+inline bool atomicCompareExchange(T* p, T& expected, T desired) {
+  return __atomic_compare_exchange_n(p, &expected, desired, false /* weak */, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// Atomically sets *p to (*p | value) and returns the old value of *p.
+template <typename T>
+inline T atomicFetchOr(T* p, T value) {
+  return __atomic_fetch_or(p, value, __ATOMIC_ACQ_REL);
+}
+
+// Atomically sets *p to (*p & value) and returns the old value of *p.
+template <typename T>
+inline T atomicFetchAnd(T* p, T value) {
+  return __atomic_fetch_and(p, value, __ATOMIC_ACQ_REL);
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_ATOMIC_OPS_H
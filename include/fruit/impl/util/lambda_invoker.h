@@ -47,6 +47,91 @@ public:
   }
 };
 
+template <typename Lambda, typename LambdaMethod = decltype(&Lambda::operator())>
+struct AsyncProviderTraits;
+
+// Lambda is a provider (taking Args...) that returns a Future, that is a std::future<T>, a std::shared_future<T> or a
+// similar type with a get() method. This is what PartialComponent::registerAsyncProvider() takes. T is either C or C*.
+template <typename Lambda, typename Future, typename LambdaObject, typename... Args>
+struct AsyncProviderTraits<Lambda, Future(LambdaObject::*)(Args...) const> {
+  using FutureType = Future;
+  using T = typename std::decay<decltype(std::declval<Future&>().get())>::type;
+  using Signature = T(Args...);
+};
+
+// registerAsyncProvider<AnnotatedSignature>(Lambda) registers 2 providers:
+// * AsyncProviderStart, that calls the Lambda (starting the computation) and binds its result as an
+//   AsyncProviderFuture<AnnotatedSignature, Lambda>. This type is not exposed.
+// * AsyncProviderJoin, that takes the AsyncProviderFuture and waits for the result, binding C.
+// So the computation can be started before any object waits for its result (see BindingDeps::starts_async_provider).
+template <typename AnnotatedSignature, typename Lambda>
+struct AsyncProviderFuture {
+  typename AsyncProviderTraits<Lambda>::FutureType future;
+};
+
+template <typename C>
+struct IsAsyncProviderFuture : std::false_type {};
+
+template <typename AnnotatedSignature, typename Lambda>
+struct IsAsyncProviderFuture<AsyncProviderFuture<AnnotatedSignature, Lambda>> : std::true_type {};
+
+template <typename AnnotatedSignature, typename Lambda, typename LambdaMethod = decltype(&Lambda::operator())>
+struct AsyncProviderStart;
+
+// Like a lambda with no captures, this is empty and convertible to a function pointer, so it can be used as a provider.
+template <typename AnnotatedSignature, typename Lambda, typename Future, typename LambdaObject, typename... Args>
+struct AsyncProviderStart<AnnotatedSignature, Lambda, Future(LambdaObject::*)(Args...) const> {
+  using Result = AsyncProviderFuture<AnnotatedSignature, Lambda>;
+  
+  static Result invoke(Args... args) {
+    return Result{LambdaInvoker::invoke<Lambda, Args...>(args...)};
+  }
+  
+  Result operator()(Args... args) const {
+    return invoke(args...);
+  }
+  
+  using FunctionPtr = Result(*)(Args...);
+  
+  operator FunctionPtr() const {
+    return &invoke;
+  }
+};
+
+template <typename AnnotatedSignature, typename Lambda>
+struct AsyncProviderJoin {
+  using T = typename AsyncProviderTraits<Lambda>::T;
+  using Future = AsyncProviderFuture<AnnotatedSignature, Lambda>;
+  
+  static T invoke(Future* future) {
+    return future->future.get();
+  }
+  
+  T operator()(Future* future) const {
+    return invoke(future);
+  }
+  
+  using FunctionPtr = T(*)(Future*);
+  
+  operator FunctionPtr() const {
+    return &invoke;
+  }
+};
+
+template <typename AnnotatedSignature, typename Lambda>
+struct AsyncProviderSignatures;
+
+template <typename AnnotatedT, typename... AnnotatedArgs, typename Lambda>
+struct AsyncProviderSignatures<AnnotatedT(AnnotatedArgs...), Lambda> {
+  using Future = AsyncProviderFuture<AnnotatedT(AnnotatedArgs...), Lambda>;
+  
+  // The signature of AsyncProviderStart<AnnotatedT(AnnotatedArgs...), Lambda>.
+  using StartSignature = Future(AnnotatedArgs...);
+  
+  // The signature of AsyncProviderJoin<AnnotatedT(AnnotatedArgs...), Lambda>.
+  using JoinSignature = AnnotatedT(Future*);
+};
+
 } // namespace impl
 } // namespace fruit
 
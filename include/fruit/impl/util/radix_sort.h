@@ -0,0 +1,77 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_RADIX_SORT_H
+#define FRUIT_RADIX_SORT_H
+
+#include <climits>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace fruit {
+namespace impl {
+
+// Sorts `v' by getKey(x) (a std::size_t) with an LSD radix sort on 8-bit digits. The sort is stable, and T must be default
+// constructible.
+// This is much faster than std::sort for the large vectors of bindings and of node IDs sorted by TypeId when
+// constructing a component. Digits that are the same in all keys are skipped, so keys that only differ in the low-order
+// bits (e.g. the addresses of the TypeInfo objects, that are all in the same section of the binary) take few passes.
+template <typename T, typename GetKey>
+void radixSort(std::vector<T>& v, GetKey getKey) {
+  constexpr std::size_t digit_bits = 8;
+  constexpr std::size_t num_buckets = std::size_t(1) << digit_bits;
+  constexpr std::size_t num_digits = sizeof(std::size_t) * CHAR_BIT / digit_bits;
+
+  if (v.size() <= 1) {
+    return;
+  }
+
+  // counts[digit * num_buckets + b] is the number of keys where the specified digit is b.
+  std::vector<std::size_t> counts(num_digits * num_buckets, 0);
+  for (const T& x : v) {
+    std::size_t key = getKey(x);
+    for (std::size_t digit = 0; digit < num_digits; ++digit) {
+      ++counts[digit * num_buckets + ((key >> (digit * digit_bits)) & (num_buckets - 1))];
+    }
+  }
+
+  std::vector<T> buffer(v.size());
+  for (std::size_t digit = 0; digit < num_digits; ++digit) {
+    std::size_t shift = digit * digit_bits;
+    std::size_t* digit_counts = counts.data() + digit * num_buckets;
+    if (digit_counts[(getKey(v[0]) >> shift) & (num_buckets - 1)] == v.size()) {
+      // All keys have the same value for this digit.
+      continue;
+    }
+    // Now digit_counts[b] becomes the position in `buffer' of the next element where the digit is b.
+    std::size_t position = 0;
+    for (std::size_t b = 0; b < num_buckets; ++b) {
+      std::size_t count = digit_counts[b];
+      digit_counts[b] = position;
+      position += count;
+    }
+    for (T& x : v) {
+      buffer[digit_counts[(getKey(x) >> shift) & (num_buckets - 1)]++] = std::move(x);
+    }
+    v.swap(buffer);
+  }
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_RADIX_SORT_H
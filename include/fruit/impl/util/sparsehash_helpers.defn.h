@@ -34,7 +34,7 @@ inline HashSet<T> createHashSet(size_t capacity, T invalidValue1, T invalidValue
   (void)invalidValue2;
   //result.set_empty_key(invalidValue1);
   //result.set_deleted_key(invalidValue2);
-  return std::move(result);
+  return result;
 }
 
 template <typename Key, typename Value>
@@ -49,7 +49,7 @@ inline HashMap<Key, Value> createHashMap(size_t capacity, Key invalidKey1, Key i
   (void)invalidKey2;
   //result.set_empty_key(invalidKey1);
   //result.set_deleted_key(invalidKey2);
-  return std::move(result);
+  return result;
 }
 
 } // namespace impl
@@ -25,16 +25,37 @@
 namespace fruit {
 namespace impl {
   
+#if FRUIT_ENABLE_TYPE_FINGERPRINTS
+
+// This should only be used if RTTI is disabled. Use the other constructor if possible.
+inline constexpr TypeInfo::TypeInfo(std::size_t type_size, std::size_t type_alignment, bool is_trivially_destructible,
+                                    std::uint64_t type_fingerprint)
+: info(nullptr), type_size(type_size), type_alignment(type_alignment), type_fingerprint(type_fingerprint),
+  is_trivially_destructible(is_trivially_destructible) {
+}
+
+inline constexpr TypeInfo::TypeInfo(const std::type_info& info, std::size_t type_size, std::size_t type_alignment, 
+                    bool is_trivially_destructible, std::uint64_t type_fingerprint)
+: info(&info), type_size(type_size), type_alignment(type_alignment), type_fingerprint(type_fingerprint),
+  is_trivially_destructible(is_trivially_destructible) {
+}
+
+#else
+
 // This should only be used if RTTI is disabled. Use the other constructor if possible.
 inline constexpr TypeInfo::TypeInfo(std::size_t type_size, std::size_t type_alignment, bool is_trivially_destructible)
-: info(nullptr), type_size(type_size), type_alignment(type_alignment), is_trivially_destructible(is_trivially_destructible) {
+: info(nullptr), type_size(type_size), type_alignment(type_alignment),
+  is_trivially_destructible(is_trivially_destructible) {
 }
 
 inline constexpr TypeInfo::TypeInfo(const std::type_info& info, std::size_t type_size, std::size_t type_alignment, 
                     bool is_trivially_destructible)
-: info(&info), type_size(type_size), type_alignment(type_alignment), is_trivially_destructible(is_trivially_destructible) {
+: info(&info), type_size(type_size), type_alignment(type_alignment),
+  is_trivially_destructible(is_trivially_destructible) {
 }
 
+#endif
+
 inline std::string TypeInfo::name() const {
   if (info != nullptr)
     return demangleTypeName(info->name());
@@ -53,6 +74,77 @@ inline size_t TypeInfo::alignment() const {
 inline bool TypeInfo::isTriviallyDestructible() const {
   return is_trivially_destructible;
 }
+
+inline std::uint64_t TypeInfo::fingerprint() const {
+#if FRUIT_ENABLE_TYPE_FINGERPRINTS
+  return type_fingerprint;
+#else
+  return 0;
+#endif
+}
+
+// The fingerprint functions are constexpr functions with a single return statement, as required by C++11. The name is
+// hashed by splitting it in halves recursively (instead of e.g. with FNV-1a) so that the recursion depth is only
+// logarithmic in the length of the name, since the names of template instantiations can be very long. The leaves of
+// the recursion are blocks of up to 16 chars, to limit the number of constexpr calls (and so the compile time).
+
+inline constexpr std::uint64_t fingerprintXorShift(std::uint64_t h) {
+  return h ^ (h >> 33);
+}
+
+// The finalizer of MurmurHash3.
+inline constexpr std::uint64_t fingerprintMix(std::uint64_t h) {
+  return fingerprintXorShift(fingerprintXorShift(fingerprintXorShift(h) * 0xff51afd7ed558ccdULL) * 0xc4ceb9fe1a85ec53ULL);
+}
+
+inline constexpr std::uint64_t fingerprintCombine(std::uint64_t h1, std::uint64_t h2) {
+  return fingerprintMix(h1 * 0x9e3779b97f4a7c15ULL + h2);
+}
+
+// Returns s[i] (as an unsigned value) shifted left by 8*(i-begin) bits if i < end, or 0 otherwise.
+template <std::size_t N>
+inline constexpr std::uint64_t fingerprintCharInBlock(const char (&s)[N], std::size_t begin, std::size_t i,
+                                                      std::size_t end) {
+  return i < end ? std::uint64_t(static_cast<unsigned char>(s[i])) << (8 * (i - begin)) : 0;
+}
+
+// Packs the chars in s[begin, min(begin + 8, end)) into a 64-bit value.
+template <std::size_t N>
+inline constexpr std::uint64_t fingerprintBlock(const char (&s)[N], std::size_t begin, std::size_t end) {
+  return fingerprintCharInBlock(s, begin, begin, end)
+      | fingerprintCharInBlock(s, begin, begin + 1, end)
+      | fingerprintCharInBlock(s, begin, begin + 2, end)
+      | fingerprintCharInBlock(s, begin, begin + 3, end)
+      | fingerprintCharInBlock(s, begin, begin + 4, end)
+      | fingerprintCharInBlock(s, begin, begin + 5, end)
+      | fingerprintCharInBlock(s, begin, begin + 6, end)
+      | fingerprintCharInBlock(s, begin, begin + 7, end);
+}
+
+// Hashes s[begin, end). Precondition: begin < end.
+template <std::size_t N>
+inline constexpr std::uint64_t fingerprintOfRange(const char (&s)[N], std::size_t begin, std::size_t end) {
+  return end - begin <= 16
+      ? fingerprintCombine(fingerprintBlock(s, begin, end) + 1, fingerprintBlock(s, begin + 8, end))
+      : fingerprintCombine(fingerprintOfRange(s, begin, begin + (end - begin) / 2),
+                           fingerprintOfRange(s, begin + (end - begin) / 2, end));
+}
+
+template <std::size_t N>
+inline constexpr std::uint64_t fingerprintOfString(const char (&s)[N]) {
+  // N includes the terminating '\0', so the range is never empty.
+  return fingerprintCombine(N, fingerprintOfRange(s, 0, N));
+}
+
+template <typename T>
+inline constexpr std::uint64_t getTypeFingerprint() {
+#if FRUIT_ENABLE_TYPE_FINGERPRINTS
+  // __PRETTY_FUNCTION__ contains the name of T, e.g. "... getTypeFingerprint() [with T = Foo; ...]".
+  return fingerprintOfString(__PRETTY_FUNCTION__);
+#else
+  return 0;
+#endif
+}
   
 inline TypeId::operator std::string() const {
   return type_info->name();
@@ -70,13 +162,21 @@ inline bool TypeId::operator<(TypeId x) const {
   return type_info < x.type_info;
 }
 
+// The extra argument passed to the TypeInfo constructor for the fingerprint of the type, if any.
+#if FRUIT_ENABLE_TYPE_FINGERPRINTS
+#define FRUIT_TYPE_INFO_FINGERPRINT_ARG(...) , getTypeFingerprint<__VA_ARGS__>()
+#else
+#define FRUIT_TYPE_INFO_FINGERPRINT_ARG(...)
+#endif
+
 template <typename T>
 struct GetTypeInfoForType {
   constexpr TypeInfo operator()() const {
 #ifdef FRUIT_HAS_TYPEID
-    return TypeInfo(typeid(T), sizeof(T), alignof(T), std::is_trivially_destructible<T>::value);
+    return TypeInfo(typeid(T), sizeof(T), alignof(T), std::is_trivially_destructible<T>::value
+                    FRUIT_TYPE_INFO_FINGERPRINT_ARG(T));
 #else
-    return TypeInfo(sizeof(T), alignof(T), std::is_trivially_destructible<T>::value);
+    return TypeInfo(sizeof(T), alignof(T), std::is_trivially_destructible<T>::value FRUIT_TYPE_INFO_FINGERPRINT_ARG(T));
 #endif
   };
 };
@@ -85,13 +185,17 @@ template <typename Annotation, typename T>
 struct GetTypeInfoForType<fruit::Annotated<Annotation, T>> {
   constexpr TypeInfo operator()() const {
 #ifdef FRUIT_HAS_TYPEID
-    return TypeInfo(typeid(fruit::Annotated<Annotation, T>), sizeof(T), alignof(T), std::is_trivially_destructible<T>::value);
+    return TypeInfo(typeid(fruit::Annotated<Annotation, T>), sizeof(T), alignof(T), std::is_trivially_destructible<T>::value
+                    FRUIT_TYPE_INFO_FINGERPRINT_ARG(fruit::Annotated<Annotation, T>));
 #else
-    return TypeInfo(sizeof(T), alignof(T), std::is_trivially_destructible<T>::value);
+    return TypeInfo(sizeof(T), alignof(T), std::is_trivially_destructible<T>::value
+                    FRUIT_TYPE_INFO_FINGERPRINT_ARG(fruit::Annotated<Annotation, T>));
 #endif
   };
 };
 
+#undef FRUIT_TYPE_INFO_FINGERPRINT_ARG
+
 template <typename T>
 inline TypeId getTypeId() {
   // The `constexpr' ensures compile-time evaluation.
@@ -110,7 +214,7 @@ struct GetTypeIdsForListHelper;
 template <typename... Ts>
 struct GetTypeIdsForListHelper<fruit::impl::meta::Vector<Ts...>> {
   std::vector<TypeId> operator()() {
-    return std::vector<TypeId>{getTypeId<Ts>()...};
+    return std::vector<TypeId>{getTypeId<fruit::impl::meta::UnwrapType<Ts>>()...};
   }
 };
 
@@ -133,7 +237,11 @@ inline std::ostream& operator<<(std::ostream& os, TypeId type) {
 namespace std {
   
 inline std::size_t hash<fruit::impl::TypeId>::operator()(fruit::impl::TypeId type) const {
+#if FRUIT_HASH_TYPE_IDS_BY_FINGERPRINT
+  return static_cast<std::size_t>(type.type_info->fingerprint());
+#else
   return hash<const fruit::impl::TypeInfo*>()(type.type_info);
+#endif
 }
 
 } // namespace std
@@ -18,22 +18,34 @@
 #define FRUIT_TYPE_INFO_H
 
 #include <typeinfo>
+#include <fruit/impl/fruit-config.h>
 #include <fruit/impl/util/demangle_type_name.h>
 #include <fruit/impl/meta/vector.h>
 
 #include <vector>
+#include <cstdint>
 
 namespace fruit {
 namespace impl {
 
-// Similar to std::type_index, but with a constexpr constructor and also storing the type size and alignment.
+// Similar to std::type_index, but with a constexpr constructor and also storing the type size, alignment and (if
+// FRUIT_ENABLE_TYPE_FINGERPRINTS is 1) fingerprint.
 // Also guaranteed to be aligned, to allow storing a TypeInfo and 1 bit together in the size of a void*.
 struct alignas(1) alignas(void*) TypeInfo {
+#if FRUIT_ENABLE_TYPE_FINGERPRINTS
+  // This should only be used if RTTI is disabled. Use the other constructor if possible.
+  constexpr TypeInfo(std::size_t type_size, std::size_t type_alignment, bool is_trivially_destructible,
+                     std::uint64_t type_fingerprint);
+
+  constexpr TypeInfo(const std::type_info& info, std::size_t type_size, std::size_t type_alignment, 
+                     bool is_trivially_destructible, std::uint64_t type_fingerprint);
+#else
   // This should only be used if RTTI is disabled. Use the other constructor if possible.
   constexpr TypeInfo(std::size_t type_size, std::size_t type_alignment, bool is_trivially_destructible);
 
   constexpr TypeInfo(const std::type_info& info, std::size_t type_size, std::size_t type_alignment, 
                      bool is_trivially_destructible);
+#endif
 
   std::string name() const;
 
@@ -43,6 +55,11 @@ struct alignas(1) alignas(void*) TypeInfo {
   
   bool isTriviallyDestructible() const;
   
+  // Returns the fingerprint of the type (see getTypeFingerprint()), or 0 if FRUIT_ENABLE_TYPE_FINGERPRINTS is 0.
+  // Unlike the address of the TypeInfo, this is the same in all processes and shared libraries built with the same
+  // compiler.
+  std::uint64_t fingerprint() const;
+  
 private:
   // The std::type_info struct associated with the type, or nullptr if RTTI is disabled.
   // This is only used for the type name.
@@ -50,9 +67,19 @@ private:
   
   std::size_t type_size;
   std::size_t type_alignment;
+#if FRUIT_ENABLE_TYPE_FINGERPRINTS
+  std::uint64_t type_fingerprint;
+#endif
   bool is_trivially_destructible;
 };
 
+// Returns a 64-bit hash of the name of T, computed at compile time (from __PRETTY_FUNCTION__).
+// Distinct types have distinct fingerprints (except for hash collisions), but with one exception: types with the same
+// name in different translation units (e.g. in anonymous namespaces) have the same fingerprint.
+// If FRUIT_ENABLE_TYPE_FINGERPRINTS is 0, this always returns 0.
+template <typename T>
+constexpr std::uint64_t getTypeFingerprint();
+
 struct TypeId {
   const TypeInfo* type_info;
   
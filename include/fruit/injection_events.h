@@ -0,0 +1,111 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTION_EVENTS_H
+#define FRUIT_INJECTION_EVENTS_H
+
+#include <fruit/impl/fruit-config.h>
+
+// Injection events are only recorded if Fruit was built with FRUIT_ENABLE_INJECTION_EVENTS (e.g. by passing
+// -DFRUIT_ENABLE_INJECTION_EVENTS=ON to CMake). Otherwise, Fruit has no event hooks at all, and nothing in this file is
+// defined.
+#if FRUIT_ENABLE_INJECTION_EVENTS
+
+#include <fruit/impl/util/type_info.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fruit {
+
+/**
+ * Something that happened in an injector, as returned by drainInjectionEvents().
+ */
+struct InjectionEvent {
+  enum class Kind : unsigned char {
+    // An injector is about to construct an object (for a binding or a multibinding).
+    CONSTRUCTION_BEGIN,
+    
+    // An injector has constructed an object. There's no such event if the construction threw an exception.
+    CONSTRUCTION_END,
+    
+    // An injector is about to destroy an object that it constructed. There are no such events for objects with a
+    // trivial destructor.
+    DESTRUCTION,
+    
+    // An injector has constructed all the objects in the multibindings for a type, so the vector returned by
+    // getMultibindings() is now available.
+    MULTIBINDINGS_CONSTRUCTED,
+  };
+  
+  Kind kind;
+  
+  // Identifies the thread that recorded the event. Threads are numbered from 0, in the order of their first event.
+  std::uint32_t thread_index;
+  
+  // When the event happened, in nanoseconds since the epoch of std::chrono::steady_clock.
+  std::uint64_t timestamp_ns;
+  
+  // The type of the object (for multibindings, the type of the multibinding). Not set for DESTRUCTION events; use the
+  // object pointer to match them with the CONSTRUCTION_END events instead.
+  // Use getTypeName() to get this as a string.
+  fruit::impl::TypeId type;
+  
+  // The object constructed (for CONSTRUCTION_END) or destroyed (for DESTRUCTION), nullptr for other events.
+  const void* object;
+  
+  // Returns the name of `type', or the empty string if it's not set.
+  std::string getTypeName() const;
+};
+
+/**
+ * Moves the events recorded so far (by all threads) to the end of `events', and returns the number of events added.
+ * 
+ * Each thread records its events in its own fixed-size ring buffer, with no locking. This is meant to be called
+ * periodically (e.g. from a background thread) to empty those buffers; it can be called while other threads are using
+ * injectors. The events of each thread are in order, but the events of different threads are not interleaved by time;
+ * sort them by timestamp_ns if needed.
+ * 
+ * When a thread records an event and its buffer is full, the event is dropped (see getNumDroppedInjectionEvents()).
+ * 
+ * Example usage:
+ * 
+ * std::vector<fruit::InjectionEvent> events;
+ * while (true) {
+ *   std::this_thread::sleep_for(std::chrono::seconds(1));
+ *   events.clear();
+ *   fruit::drainInjectionEvents(events);
+ *   for (const fruit::InjectionEvent& event : events) {
+ *     exportToMetricsAgent(event);
+ *   }
+ * }
+ */
+std::size_t drainInjectionEvents(std::vector<InjectionEvent>& events);
+
+/**
+ * Returns the number of events dropped so far, because the recording thread's buffer was full or because they were
+ * recorded while the thread was exiting, after its buffer was released (e.g. from the destructor of a thread_local
+ * object).
+ */
+std::uint64_t getNumDroppedInjectionEvents();
+
+} // namespace fruit
+
+#endif // FRUIT_ENABLE_INJECTION_EVENTS
+
+#endif // FRUIT_INJECTION_EVENTS_H
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTION_PROFILE_H
+#define FRUIT_INJECTION_PROFILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fruit {
+
+/**
+ * The time spent by an injector constructing each instance, as returned by Injector::getProfile().
+ * 
+ * Example usage:
+ * 
+ * Injector<Foo> injector(getFooComponent());
+ * injector.enableProfiling();
+ * injector.eagerlyInjectAll();
+ * 
+ * InjectionProfile profile = injector.getProfile();
+ * for (const auto& p : profile.getSlowestTypes(10)) {
+ *   std::cout << p.first << ": " << p.second << " ns" << std::endl;
+ * }
+ * std::ofstream trace_file("injection_trace.json");
+ * profile.writeChromeTrace(trace_file);
+ */
+class InjectionProfile {
+public:
+  struct Entry {
+    // The name of the constructed type. For multibindings, this is the type of the multibinding.
+    std::string type_name;
+
+    // True if the object was constructed for a multibinding, false if it was constructed for a binding.
+    bool is_multibinding;
+
+    // When the construction started, in nanoseconds since profiling was enabled.
+    std::uint64_t start_ns;
+
+    // The duration of the construction, in nanoseconds. This includes the construction of the dependencies that were not
+    // constructed yet.
+    std::uint64_t total_ns;
+
+    // Similar to total_ns, but without the time spent constructing the dependencies (in the same thread).
+    std::uint64_t self_ns;
+
+    // The bytes allocated for this object (excluding its dependencies): the space used in the injector's memory pool
+    // (including alignment padding) or, for objects allocated by a provider, the size of the object.
+    std::size_t allocated_bytes;
+
+    // The thread that constructed the object. Threads are numbered 0, 1, 2, ... in the order in which they first
+    // constructed an object of this injector.
+    std::size_t thread_index;
+  };
+
+  // One entry for each object constructed since profiling was enabled, in the order in which the constructions ended.
+  std::vector<Entry> entries;
+
+  // The chain of dependencies with the greatest total self time among the ones constructed by eagerlyInjectAll(), i.e. a
+  // lower bound for the time needed by eagerlyInjectAll(num_threads) with any number of threads. These are indexes in
+  // `entries', each one a dependency of the next. This is empty if no such object has been constructed yet, and for injectors
+  // that don't use a precomputed construction schedule in eagerlyInjectAll() (child injectors, and injectors that don't
+  // expose all the types exposed by their NormalizedComponent).
+  std::vector<std::size_t> critical_path;
+
+  // The sum of the self_ns of the entries in critical_path.
+  std::uint64_t critical_path_ns = 0;
+
+  /**
+   * Returns the n types with the greatest self time (summed over all the objects of that type), slowest first, as
+   * (type name, self time in nanoseconds) pairs. Returns fewer than n types if fewer types were constructed.
+   */
+  std::vector<std::pair<std::string, std::uint64_t>> getSlowestTypes(std::size_t n) const;
+
+  /**
+   * Writes the entries in the JSON trace event format used by chrome://tracing and Perfetto, so that the profile can be
+   * visualized there as a timeline (one track for each thread).
+   */
+  void writeChromeTrace(std::ostream& os) const;
+};
+
+} // namespace fruit
+
+#endif // FRUIT_INJECTION_PROFILE_H
@@ -23,6 +23,14 @@
 #include <fruit/component.h>
 #include <fruit/provider.h>
 #include <fruit/normalized_component.h>
+#include <fruit/construction_phase_times.h>
+#include <fruit/injection_profile.h>
+#include <fruit/injector_memory_usage.h>
+#include <fruit/impl/injection_awaitable.h>
+
+#include <array>
+#include <future>
+#include <memory>
 
 namespace fruit {
 
@@ -46,6 +54,9 @@ private:
       fruit::impl::meta::RemoveAnnotations(fruit::impl::meta::Type<T>)
       >>;
   
+  template <typename T>
+  using FutureOfRemoveAnnotations = std::future<RemoveAnnotations<T>>;
+  
 public:
   // Moving injectors is allowed.
   Injector(Injector&&) = default;
@@ -110,6 +121,83 @@ public:
   Injector(NormalizedComponent<NormalizedComponentParams...>&& normalized_component, 
            Component<ComponentParams...> component) = delete;
   
+  /**
+   * Creation of a child injector from a parent injector and a component.
+   * 
+   * The Component can have requirements, as long as they are provided by the parent injector. Types bound in the parent
+   * injector are not bound again in the child: when the child needs one of them, it uses the parent's instance (constructing
+   * it in the parent if necessary). So e.g. a singleton in the parent injector is the same object in all its child injectors.
+   * Only the bindings in the Component are processed when constructing the child injector, so this is cheap even when the
+   * parent injector has many bindings.
+   * 
+   * Multibindings of the parent injector are also visible in the child injector, before any multibindings for the same type
+   * added in the Component.
+   * 
+   * The parent injector must remain valid during the lifetime of the child injector. Since child injectors construct the
+   * parent's objects on demand, possibly from multiple threads, enableConcurrentInjection() must be called on the parent
+   * injector before its first child injector is created (otherwise this reports a fatal error). Then child injectors can
+   * be created and used concurrently from multiple threads.
+   * 
+   * Note that a PartialComponent<...> can NOT be used as second argument, so if the component is defined inline it must be
+   * explicitly casted to the desired Component<...> type.
+   * 
+   * Example usage:
+   * 
+   * // At startup (e.g. inside main()).
+   * Injector<Bar> applicationInjector(getApplicationComponent());
+   * applicationInjector.enableConcurrentInjection();
+   * 
+   * ...
+   * for (...) {
+   *   // For each request.
+   *   Request request = ...;
+   *   
+   *   // Here getRequestComponent() returns a Component<Required<Bar>, Foo>.
+   *   Injector<Foo, Bar> injector(applicationInjector, getRequestComponent(request));
+   *   Foo* foo = injector.get<Foo*>();
+   *   ...
+   * }
+   */
+  template <typename... ParentP, typename... ComponentParams>
+  Injector(Injector<ParentP...>& parent, Component<ComponentParams...> component);
+  
+  /**
+   * Creation of an injector from a normalized component and an instance of each of its Required<...> types.
+   * 
+   * This is equivalent to passing a component that only binds these instances (with bindInstance()) to the constructor above,
+   * but it's much faster: no bindings need to be normalized, the instances are just stored in the nodes that the
+   * NormalizedComponent reserved for the required types. This is the recommended way to construct per-request injectors when
+   * the per-request component would only bind instances.
+   * 
+   * The instances must be exactly one for each of the (non-annotated) Required<...> types of the NormalizedComponent. They
+   * must remain valid during the lifetime of the Injector, and so must the NormalizedComponent.
+   * 
+   * Example usage:
+   * 
+   * // At startup (e.g. inside main()).
+   * NormalizedComponent<Required<Request>, Bar, Bar2> normalizedComponent = ...;
+   * 
+   * ...
+   * for (...) {
+   *   // For each request.
+   *   Request request = ...;
+   *   
+   *   Injector<Foo, Bar> injector(normalizedComponent, request);
+   *   Foo* foo = injector.get<Foo*>();
+   *   ...
+   * }
+   */
+  template <typename... NormalizedComponentParams, typename... RequiredTypes>
+  Injector(const NormalizedComponent<NormalizedComponentParams...>& normalized_component, RequiredTypes&... required_instances);
+  
+  /**
+   * Deleted constructor, to ensure that constructing an Injector from a temporary NormalizedComponent doesn't compile.
+   * The NormalizedComponent must remain valid during the lifetime of any Injector object constructed with it.
+   */
+  template <typename... NormalizedComponentParams, typename... RequiredTypes>
+  Injector(NormalizedComponent<NormalizedComponentParams...>&& normalized_component,
+           RequiredTypes&... required_instances) = delete;
+  
   /**
    * Returns an instance of the specified type. For any class C in the Injector's template parameters, the following variations
    * are allowed:
@@ -138,6 +226,42 @@ public:
   template <typename T>
   RemoveAnnotations<T> get();
   
+  /**
+   * Similar to get(), but gets the instance in another thread, so the calling thread can do something else (e.g. get other
+   * instances) in the meantime. The returned future becomes ready once the instance and the instances it depends on are
+   * constructed; if their constructors or providers throw, it stores the exception instead.
+   * 
+   * Independent instances requested with getAsync() are constructed concurrently, so this is useful e.g. when some providers
+   * registered with registerProvider() or registerAsyncProvider() wait for I/O. If multiple threads need the same instance,
+   * it's still constructed only once.
+   * 
+   * The injections are run by threads owned by the injector, up to the number set by enableConcurrentInjection(); when
+   * they're all busy, the injection starts as soon as one of them is free. So providers must not wait for the result of
+   * getAsync(), and providers that wait for each other need enough threads.
+   * 
+   * enableConcurrentInjection() must be called before the first call to this method. The injector can be moved while the
+   * injection is pending, but the injector it's moved to must outlive the computation of the result.
+   */
+  template <typename T>
+  FutureOfRemoveAnnotations<T> getAsync();
+  
+#if FRUIT_HAS_COROUTINES
+  /**
+   * Only available when compiling with coroutine support (e.g. C++20). Returns an awaitable, so that a coroutine can do
+   * `T t = co_await injector.getAsync<T>(scheduler);'.
+   * 
+   * Awaiting it suspends the coroutine and calls scheduler.schedule(task), where task is a callable with no parameters that
+   * gets the instance (constructing it and the instances it depends on, if necessary) and then resumes the coroutine. So the
+   * coroutine resumes in whichever thread the scheduler runs the task in (e.g. one of the threads of a thread pool).
+   * If the injection throws, the exception is re-thrown by co_await.
+   * 
+   * enableConcurrentInjection() must be called before the first call to this method. The injector and the scheduler must
+   * outlive the awaitable.
+   */
+  template <typename T, typename Scheduler>
+  fruit::impl::InjectionAwaitable<Injector<P...>, T, Scheduler> getAsync(Scheduler& scheduler);
+#endif
+  
   /**
    * If C was bound (directly or indirectly) in the component used to create this injector, returns a pointer to the instance of C
    * (constructing it if necessary). Otherwise returns nullptr.
@@ -199,14 +323,137 @@ public:
    * Unreachable bindings (i.e. bindings that are not exposed by this Injector, and that are not used by any reachable binding)
    * are not processed. Bindings that are only used lazily, using a Provider, are NOT eagerly injected.
    * 
+   * The lambdas of the reachable async providers (see PartialComponent::registerAsyncProvider()) are called first, so that
+   * all their async computations are started before waiting for the result of any of them.
+   * 
    * Call this to ensure thread safety if the injector will be shared by multiple threads.
    * After calling this method, get() and getMultibindings() can be called concurrently on the same injector, with no locking.
    * Note that the guarantee only applies after this method returns; specifically, this method can NOT be called concurrently
    * unless it has been called before on the same injector and returned.
+   * 
+   * If constructing all instances upfront is too expensive, consider using enableConcurrentInjection() instead.
    */
   void eagerlyInjectAll();
   
+  /**
+   * Similar to eagerlyInjectAll(), but uses up to num_threads threads (including the calling one) to construct the instances.
+   * Each instance is constructed as soon as all the instances it depends on are, so instances that don't depend on each other
+   * are constructed concurrently, and the time needed is bounded by the longest chain of dependencies (as long as there are
+   * enough threads). Multibindings are still injected by the calling thread, after the other instances.
+   * 
+   * The constructors and providers of the injected types must be safe to call concurrently with each other.
+   * This also enables concurrent injection on this injector (see enableConcurrentInjection()).
+   * If some constructor or provider throws an exception, this waits for the ongoing constructions to finish and then
+   * rethrows it.
+   */
+  void eagerlyInjectAll(std::size_t num_threads);
+  
+  /**
+   * Allows this injector to be shared by multiple threads while still injecting instances lazily.
+   * After calling this method, get(), unsafeGet(), getMultibindings() and the get() method of Providers obtained from this
+   * injector can be called concurrently on the same injector, with no locking.
+   * 
+   * Each instance is still constructed at most once: if multiple threads need an instance that wasn't constructed yet, one
+   * of them constructs it while the others wait. Getting an instance that was already constructed is as fast as in
+   * single-threaded mode.
+   * 
+   * This method must be called before the injector is used by multiple threads, typically right after constructing it.
+   * It can be combined with eagerlyInjectAll(), e.g. to construct the most commonly-used instances upfront.
+   * 
+   * This also allows calling getAsync(). The future-based getAsync() will use up to std::thread::hardware_concurrency()
+   * threads.
+   */
+  void enableConcurrentInjection();
+  
+  /**
+   * Similar to enableConcurrentInjection(), but getAsync() will use up to max_async_threads threads. Use this when the
+   * injections requested with getAsync() mostly wait (e.g. for I/O) instead of using the CPU.
+   * If concurrent injection was already enabled (e.g. by eagerlyInjectAll(num_threads)), this has no effect.
+   */
+  void enableConcurrentInjection(std::size_t max_async_threads);
+  
+  /**
+   * Starts measuring the construction of each instance (and of each multibinding object) by this injector: when it starts and
+   * ends, how much of that time was spent constructing its dependencies, how many bytes were allocated for it and which thread
+   * constructed it. The results can be retrieved with getProfile().
+   * 
+   * Profiling slows down the construction of instances (but not the retrieval of already-constructed ones), so it's meant to
+   * be enabled only when investigating performance, e.g. when the injector construction or eagerlyInjectAll() is slow.
+   * It should be called right after constructing the injector, and before the injector is used by multiple threads (if it
+   * is). Instances constructed by a parent injector or shared through NormalizedComponent::shareComponentScopedInstances()
+   * are not measured.
+   */
+  void enableProfiling();
+  
+  /**
+   * Returns the measurements collected since enableProfiling() was called, that must have been called before.
+   * See InjectionProfile for the contents. This must not be called concurrently with other methods of this injector.
+   */
+  InjectionProfile getProfile();
+  
+  /**
+   * Starts recording the type of each object allocated by this injector, so that getMemoryUsage() can report the memory
+   * used by each type for those objects. This must be called right after constructing the injector, before any object is
+   * constructed. It slows down the construction of instances (each allocation takes a lock), so it's meant to be enabled
+   * only when investigating memory usage, e.g. in a few injectors out of many.
+   */
+  void enableMemoryAccounting();
+  
+  /**
+   * Returns the memory used by this injector so far: its memory pool for the injected objects, the objects allocated
+   * outside of it, its dependency graph and its multibindings, with a breakdown by type. See InjectorMemoryUsage for the
+   * details. The objects' memory is only broken down by type (and the objects allocated outside of the memory pool are
+   * only counted) if enableMemoryAccounting() was called.
+   * This must not be called concurrently with other methods of this injector.
+   */
+  InjectorMemoryUsage getMemoryUsage();
+  
+  /**
+   * Returns how long the construction of this injector took, split by phase. This is always measured, since it's cheap
+   * compared to the construction itself. See ConstructionPhaseTimes for the details.
+   * For injectors constructed from a Component, this includes the normalization of the component (the same work that's
+   * done when constructing a NormalizedComponent); for the other injectors, it only includes the work done on top of the
+   * NormalizedComponent (or parent injector).
+   */
+  ConstructionPhaseTimes getConstructionPhaseTimes() const;
+  
+  /**
+   * Reuses this injector for a new set of instances of the required types, instead of destroying it and constructing a new
+   * one. This can only be used on injectors constructed from a NormalizedComponent and instances of its required types, and
+   * the same NormalizedComponent must be passed here.
+   * 
+   * All the objects constructed by this injector so far are destroyed (as when destroying the injector), so any pointer or
+   * reference obtained from this injector must not be used afterwards. Instances shared through
+   * NormalizedComponent::shareComponentScopedInstances() are not affected.
+   * After this call, the injector behaves as a new one constructed with:
+   * 
+   * Injector<P...> injector(normalized_component, required_instances...);
+   * 
+   * but the memory of this injector is reused, so neither resetting an injector nor using it afterwards allocates memory
+   * (the vectors returned by getMultibindings() are refilled in place).
+   * 
+   * This must not be called concurrently with any other method of this injector.
+   * 
+   * Example usage:
+   * 
+   * Injector<Foo> injector(normalizedComponent, firstRequest);
+   * for (...) {
+   *   // For each request.
+   *   Request request = ...;
+   *   injector.reset(normalizedComponent, request);
+   *   Foo* foo = injector.get<Foo*>();
+   *   ...
+   * }
+   */
+  template <typename... NormalizedComponentParams, typename... RequiredTypes>
+  void reset(const NormalizedComponent<NormalizedComponentParams...>& normalized_component,
+             RequiredTypes&... required_instances);
+  
 private:
+  // Child injectors use the storage of their parent injector.
+  template <typename... OtherP>
+  friend class Injector;
+  
   using Comp = fruit::impl::meta::Eval<fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<P>...)>;
 
   using Check1 = typename fruit::impl::meta::CheckIfError<Comp>::type;
@@ -221,6 +468,10 @@ private:
   static_assert(true || sizeof(Check2), "");
   
   std::unique_ptr<fruit::impl::InjectorStorage> storage;
+  
+  // The nodes of the types in P... (in the same order), looked up once at construction.
+  // get<T>() uses these, so that getting one of the types exposed by this injector doesn't need a hash table lookup.
+  std::array<fruit::impl::InjectorStorage::Graph::node_iterator, sizeof...(P)> exposed_type_nodes;
 };
 
 } // namespace fruit
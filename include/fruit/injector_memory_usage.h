@@ -0,0 +1,122 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTOR_MEMORY_USAGE_H
+#define FRUIT_INJECTOR_MEMORY_USAGE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace fruit {
+
+/**
+ * The memory used by an injector, as returned by Injector::getMemoryUsage().
+ * This only includes the memory owned by the injector itself: the data shared with its NormalizedComponent (or with the
+ * parent injector, for child injectors) and the objects constructed by those are not included. Memory allocated by the
+ * injected objects themselves (e.g. by their std::vector fields) is not included either.
+ * 
+ * Example usage:
+ * 
+ * Injector<Request> injector(normalized_component, getRequestComponent());
+ * injector.enableMemoryAccounting();
+ * injector.get<Request*>();
+ * 
+ * InjectorMemoryUsage usage = injector.getMemoryUsage();
+ * std::cout << "Total: " << usage.getTotalBytes() << " bytes" << std::endl;
+ * for (const InjectorMemoryUsage::TypeEntry& entry : usage.types) {
+ *   std::cout << entry.type_name << ": " << entry.getTotalBytes() << " bytes" << std::endl;
+ * }
+ */
+class InjectorMemoryUsage {
+public:
+  struct TypeEntry {
+    // The name of the type. For multibindings, this is the type of the multibinding.
+    std::string type_name;
+    
+    // The objects of this type constructed in the injector's memory pool. Only counted after enableMemoryAccounting().
+    std::size_t num_pool_objects = 0;
+    
+    // The space reserved in the memory pool for those objects. Each object reserves sizeof(T) + alignof(T) - 1 bytes, so
+    // that it can be aligned wherever it ends up; pool_reserved_bytes - pool_used_bytes is the space wasted by that.
+    std::size_t pool_reserved_bytes = 0;
+    
+    // The space actually used by those objects in the memory pool, including the padding needed to align them.
+    std::size_t pool_used_bytes = 0;
+    
+    // The part of pool_used_bytes that's alignment padding.
+    std::size_t pool_padding_bytes = 0;
+    
+    // The objects of this type allocated outside the memory pool (e.g. returned by a provider as a pointer) and owned by
+    // the injector. Only counted after enableMemoryAccounting().
+    std::size_t num_external_objects = 0;
+    
+    // The total size of those objects (excluding the overhead of the allocator used for them).
+    std::size_t external_bytes = 0;
+    
+    // The space used by this type's node in the injector's dependency graph, and by its outgoing edges (its
+    // dependencies). Nodes shared with the NormalizedComponent or with the parent injector are not included.
+    std::size_t graph_bytes = 0;
+    
+    // For multibindings, the space used to store the multibinding objects and the std::vector returned by
+    // getMultibindings() (if it was requested). This doesn't include the objects themselves.
+    std::size_t multibinding_bytes = 0;
+    
+    // The sum of all the *_bytes fields above, except pool_used_bytes and pool_padding_bytes that are part of
+    // pool_reserved_bytes.
+    std::size_t getTotalBytes() const {
+      return pool_reserved_bytes + external_bytes + graph_bytes + multibinding_bytes;
+    }
+  };
+  
+  // The size of the memory pool, with enough space for all the objects that the injector could construct.
+  std::size_t pool_reserved_bytes = 0;
+  
+  // The part of the memory pool used so far (including alignment padding).
+  std::size_t pool_used_bytes = 0;
+  
+  // The alignment padding in the memory pool. Only counted after enableMemoryAccounting().
+  std::size_t pool_padding_bytes = 0;
+  
+  // The objects allocated outside the memory pool and owned by the injector, and their total size. Only counted after
+  // enableMemoryAccounting().
+  std::size_t num_external_objects = 0;
+  std::size_t external_bytes = 0;
+  
+  // The space used by the dependency graph (nodes, edges and the index to look up nodes by type), excluding the parts
+  // shared with the NormalizedComponent or with the parent injector.
+  std::size_t graph_bytes = 0;
+  
+  // The space used by the table of constructed objects (one pointer for each node of the graph).
+  std::size_t instance_table_bytes = 0;
+  
+  // The sum of the multibinding_bytes of all the types.
+  std::size_t multibinding_bytes = 0;
+  
+  // The memory used for each type, sorted by decreasing getTotalBytes(). Types that use no memory are omitted.
+  // The graph_bytes of the types don't add up to graph_bytes, since that also includes the lookup index and the unused
+  // space in the graph's pages.
+  std::vector<TypeEntry> types;
+  
+  // The sum of the pool_reserved_bytes, external_bytes, graph_bytes, instance_table_bytes and multibinding_bytes fields.
+  std::size_t getTotalBytes() const {
+    return pool_reserved_bytes + external_bytes + graph_bytes + instance_table_bytes + multibinding_bytes;
+  }
+};
+
+} // namespace fruit
+
+#endif // FRUIT_INJECTOR_MEMORY_USAGE_H
@@ -21,6 +21,7 @@
 #include <fruit/impl/injection_errors.h>
 
 #include <fruit/fruit_forward_decls.h>
+#include <fruit/construction_phase_times.h>
 #include <fruit/impl/fruit_internal_forward_decls.h>
 #include <fruit/impl/meta/component.h>
 #include <fruit/impl/storage/normalized_component_storage_holder.h>
@@ -67,6 +68,25 @@ public:
   NormalizedComponent& operator=(NormalizedComponent&&) = delete;
   NormalizedComponent& operator=(const NormalizedComponent&) = delete;
   
+  /**
+   * After this call, the injectors constructed from this NormalizedComponent share the instances of component-scoped types,
+   * instead of each injector constructing its own.
+   * A type is component-scoped if it's bound in this NormalizedComponent and it doesn't depend (directly or indirectly) on
+   * any type in the Required<...> types of this NormalizedComponent, so it can't depend on the Component passed to the
+   * Injector constructor.
+   * 
+   * Each component-scoped instance is constructed at most once (when an injector first needs it), and it's destroyed when
+   * this NormalizedComponent is destroyed. Injectors in different threads can use the shared instances concurrently.
+   * 
+   * This must be called before constructing any Injector from this NormalizedComponent.
+   */
+  void shareComponentScopedInstances();
+  
+  /**
+   * Returns how long the construction of this NormalizedComponent took, split by phase. See ConstructionPhaseTimes.
+   */
+  ConstructionPhaseTimes getConstructionPhaseTimes() const;
+  
 private:  
   // This is held via a unique_ptr to avoid including normalized_component_storage.h
   // in fruit.h.
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/async_executor.h>
+
+#include <system_error>
+#include <utility>
+
+namespace fruit {
+namespace impl {
+
+AsyncExecutor::AsyncExecutor(std::size_t max_threads)
+  : max_threads(max_threads) {
+}
+
+AsyncExecutor::~AsyncExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  cond.notify_all();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void AsyncExecutor::schedule(std::function<void()> task) {
+  std::unique_lock<std::mutex> lock(mutex);
+  tasks.push_back(std::move(task));
+  if (num_idle_threads >= tasks.size() || threads.size() >= max_threads) {
+    // An existing thread will run it.
+    lock.unlock();
+    cond.notify_one();
+    return;
+  }
+  try {
+    threads.emplace_back(&AsyncExecutor::runTasks, this);
+  } catch (const std::system_error&) {
+    // No more threads can be created now, the task will be run by an existing one.
+    if (threads.empty()) {
+      // There's no other thread that could run it.
+      std::function<void()> queued_task = std::move(tasks.back());
+      tasks.pop_back();
+      lock.unlock();
+      queued_task();
+    }
+  }
+}
+
+void AsyncExecutor::runTasks() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    ++num_idle_threads;
+    cond.wait(lock, [this]() {
+      return !tasks.empty() || stopping;
+    });
+    --num_idle_threads;
+    if (tasks.empty()) {
+      // The executor is being destroyed and there are no tasks left.
+      return;
+    }
+    std::function<void()> task = std::move(tasks.front());
+    tasks.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+} // namespace impl
+} // namespace fruit
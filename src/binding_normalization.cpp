@@ -17,11 +17,14 @@
 #define IN_FRUIT_CPP_FILE
 
 #include <cstdlib>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <iostream>
 #include <algorithm>
 #include <fruit/impl/util/type_info.h>
+#include <fruit/impl/util/radix_sort.h>
+#include <fruit/impl/construction_phase_timer.h>
 
 #include <fruit/impl/storage/injector_storage.h>
 #include <fruit/impl/storage/component_storage.h>
@@ -48,6 +51,46 @@ auto typeInfoLessThanForMultibindings = [](const std::pair<TypeId, MultibindingD
   return x.first < y.first;
 };
 
+// The key used to sort bindings by TypeId with radixSort().
+std::size_t sortKey(TypeId type) {
+  return reinterpret_cast<std::uintptr_t>(type.type_info);
+}
+
+std::size_t sortKeyForBinding(const std::pair<TypeId, BindingData>& binding) {
+  return sortKey(binding.first);
+}
+
+std::size_t sortKeyForCompressedBinding(const CompressedBinding& compressed_binding) {
+  return sortKey(compressed_binding.class_id);
+}
+
+// Returns the binding for `type' in `bindings' (sorted by sortKey()), or bindings.end() if there's none.
+std::vector<std::pair<TypeId, BindingData>>::iterator findBinding(std::vector<std::pair<TypeId, BindingData>>& bindings,
+                                                                  TypeId type) {
+  auto itr = std::lower_bound(bindings.begin(), bindings.end(), type,
+                              [](const std::pair<TypeId, BindingData>& x, TypeId y) {
+                                return sortKey(x.first) < sortKey(y);
+                              });
+  if (itr == bindings.end() || !(itr->first == type)) {
+    return bindings.end();
+  }
+  return itr;
+}
+
+// Returns the compressed binding with class_id==type in `compressed_bindings' (sorted by the sortKey() of class_id), or
+// compressed_bindings.end() if there's none.
+std::vector<CompressedBinding>::const_iterator findCompressedBinding(
+    const std::vector<CompressedBinding>& compressed_bindings, TypeId type) {
+  auto itr = std::lower_bound(compressed_bindings.begin(), compressed_bindings.end(), type,
+                              [](const CompressedBinding& x, TypeId y) {
+                                return sortKey(x.class_id) < sortKey(y);
+                              });
+  if (itr == compressed_bindings.end() || !(itr->class_id == type)) {
+    return compressed_bindings.end();
+  }
+  return itr;
+}
+
 } // namespace
 
 namespace fruit {
@@ -60,23 +103,27 @@ BindingNormalization::normalizeBindings(const std::vector<std::pair<TypeId, Bind
                                         const std::vector<std::pair<TypeId, MultibindingData>>& multibindings_vector,
                                         const std::vector<TypeId>& exposed_types,
                                         BindingNormalization::BindingCompressionInfoMap& bindingCompressionInfoMap) {
-  HashMap<TypeId, BindingData> binding_data_map = 
-      createHashMap<TypeId, BindingData>(bindings_vector.size(), TypeId{nullptr}, getInvalidTypeId());
-  
-  for (auto& p : bindings_vector) {
-    auto itr = binding_data_map.find(p.first);
-    if (itr != binding_data_map.end()) {
-      if (!(p.second == itr->second)) {
-        std::cerr << multipleBindingsError(p.first) << std::endl;
-        exit(1);
-      }
-      // Otherwise ok, duplicate but consistent binding.
-      
-    } else {
-      // New binding, add it to the map.
-      binding_data_map[p.first] = p.second;
-    }
-  }
+  ConstructionPhaseTimer::Phase duplicate_detection_phase(&ConstructionPhaseTimes::duplicate_detection_ns);
+  
+  // The bindings are kept in flat vectors sorted by TypeId (and looked up with a binary search) instead of in hash tables,
+  // so that there's no allocation per binding.
+  std::vector<std::pair<TypeId, BindingData>> normalized_bindings = bindings_vector;
+  radixSort(normalized_bindings, sortKeyForBinding);
+  
+  auto normalized_bindings_end = std::unique(normalized_bindings.begin(), normalized_bindings.end(),
+                                             [](const std::pair<TypeId, BindingData>& x,
+                                                const std::pair<TypeId, BindingData>& y) {
+                                               if (!(x.first == y.first)) {
+                                                 return false;
+                                               }
+                                               if (!(x.second == y.second)) {
+                                                 std::cerr << multipleBindingsError(x.first) << std::endl;
+                                                 exit(1);
+                                               }
+                                               // Duplicate but consistent binding.
+                                               return true;
+                                             });
+  normalized_bindings.erase(normalized_bindings_end, normalized_bindings.end());
   
   for (const auto& p : bindings_vector) {
     if (p.second.needsAllocation()) {
@@ -86,86 +133,96 @@ BindingNormalization::normalizeBindings(const std::vector<std::pair<TypeId, Bind
     }
   }
   
-  // Remove duplicates from `compressedBindingsVector'.
+  duplicate_detection_phase.end();
   
-  // CtypeId -> (ItypeId, bindingData)
-  HashMap<TypeId, std::pair<TypeId, BindingData>> compressed_bindings_map =
-      createHashMap<TypeId, std::pair<TypeId, BindingData>>(
-          compressed_bindings_vector.size(), TypeId{nullptr}, getInvalidTypeId());
+  ConstructionPhaseTimer::Phase binding_compression_phase(&ConstructionPhaseTimes::binding_compression_ns);
   
-  // This also removes any duplicates. No need to check for multiple I->C, I2->C mappings, will filter these out later when 
-  // considering deps.
-  for (CompressedBinding& compressed_binding : compressed_bindings_vector) {
-    compressed_bindings_map[compressed_binding.class_id] = {compressed_binding.interface_id, compressed_binding.binding_data};
-  }
+  // Remove duplicates from `compressedBindingsVector'.
+  // No need to check for multiple I->C, I2->C mappings, will filter these out later when considering deps.
+  radixSort(compressed_bindings_vector, sortKeyForCompressedBinding);
+  compressed_bindings_vector.erase(std::unique(compressed_bindings_vector.begin(), compressed_bindings_vector.end(),
+                                               [](const CompressedBinding& x, const CompressedBinding& y) {
+                                                 return x.class_id == y.class_id;
+                                               }),
+                                   compressed_bindings_vector.end());
+  
+  // The C types of the bindings in compressed_bindings_vector that can't be compressed.
+  std::vector<TypeId> not_compressible_types;
   
   // We can't compress the binding if C is a dep of a multibinding.
   for (auto p : multibindings_vector) {
     const BindingDeps* deps = p.second.deps;
     if (deps != nullptr) {
-      for (std::size_t i = 0; i < deps->num_deps; ++i) {
-        compressed_bindings_map.erase(deps->deps[i]);
-      }
+      not_compressible_types.insert(not_compressible_types.end(), deps->deps, deps->deps + deps->num_deps);
     }
   }
   
   // We can't compress the binding if C is an exposed type (but I is likely to be exposed instead).
-  for (TypeId type : exposed_types) {
-    compressed_bindings_map.erase(type);
-  }
+  not_compressible_types.insert(not_compressible_types.end(), exposed_types.begin(), exposed_types.end());
   
   // We can't compress the binding if some type X depends on C and X!=I.
-  for (auto& p : binding_data_map) {
+  for (auto& p : normalized_bindings) {
     TypeId x_id = p.first;
     BindingData binding_data = p.second;
     if (!binding_data.isCreated()) {
       for (std::size_t i = 0; i < binding_data.getDeps()->num_deps; ++i) {
         TypeId c_id = binding_data.getDeps()->deps[i];
-        auto itr = compressed_bindings_map.find(c_id);
-        if (itr != compressed_bindings_map.end() && itr->second.first != x_id) {
-          compressed_bindings_map.erase(itr);
+        auto itr = findCompressedBinding(compressed_bindings_vector, c_id);
+        if (itr != compressed_bindings_vector.end() && !(itr->interface_id == x_id)) {
+          not_compressible_types.push_back(c_id);
         }
       }
     }
   }
   
+  std::sort(not_compressible_types.begin(), not_compressible_types.end());
+  compressed_bindings_vector.erase(std::remove_if(compressed_bindings_vector.begin(), compressed_bindings_vector.end(),
+                                                  [&not_compressible_types](const CompressedBinding& compressed_binding) {
+                                                    return std::binary_search(not_compressible_types.begin(),
+                                                                              not_compressible_types.end(),
+                                                                              compressed_binding.class_id);
+                                                  }),
+                                   compressed_bindings_vector.end());
+  
   // Two pairs of compressible bindings (I->C) and (C->X) can not exist (the C of a compressible binding is always bound either
   // using constructor binding or provider binding, it can't be a binding itself). So no need to check for that.
   
   bindingCompressionInfoMap = 
-      createHashMap<TypeId, BindingNormalization::BindingCompressionInfo>(compressed_bindings_map.size(), TypeId{nullptr}, getInvalidTypeId());
-  
-  // Now perform the binding compression.
-  for (auto& p : compressed_bindings_map) {
-    TypeId c_id = p.first;
-    TypeId i_id = p.second.first;
-    BindingData binding_data = p.second.second;
-    auto i_binding_data = binding_data_map.find(i_id);
-    auto c_binding_data = binding_data_map.find(c_id);
-    FruitAssert(i_binding_data != binding_data_map.end());
-    FruitAssert(c_binding_data != binding_data_map.end());
+      createHashMap<TypeId, BindingNormalization::BindingCompressionInfo>(compressed_bindings_vector.size(), TypeId{nullptr}, getInvalidTypeId());
+  
+  // Now perform the binding compression. The bindings for the C types are removed afterwards, so that the iterators
+  // returned by findBinding() stay valid in this loop.
+  for (const CompressedBinding& compressed_binding : compressed_bindings_vector) {
+    TypeId c_id = compressed_binding.class_id;
+    TypeId i_id = compressed_binding.interface_id;
+    auto i_binding_data = findBinding(normalized_bindings, i_id);
+    auto c_binding_data = findBinding(normalized_bindings, c_id);
+    FruitAssert(i_binding_data != normalized_bindings.end());
+    FruitAssert(c_binding_data != normalized_bindings.end());
     bindingCompressionInfoMap[c_id] = BindingCompressionInfo{i_id, i_binding_data->second, c_binding_data->second};
     // Note that even if I is the one that remains, C is the one that will be allocated, not I.
     FruitAssert(!i_binding_data->second.needsAllocation());
-    i_binding_data->second = binding_data;
-    binding_data_map.erase(c_binding_data);
+    i_binding_data->second = compressed_binding.binding_data;
 #ifdef FRUIT_EXTRA_DEBUG
     std::cout << "InjectorStorage: performing binding compression for the edge " << i_id << "->" << c_id << std::endl;
 #endif
   }
-
-  // Copy the normalized bindings into the result vector.
-  std::vector<std::pair<TypeId, BindingData>> result;
-  result.reserve(binding_data_map.size());
-  for (auto& p : binding_data_map) {
-    result.push_back(p);
-  }
-  return result;
+  normalized_bindings.erase(std::remove_if(normalized_bindings.begin(), normalized_bindings.end(),
+                                           [&compressed_bindings_vector](const std::pair<TypeId, BindingData>& p) {
+                                             return findCompressedBinding(compressed_bindings_vector, p.first)
+                                                 != compressed_bindings_vector.end();
+                                           }),
+                            normalized_bindings.end());
+  
+  binding_compression_phase.end();
+  
+  return normalized_bindings;
 }
 
 void BindingNormalization::addMultibindings(std::unordered_map<TypeId, NormalizedMultibindingData>& multibindings,
                                             FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
                                             const std::vector<std::pair<TypeId, MultibindingData>>& multibindingsVector) {
+  ConstructionPhaseTimer::Phase phase(&ConstructionPhaseTimes::multibindings_ns);
 
   std::vector<std::pair<TypeId, MultibindingData>> sortedMultibindingsVector = multibindingsVector;
   std::sort(sortedMultibindingsVector.begin(), sortedMultibindingsVector.end(),
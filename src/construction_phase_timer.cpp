@@ -0,0 +1,84 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/construction_phase_timer.h>
+
+namespace fruit {
+
+namespace {
+
+std::uint64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+std::ostream& operator<<(std::ostream& os, const ConstructionPhaseTimes& times) {
+  return os << "total: " << times.total_ns << " ns"
+            << ", duplicate detection: " << times.duplicate_detection_ns << " ns"
+            << ", binding compression: " << times.binding_compression_ns << " ns"
+            << ", multibindings: " << times.multibindings_ns << " ns"
+            << ", graph construction: " << times.graph_construction_ns << " ns"
+            << " (hash selection: " << times.hash_selection_ns << " ns"
+            << " for " << times.num_hash_selections << " hash tables"
+            << ", " << times.num_rejected_hash_functions << " rejected hash functions)"
+            << ", new bindings: " << times.num_new_bindings;
+}
+
+namespace impl {
+
+thread_local ConstructionPhaseTimer* ConstructionPhaseTimer::current = nullptr;
+
+ConstructionPhaseTimer::Phase::Phase(std::uint64_t ConstructionPhaseTimes::* field)
+  : ns(current != nullptr ? &(current->times.*field) : nullptr) {
+  if (ns != nullptr) {
+    start = std::chrono::steady_clock::now();
+  }
+}
+
+ConstructionPhaseTimer::Phase::~Phase() {
+  end();
+}
+
+void ConstructionPhaseTimer::Phase::end() {
+  if (ns != nullptr) {
+    *ns += elapsedNs(start);
+    ns = nullptr;
+  }
+}
+
+ConstructionPhaseTimer::ConstructionPhaseTimer(ConstructionPhaseTimes& times)
+  : times(times), parent(current), start(std::chrono::steady_clock::now()) {
+  times = ConstructionPhaseTimes();
+  current = this;
+}
+
+ConstructionPhaseTimer::~ConstructionPhaseTimer() {
+  times.total_ns = elapsedNs(start);
+  current = parent;
+}
+
+void ConstructionPhaseTimer::recordHashSelection(std::size_t num_rejected) {
+  if (current != nullptr) {
+    ++current->times.num_hash_selections;
+    current->times.num_rejected_hash_functions += num_rejected;
+  }
+}
+
+} // namespace impl
+} // namespace fruit
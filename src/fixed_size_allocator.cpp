@@ -18,20 +18,141 @@
 
 #include <fruit/impl/data_structures/fixed_size_allocator.h>
 #include <fruit/impl/data_structures/fixed_size_vector.templates.h>
+#include <fruit/impl/injection_event_log.h>
+#include <fruit/impl/injection_profiler.h>
+
+#include <mutex>
+#include <unordered_map>
 
 using namespace fruit::impl;
 
 namespace fruit {
 namespace impl {
 
+class FixedSizeAllocator::Accounting {
+public:
+  // Guards `stats', since allocations can be concurrent (see enableConcurrentAllocations()).
+  std::mutex mutex;
+  
+  std::unordered_map<TypeId, TypeStats> stats;
+};
+
+FixedSizeAllocator::FixedSizeAllocator() = default;
+
+FixedSizeAllocator::FixedSizeAllocator(FixedSizeAllocatorData allocator_data)
+  : on_destruction(allocator_data.num_types_to_destroy) {
+  // The +1 is because we waste the first byte (storage_last_used points to the beginning of storage).
+  storage_begin = new char[allocator_data.total_size + 1];
+  storage_size = allocator_data.total_size;
+  storage_last_used = storage_begin;
+#ifdef FRUIT_EXTRA_DEBUG
+  remaining_types = allocator_data.types;
+  all_types = allocator_data.types;
+  std::cerr << "Constructing allocator for types:";
+  for (auto x : remaining_types) {
+    std::cerr << " " << x.first;
+  }
+  std::cerr << std::endl;
+#endif
+}
+
+FixedSizeAllocator::FixedSizeAllocator(FixedSizeAllocator&& x)
+  : FixedSizeAllocator() {
+  std::swap(storage_begin, x.storage_begin);
+  std::swap(storage_last_used, x.storage_last_used);
+  std::swap(storage_size, x.storage_size);
+  std::swap(concurrent, x.concurrent);
+  std::swap(profiling, x.profiling);
+  std::swap(accounting, x.accounting);
+  std::swap(on_destruction, x.on_destruction);
+#ifdef FRUIT_EXTRA_DEBUG
+  std::swap(remaining_types, x.remaining_types);
+  std::swap(all_types, x.all_types);
+#endif
+}
+
+FixedSizeAllocator& FixedSizeAllocator::operator=(FixedSizeAllocator&& x) {
+  std::swap(storage_begin, x.storage_begin);
+  std::swap(storage_last_used, x.storage_last_used);
+  std::swap(storage_size, x.storage_size);
+  std::swap(concurrent, x.concurrent);
+  std::swap(profiling, x.profiling);
+  std::swap(accounting, x.accounting);
+  std::swap(on_destruction, x.on_destruction);
+#ifdef FRUIT_EXTRA_DEBUG
+  std::swap(remaining_types, x.remaining_types);
+  std::swap(all_types, x.all_types);
+#endif
+  return *this;
+}
+
 FixedSizeAllocator::~FixedSizeAllocator() {
+  destroyObjects();
+  delete [] storage_begin;
+}
+
+void FixedSizeAllocator::destroyObjects() {
   // Destroy all objects in reverse order.
   std::pair<destroy_t, void*>* p = on_destruction.end();
   while (p != on_destruction.begin()) {
     --p;
+#if FRUIT_ENABLE_INJECTION_EVENTS
+    recordInjectionEvent(InjectionEvent::Kind::DESTRUCTION, TypeId{nullptr}, p->second);
+#endif
     p->first(p->second);
   }
-  delete [] storage_begin;
+}
+
+void FixedSizeAllocator::clear() {
+  destroyObjects();
+  on_destruction.clear();
+  storage_last_used = storage_begin;
+  if (accounting != nullptr) {
+    accounting->stats.clear();
+  }
+#ifdef FRUIT_EXTRA_DEBUG
+  remaining_types = all_types;
+#endif
+}
+
+void FixedSizeAllocator::recordAllocation(TypeId type, std::size_t used_bytes, std::size_t object_size) {
+  if (profiling) {
+    InjectionProfiler::recordAllocation(used_bytes);
+  }
+  if (accounting != nullptr) {
+    std::lock_guard<std::mutex> lock(accounting->mutex);
+    TypeStats& stats = accounting->stats[type];
+    stats.num_objects++;
+    stats.reserved_bytes += FixedSizeAllocatorData::maximumRequiredSpace(type);
+    stats.used_bytes += used_bytes;
+    stats.padding_bytes += used_bytes - object_size;
+  }
+}
+
+void FixedSizeAllocator::recordExternallyAllocatedObject(TypeId type, std::size_t object_size) {
+  if (profiling) {
+    InjectionProfiler::recordAllocation(object_size);
+  }
+  if (accounting != nullptr) {
+    std::lock_guard<std::mutex> lock(accounting->mutex);
+    TypeStats& stats = accounting->stats[type];
+    stats.num_external_objects++;
+    stats.external_bytes += object_size;
+  }
+}
+
+void FixedSizeAllocator::enableAccounting() {
+  if (accounting == nullptr) {
+    accounting.reset(new Accounting());
+  }
+}
+
+std::vector<std::pair<TypeId, FixedSizeAllocator::TypeStats>> FixedSizeAllocator::getTypeStats() const {
+  if (accounting == nullptr) {
+    return {};
+  }
+  std::lock_guard<std::mutex> lock(accounting->mutex);
+  return std::vector<std::pair<TypeId, TypeStats>>(accounting->stats.begin(), accounting->stats.end());
 }
 
 
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/injection_event_log.h>
+
+#if FRUIT_ENABLE_INJECTION_EVENTS
+
+#include <fruit/impl/data_structures/ring_buffer.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace fruit {
+
+namespace {
+
+// The number of events that each thread can record before they're drained. Each event takes 40 bytes (on 64-bit
+// platforms), so this is 160KB per thread.
+constexpr std::size_t EVENTS_PER_THREAD = 4096;
+
+struct ThreadEvents {
+  fruit::impl::RingBuffer<InjectionEvent> events;
+  
+  std::uint32_t thread_index;
+  
+  // Only modified by the recording thread.
+  std::atomic<std::uint64_t> num_dropped_events;
+  
+  // Set by the recording thread when it exits. After that, the buffer is deleted as soon as it's drained.
+  std::atomic<bool> thread_exited;
+  
+  explicit ThreadEvents(std::uint32_t thread_index)
+    : events(EVENTS_PER_THREAD), thread_index(thread_index), num_dropped_events(0), thread_exited(false) {
+  }
+};
+
+// The buffers of all threads that recorded events.
+struct ThreadEventsRegistry {
+  // Guards the fields below. This is never locked while recording an event, only when a thread records its first event,
+  // when it exits and while draining.
+  std::mutex mutex;
+  
+  std::vector<std::unique_ptr<ThreadEvents>> thread_events;
+  
+  std::uint32_t next_thread_index = 0;
+  
+  // The events dropped by the threads whose buffers were deleted, and the ones recorded after their thread exited.
+  std::uint64_t num_dropped_events_of_exited_threads = 0;
+};
+
+ThreadEventsRegistry& getRegistry() {
+  // This is never deleted, so that events can be recorded even while destroying static objects (e.g. a static Injector).
+  static ThreadEventsRegistry* registry = new ThreadEventsRegistry();
+  return *registry;
+}
+
+// The buffer of the current thread (if it recorded any event already).
+// This is a raw pointer (with no destructor), so that it can still be used after ThreadEventsOwner's destructor.
+thread_local ThreadEvents* current_thread_events = nullptr;
+
+// Set when ThreadEventsOwner's destructor runs. Like current_thread_events, this has no destructor.
+thread_local bool current_thread_exited = false;
+
+// Marks the current thread's buffer as exited, when the thread exits.
+struct ThreadEventsOwner {
+  ~ThreadEventsOwner() {
+    current_thread_exited = true;
+    if (current_thread_events != nullptr) {
+      current_thread_events->thread_exited.store(true, std::memory_order_release);
+      // The buffer can be deleted by the next drain, so this thread can't use it anymore. Other events that it records
+      // (e.g. from the destructor of another thread_local object) are dropped, see recordInjectionEvent().
+      current_thread_events = nullptr;
+    }
+  }
+};
+
+ThreadEvents* registerCurrentThread() {
+  ThreadEventsRegistry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.thread_events.emplace_back(new ThreadEvents(registry.next_thread_index++));
+  current_thread_events = registry.thread_events.back().get();
+  // Constructed here (once per thread), and destroyed when the thread exits.
+  static thread_local ThreadEventsOwner thread_events_owner;
+  (void) thread_events_owner;
+  return current_thread_events;
+}
+
+void recordDroppedEventOfExitedThread() {
+  ThreadEventsRegistry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  ++registry.num_dropped_events_of_exited_threads;
+}
+
+} // namespace
+
+std::string InjectionEvent::getTypeName() const {
+  if (type.type_info == nullptr) {
+    return "";
+  }
+  return std::string(type);
+}
+
+std::size_t drainInjectionEvents(std::vector<InjectionEvent>& events) {
+  ThreadEventsRegistry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::size_t num_events = 0;
+  auto itr = registry.thread_events.begin();
+  while (itr != registry.thread_events.end()) {
+    ThreadEvents& thread_events = **itr;
+    // This must be checked before draining: if the thread has exited, it won't record any more events.
+    bool thread_exited = thread_events.thread_exited.load(std::memory_order_acquire);
+    std::uint32_t thread_index = thread_events.thread_index;
+    num_events += thread_events.events.popAll([&events, thread_index](InjectionEvent event) {
+      event.thread_index = thread_index;
+      events.push_back(event);
+    });
+    if (thread_exited) {
+      registry.num_dropped_events_of_exited_threads += thread_events.num_dropped_events.load(std::memory_order_relaxed);
+      itr = registry.thread_events.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
+  return num_events;
+}
+
+std::uint64_t getNumDroppedInjectionEvents() {
+  ThreadEventsRegistry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::uint64_t result = registry.num_dropped_events_of_exited_threads;
+  for (const std::unique_ptr<ThreadEvents>& thread_events : registry.thread_events) {
+    result += thread_events->num_dropped_events.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+namespace impl {
+
+void recordInjectionEvent(InjectionEvent::Kind kind, TypeId type, const void* object) {
+  ThreadEvents* thread_events = current_thread_events;
+  if (thread_events == nullptr) {
+    if (current_thread_exited) {
+      // Registering a new buffer here would leak it: ThreadEventsOwner already ran, so the buffer would never be marked
+      // as exited. This only happens during thread exit, so locking the registry is fine.
+      recordDroppedEventOfExitedThread();
+      return;
+    }
+    thread_events = registerCurrentThread();
+  }
+  InjectionEvent event;
+  event.kind = kind;
+  event.thread_index = 0;
+  event.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  event.type = type;
+  event.object = object;
+  if (!thread_events->events.tryPush(event)) {
+    // Only this thread modifies the counter, so there's no need for an atomic increment.
+    thread_events->num_dropped_events.store(thread_events->num_dropped_events.load(std::memory_order_relaxed) + 1,
+                                            std::memory_order_relaxed);
+  }
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_ENABLE_INJECTION_EVENTS
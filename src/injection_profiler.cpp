@@ -0,0 +1,169 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/injection_profiler.h>
+#include <fruit/injection_profile.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+
+namespace fruit {
+
+namespace {
+
+// Writes `s' as a JSON string literal.
+void writeJsonString(std::ostream& os, const std::string& s) {
+  os << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buffer[8];
+      std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+      os << buffer;
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+}
+
+// Writes a duration in nanoseconds as (fractional) microseconds, the unit used in Chrome traces.
+void writeMicroseconds(std::ostream& os, std::uint64_t ns) {
+  os << ns / 1000 << '.';
+  char buffer[4];
+  std::snprintf(buffer, sizeof(buffer), "%03u", static_cast<unsigned>(ns % 1000));
+  os << buffer;
+}
+
+} // namespace
+
+std::vector<std::pair<std::string, std::uint64_t>> InjectionProfile::getSlowestTypes(std::size_t n) const {
+  std::unordered_map<std::string, std::uint64_t> self_ns_by_type;
+  for (const Entry& entry : entries) {
+    self_ns_by_type[entry.type_name] += entry.self_ns;
+  }
+  std::vector<std::pair<std::string, std::uint64_t>> result(self_ns_by_type.begin(), self_ns_by_type.end());
+  // Ties are broken by name, so that the result doesn't depend on the hash table's order.
+  auto slower = [](const std::pair<std::string, std::uint64_t>& x, const std::pair<std::string, std::uint64_t>& y) {
+    return x.second > y.second || (x.second == y.second && x.first < y.first);
+  };
+  if (n < result.size()) {
+    std::partial_sort(result.begin(), result.begin() + n, result.end(), slower);
+    result.resize(n);
+  } else {
+    std::sort(result.begin(), result.end(), slower);
+  }
+  return result;
+}
+
+void InjectionProfile::writeChromeTrace(std::ostream& os) const {
+  os << "{\"traceEvents\":[";
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    const Entry& entry = entries[i];
+    if (i != 0) {
+      os << ',';
+    }
+    os << "\n{\"name\":";
+    writeJsonString(os, entry.type_name);
+    os << ",\"cat\":\"" << (entry.is_multibinding ? "multibinding" : "binding") << "\""
+       << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << entry.thread_index
+       << ",\"ts\":";
+    writeMicroseconds(os, entry.start_ns);
+    os << ",\"dur\":";
+    writeMicroseconds(os, entry.total_ns);
+    os << ",\"args\":{\"self_us\":";
+    writeMicroseconds(os, entry.self_ns);
+    os << ",\"allocated_bytes\":" << entry.allocated_bytes
+       << ",\"on_critical_path\":"
+       << (std::find(critical_path.begin(), critical_path.end(), i) != critical_path.end() ? "true" : "false")
+       << "}}";
+  }
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+namespace impl {
+
+constexpr std::size_t InjectionProfiler::NO_NODE;
+
+thread_local InjectionProfiler::Scope* InjectionProfiler::Scope::current = nullptr;
+
+InjectionProfiler::Scope::Scope(InjectionProfiler& profiler)
+  : profiler(profiler), parent(current), start(std::chrono::steady_clock::now()) {
+  current = this;
+}
+
+InjectionProfiler::Scope::~Scope() {
+  current = parent;
+  if (!ended && parent != nullptr) {
+    // The construction failed, but the time was still spent in a nested construction.
+    parent->nested_ns += elapsedNs();
+  }
+}
+
+std::uint64_t InjectionProfiler::Scope::elapsedNs() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void InjectionProfiler::Scope::end(TypeId type, std::size_t node_index) {
+  std::uint64_t total_ns = elapsedNs();
+  ended = true;
+  if (parent != nullptr) {
+    parent->nested_ns += total_ns;
+  }
+  Record record;
+  record.type = type;
+  record.node_index = node_index;
+  record.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - profiler.profiling_start).count();
+  record.total_ns = total_ns;
+  // nested_ns can exceed total_ns by a few ns, since the clock is read separately.
+  record.self_ns = total_ns > nested_ns ? total_ns - nested_ns : 0;
+  record.allocated_bytes = allocated_bytes;
+  record.thread_index = 0;
+  profiler.addRecord(record);
+}
+
+InjectionProfiler::InjectionProfiler()
+  : profiling_start(std::chrono::steady_clock::now()) {
+}
+
+void InjectionProfiler::recordAllocation(std::size_t bytes) {
+  if (Scope::current != nullptr) {
+    Scope::current->allocated_bytes += bytes;
+  }
+}
+
+std::vector<InjectionProfiler::Record> InjectionProfiler::getRecords() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return records;
+}
+
+void InjectionProfiler::addRecord(Record record) {
+  std::thread::id thread_id = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lock(mutex);
+  // There are very few threads, so a linear search is fast enough.
+  record.thread_index = std::find(thread_ids.begin(), thread_ids.end(), thread_id) - thread_ids.begin();
+  if (record.thread_index == thread_ids.size()) {
+    thread_ids.push_back(thread_id);
+  }
+  records.push_back(record);
+}
+
+} // namespace impl
+} // namespace fruit
@@ -21,7 +21,17 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <system_error>
 #include <fruit/impl/util/type_info.h>
+#include <fruit/impl/util/atomic_ops.h>
+#include <fruit/impl/construction_phase_timer.h>
+#include <fruit/impl/injection_event_log.h>
+#include <fruit/impl/injection_profiler.h>
+#include <fruit/impl/async_executor.h>
 
 #include <fruit/impl/storage/injector_storage.h>
 #include <fruit/impl/storage/component_storage.h>
@@ -43,6 +53,11 @@ std::string multipleBindingsError(TypeId type) {
         + "If the source of the problem is unclear, try exposing this type in all the component signatures where it's bound; if no component hides it this can't happen.\n";
 }
 
+// Values of NormalizedMultibindingData::concurrent_construction_state.
+const int MULTIBINDINGS_NOT_CONSTRUCTED = 0;
+const int MULTIBINDINGS_IN_PROGRESS = 1;
+const int MULTIBINDINGS_CONSTRUCTED = 2;
+
 } // namespace
 
 namespace fruit {
@@ -75,24 +90,205 @@ namespace {
 }
 
 InjectorStorage::InjectorStorage(const ComponentStorage& component, const std::vector<TypeId>& exposed_types)
-  : normalized_component_storage_ptr(new NormalizedComponentStorage(component, exposed_types)),
+  : normalized_component_storage_ptr(new NormalizedComponentStorage(component, exposed_types, std::vector<TypeId>{})),
     allocator(normalized_component_storage_ptr->fixed_size_allocator_data),
     bindings(normalized_component_storage_ptr->bindings, (DummyNode<TypeId, NormalizedBindingData>*)nullptr, (DummyNode<TypeId, NormalizedBindingData>*)nullptr),
-    multibindings(std::move(normalized_component_storage_ptr->multibindings)) {
+    instances(bindings.size()),
+    multibindings(std::move(normalized_component_storage_ptr->multibindings)),
+    normalized_component_storage(normalized_component_storage_ptr.get()),
+    construction_schedule(&normalized_component_storage_ptr->construction_schedule),
+    construction_phase_times(normalized_component_storage_ptr->construction_phase_times) {
 
 #ifdef FRUIT_EXTRA_DEBUG
   bindings.checkFullyConstructed();
 #endif
+#if FRUIT_ENABLE_INJECTION_EVENTS
+  node_types = bindings.getNodeIds();
+#endif
 }
 
 InjectorStorage::InjectorStorage(const NormalizedComponentStorage& normalized_component,
                                  const ComponentStorage& component,
                                  std::vector<TypeId>&& exposed_types)
-  : multibindings(normalized_component.multibindings) {
+  : multibindings(normalized_component.multibindings),
+    normalized_component_storage(&normalized_component),
+    construction_schedule(&normalized_component.construction_schedule) {
+  
+  ConstructionPhaseTimer timer(construction_phase_times);
 
   FixedSizeAllocator::FixedSizeAllocatorData fixed_size_allocator_data = normalized_component.fixed_size_allocator_data;
   
-  ;
+  std::vector<std::pair<TypeId, BindingData>> normalized_bindings =
+      normalizeAdditionalBindings(normalized_component.bindings,
+                                  normalized_component,
+                                  component,
+                                  fixed_size_allocator_data,
+                                  true /* allocator_data_has_compressed_types */,
+                                  std::move(exposed_types));
+  
+  {
+    ConstructionPhaseTimer::Phase phase(&ConstructionPhaseTimes::graph_construction_ns);
+    bindings = Graph(normalized_component.bindings,
+                     BindingDataNodeIter{normalized_bindings.begin()},
+                     BindingDataNodeIter{normalized_bindings.end()});
+  }
+  construction_phase_times.num_new_bindings = normalized_bindings.size();
+  instances = InstanceTable(bindings.size());
+  
+  if (normalized_component.shared_instances_storage != nullptr) {
+    parent_storage = normalized_component.shared_instances_storage.get();
+    parent_nodes = &normalized_component.component_scoped_nodes;
+  }
+  
+  // Add multibindings.
+  BindingNormalization::addMultibindings(multibindings, fixed_size_allocator_data, std::move(component.multibindings));
+  
+  allocator = FixedSizeAllocator(fixed_size_allocator_data);
+  
+#ifdef FRUIT_EXTRA_DEBUG
+  bindings.checkFullyConstructed();
+#endif
+#if FRUIT_ENABLE_INJECTION_EVENTS
+  node_types = bindings.getNodeIds();
+#endif
+}
+
+InjectorStorage::InjectorStorage(const NormalizedComponentStorage& normalized_component,
+                                 const std::pair<TypeId, void*>* required_instances,
+                                 std::size_t num_required_instances)
+  : allocator(normalized_component.fixed_size_allocator_data),
+    multibindings(normalized_component.multibindings),
+    normalized_component_storage(&normalized_component),
+    construction_schedule(&normalized_component.construction_schedule),
+    constructed_from_required_instances(true) {
+  
+  ConstructionPhaseTimer timer(construction_phase_times);
+  
+  if (normalized_component.all_required_types_have_nodes) {
+    std::vector<std::pair<std::size_t, NormalizedBindingData>> terminal_nodes;
+    terminal_nodes.reserve(normalized_component.required_type_nodes.size());
+    for (const std::pair<TypeId, std::size_t>& p : normalized_component.required_type_nodes) {
+      // There are very few required types, so a linear search is faster than a hash table lookup here.
+      for (std::size_t i = 0; i < num_required_instances; ++i) {
+        if (required_instances[i].first == p.first) {
+          terminal_nodes.emplace_back(p.second, NormalizedBindingData(required_instances[i].second));
+          break;
+        }
+      }
+    }
+    ConstructionPhaseTimer::Phase phase(&ConstructionPhaseTimes::graph_construction_ns);
+    bindings = Graph(normalized_component.bindings, terminal_nodes.data(), terminal_nodes.size());
+  } else {
+    // Some required type doesn't have a node in normalized_component.bindings yet, so we can't just fill the reserved
+    // nodes. This only happens if some required type is not a dependency of any type bound in the NormalizedComponent.
+    std::vector<std::pair<TypeId, BindingData>> instance_bindings;
+    instance_bindings.reserve(num_required_instances);
+    for (std::size_t i = 0; i < num_required_instances; ++i) {
+      instance_bindings.emplace_back(required_instances[i].first, BindingData(required_instances[i].second));
+    }
+    ConstructionPhaseTimer::Phase phase(&ConstructionPhaseTimes::graph_construction_ns);
+    bindings = Graph(normalized_component.bindings,
+                     BindingDataNodeIter{instance_bindings.begin()},
+                     BindingDataNodeIter{instance_bindings.end()});
+    phase.end();
+    construction_phase_times.num_new_bindings = instance_bindings.size();
+  }
+  instances = InstanceTable(bindings.size());
+  
+  if (normalized_component.shared_instances_storage != nullptr) {
+    parent_storage = normalized_component.shared_instances_storage.get();
+    parent_nodes = &normalized_component.component_scoped_nodes;
+  }
+  
+#ifdef FRUIT_EXTRA_DEBUG
+  bindings.checkFullyConstructed();
+#endif
+#if FRUIT_ENABLE_INJECTION_EVENTS
+  node_types = bindings.getNodeIds();
+#endif
+}
+
+InjectorStorage::InjectorStorage(InjectorStorage& parent,
+                                 const ComponentStorage& component,
+                                 std::vector<TypeId>&& exposed_types)
+  : normalized_component_storage(parent.normalized_component_storage),
+    parent_storage(&parent),
+    num_parent_nodes(parent.bindings.size()) {
+  
+  ConstructionPhaseTimer timer(construction_phase_times);
+  
+  // The parent's objects (and multibindings) are constructed on demand by this injector too, possibly from other threads
+  // than the ones using the parent (or other child injectors). Enabling concurrent injection here would race with those
+  // threads, so it must have been done before.
+  if (!parent.concurrent_injection_enabled) {
+    fatal("A child injector can only be created after calling enableConcurrentInjection() on the parent injector.");
+  }
+  
+  // The space for the parent's types is in the parent's allocator, here we only need space for the new types.
+  FixedSizeAllocator::FixedSizeAllocatorData fixed_size_allocator_data;
+  
+  std::vector<std::pair<TypeId, BindingData>> normalized_bindings =
+      normalizeAdditionalBindings(parent.bindings,
+                                  *normalized_component_storage,
+                                  component,
+                                  fixed_size_allocator_data,
+                                  false /* allocator_data_has_compressed_types */,
+                                  std::move(exposed_types));
+  
+  // The remaining bindings for types that are already in the parent come from undoing binding compressions, so they must
+  // be constructed in this injector.
+  for (const std::pair<TypeId, BindingData>& p : normalized_bindings) {
+    Graph::node_iterator node_itr = parent.bindings.find(p.first);
+    if (!(node_itr == parent.bindings.end())) {
+      rebound_parent_nodes.push_back(node_itr.getIndex());
+    }
+  }
+  std::sort(rebound_parent_nodes.begin(), rebound_parent_nodes.end());
+  
+  {
+    ConstructionPhaseTimer::Phase phase(&ConstructionPhaseTimes::graph_construction_ns);
+    bindings = Graph(parent.bindings,
+                     BindingDataNodeIter{normalized_bindings.begin()},
+                     BindingDataNodeIter{normalized_bindings.end()});
+  }
+  construction_phase_times.num_new_bindings = normalized_bindings.size();
+  instances = InstanceTable(bindings.size());
+  
+  BindingNormalization::addMultibindings(multibindings, fixed_size_allocator_data, std::move(component.multibindings));
+  
+  // For types that also have multibindings in an ancestor injector, the ancestor's objects come first. These are
+  // constructed now (in the ancestor), so that the child's vector can contain them.
+  for (auto& p : multibindings) {
+    for (InjectorStorage* ancestor = &parent; ancestor != nullptr; ancestor = ancestor->parent_storage) {
+      NormalizedMultibindingData* ancestor_multibinding_data = ancestor->getNormalizedMultibindingData(p.first);
+      if (ancestor_multibinding_data != nullptr) {
+        ancestor->getMultibindings(p.first);
+        // The ancestor's elems include the ones of its own ancestors (if any) already.
+        p.second.elems.insert(p.second.elems.begin(),
+                              ancestor_multibinding_data->elems.begin(),
+                              ancestor_multibinding_data->elems.end());
+        break;
+      }
+    }
+  }
+  
+  allocator = FixedSizeAllocator(fixed_size_allocator_data);
+  
+#ifdef FRUIT_EXTRA_DEBUG
+  bindings.checkFullyConstructed();
+#endif
+#if FRUIT_ENABLE_INJECTION_EVENTS
+  node_types = bindings.getNodeIds();
+#endif
+}
+
+std::vector<std::pair<TypeId, BindingData>> InjectorStorage::normalizeAdditionalBindings(
+    const Graph& base_bindings,
+    const NormalizedComponentStorage& normalized_component,
+    const ComponentStorage& component,
+    FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+    bool allocator_data_has_compressed_types,
+    std::vector<TypeId>&& exposed_types) {
   
   // Step 1: Remove duplicates among the new bindings, and check for inconsistent bindings within `component' alone.
   // Note that we do NOT use component.compressed_bindings here, to avoid having to check if these compressions can be undone.
@@ -107,13 +303,15 @@ InjectorStorage::InjectorStorage(const NormalizedComponentStorage& normalized_co
                                               bindingCompressionInfoMapUnused);
   FruitAssert(bindingCompressionInfoMapUnused.empty());
   
-  HashSet<TypeId> binding_compressions_to_undo = 
-      createHashSet<TypeId>(TypeId{nullptr}, getInvalidTypeId());
+  ConstructionPhaseTimer::Phase duplicate_detection_phase(&ConstructionPhaseTimes::duplicate_detection_ns);
+  
+  // This can contain duplicates, they're removed before step 3.
+  std::vector<TypeId> binding_compressions_to_undo;
   
-  // Step 2: Filter out already-present bindings, and check for inconsistent bindings between `normalizedComponent' and
+  // Step 2: Filter out already-present bindings, and check for inconsistent bindings between `base_bindings' and
   // `component'. Also determine what binding compressions must be undone
   auto itr = std::remove_if(normalized_bindings.begin(), normalized_bindings.end(),
-                            [&normalized_component, &binding_compressions_to_undo](const std::pair<TypeId, BindingData>& p) {
+                            [&base_bindings, &normalized_component, &binding_compressions_to_undo](const std::pair<TypeId, BindingData>& p) {
                               if (!p.second.isCreated()) {
                                 for (std::size_t i = 0; i < p.second.getDeps()->num_deps; ++i) {
                                   auto binding_compression_itr = 
@@ -122,12 +320,12 @@ InjectorStorage::InjectorStorage(const NormalizedComponentStorage& normalized_co
                                       && binding_compression_itr->second.iTypeId != p.first) {
                                     // The binding compression for `p.second.getDeps()->deps[i]' must be undone because something
                                     // different from binding_compression_itr->iTypeId is now bound to it.
-                                    binding_compressions_to_undo.insert(p.second.getDeps()->deps[i]);
+                                    binding_compressions_to_undo.push_back(p.second.getDeps()->deps[i]);
                                   }
                                 }
                               }
-                              auto node_itr = normalized_component.bindings.find(p.first);
-                              if (node_itr == normalized_component.bindings.end()) {
+                              auto node_itr = base_bindings.find(p.first);
+                              if (node_itr == base_bindings.end()) {
                                 // Not bound yet, keep the new binding.
                                 return false;
                               }
@@ -140,41 +338,134 @@ InjectorStorage::InjectorStorage(const NormalizedComponentStorage& normalized_co
                             });
   normalized_bindings.erase(itr, normalized_bindings.end());
   
+  std::sort(binding_compressions_to_undo.begin(), binding_compressions_to_undo.end());
+  binding_compressions_to_undo.erase(std::unique(binding_compressions_to_undo.begin(), binding_compressions_to_undo.end()),
+                                     binding_compressions_to_undo.end());
+  
+  duplicate_detection_phase.end();
+  
   // Step 3: undo any binding compressions that can no longer be applied.
+  ConstructionPhaseTimer::Phase binding_compression_phase(&ConstructionPhaseTimes::binding_compression_ns);
   for (TypeId cTypeId : binding_compressions_to_undo) {
+    if (!(base_bindings.find(cTypeId) == base_bindings.end())) {
+      // Already undone when constructing `base_bindings' (this only happens for child injectors).
+      continue;
+    }
     auto binding_compression_itr = normalized_component.bindingCompressionInfoMap->find(cTypeId);
     FruitAssert(binding_compression_itr != normalized_component.bindingCompressionInfoMap->end());
     FruitAssert(!binding_compression_itr->second.iBinding.needsAllocation());
     normalized_bindings.emplace_back(cTypeId, binding_compression_itr->second.cBinding);
-    // This TypeId is already in normalized_component.bindings, we overwrite it here.
-    FruitAssert(!(normalized_component.bindings.find(binding_compression_itr->second.iTypeId) == normalized_component.bindings.end()));
+    if (!allocator_data_has_compressed_types) {
+      if (binding_compression_itr->second.cBinding.needsAllocation()) {
+        fixed_size_allocator_data.addType(cTypeId);
+      } else {
+        fixed_size_allocator_data.addExternallyAllocatedType(cTypeId);
+      }
+    }
+    // This TypeId is already in base_bindings, we overwrite it here.
+    FruitAssert(!(base_bindings.find(binding_compression_itr->second.iTypeId) == base_bindings.end()));
     normalized_bindings.emplace_back(binding_compression_itr->second.iTypeId, binding_compression_itr->second.iBinding);
 #ifdef FRUIT_EXTRA_DEBUG
     std::cout << "InjectorStorage: undoing binding compression for: " << binding_compression_itr->second.iTypeId << "->" << cTypeId << std::endl;  
 #endif
   }
   
-  bindings = Graph(normalized_component.bindings,
-                   BindingDataNodeIter{normalized_bindings.begin()},
-                   BindingDataNodeIter{normalized_bindings.end()});
-  
-  // Step 4: Add multibindings.
-  BindingNormalization::addMultibindings(multibindings, fixed_size_allocator_data, std::move(component.multibindings));
-  
-  allocator = FixedSizeAllocator(fixed_size_allocator_data);
-  
-#ifdef FRUIT_EXTRA_DEBUG
-  bindings.checkFullyConstructed();
-#endif
+  return normalized_bindings;
 }
 
 InjectorStorage::~InjectorStorage() {
 }
 
-void InjectorStorage::ensureConstructedMultibinding(NormalizedMultibindingData& bindingDataForMultibinding) {
+void InjectorStorage::ensureConstructedMultibinding(TypeId type, NormalizedMultibindingData& bindingDataForMultibinding) {
   for (NormalizedMultibindingData::Elem& elem : bindingDataForMultibinding.elems) {
     if (elem.object == nullptr) {
-      elem.object = elem.create(*this);
+#if FRUIT_ENABLE_INJECTION_EVENTS
+      recordInjectionEvent(InjectionEvent::Kind::CONSTRUCTION_BEGIN, type, nullptr);
+#endif
+      if (profiler == nullptr) {
+        elem.object = elem.create(*this);
+      } else {
+        InjectionProfiler::Scope scope(*profiler);
+        elem.object = elem.create(*this);
+        scope.end(type, InjectionProfiler::NO_NODE);
+      }
+#if FRUIT_ENABLE_INJECTION_EVENTS
+      recordInjectionEvent(InjectionEvent::Kind::CONSTRUCTION_END, type, elem.object);
+#endif
+    }
+  }
+#if FRUIT_ENABLE_INJECTION_EVENTS
+  recordInjectionEvent(InjectionEvent::Kind::MULTIBINDINGS_CONSTRUCTED, type, nullptr);
+#endif
+}
+
+void* InjectorStorage::invokeCreate(Graph::node_iterator node_itr) {
+#if FRUIT_ENABLE_INJECTION_EVENTS
+  TypeId type = node_types[node_itr.getIndex()];
+  recordInjectionEvent(InjectionEvent::Kind::CONSTRUCTION_BEGIN, type, nullptr);
+#endif
+  void* p;
+  if (profiler == nullptr) {
+    p = node_itr.getNode().create(*this, node_itr);
+  } else {
+    InjectionProfiler::Scope scope(*profiler);
+    p = node_itr.getNode().create(*this, node_itr);
+    scope.end(TypeId{nullptr}, node_itr.getIndex());
+  }
+#if FRUIT_ENABLE_INJECTION_EVENTS
+  recordInjectionEvent(InjectionEvent::Kind::CONSTRUCTION_END, type, p);
+#endif
+  return p;
+}
+
+bool InjectorStorage::isParentNode(std::size_t index) const {
+  if (parent_nodes != nullptr) {
+    return index < parent_nodes->size() && (*parent_nodes)[index];
+  }
+  return index < num_parent_nodes
+      && !std::binary_search(rebound_parent_nodes.begin(), rebound_parent_nodes.end(), index);
+}
+
+void* InjectorStorage::createInstance(Graph::node_iterator node_itr) {
+  std::size_t index = node_itr.getIndex();
+  if (parent_storage != nullptr && isParentNode(index)) {
+    // Cache the parent's object in `instances' too, so that we won't need to look it up again.
+    void* p = parent_storage->getPtrInternal(node_itr);
+    instances.set(index, p);
+    return p;
+  }
+  if (concurrent_injection_enabled) {
+    return createConcurrently(node_itr);
+  }
+  void* p = invokeCreate(node_itr);
+  instances.set(index, p);
+  return p;
+}
+
+void* InjectorStorage::createConcurrently(Graph::node_iterator node_itr) {
+  std::size_t index = node_itr.getIndex();
+  while (true) {
+    if (instances.tryMarkAsInProgress(index)) {
+      // This thread is the one that constructs the object (unless another thread finished constructing it meanwhile).
+      void* p = instances.get(index);
+      if (p == nullptr) {
+        try {
+          p = invokeCreate(node_itr);
+        } catch (...) {
+          // Let the next thread that needs this object try again.
+          instances.clearInProgress(index);
+          throw;
+        }
+        instances.set(index, p);
+      }
+      instances.clearInProgress(index);
+      return p;
+    }
+    // Another thread is constructing the object, wait for it.
+    std::this_thread::yield();
+    void* p = instances.get(index);
+    if (p != nullptr) {
+      return p;
     }
   }
 }
@@ -182,15 +473,406 @@ void InjectorStorage::ensureConstructedMultibinding(NormalizedMultibindingData&
 void* InjectorStorage::getMultibindings(TypeId typeInfo) {
   NormalizedMultibindingData* bindingDataVector = getNormalizedMultibindingData(typeInfo);
   if (bindingDataVector == nullptr) {
+    if (parent_storage != nullptr) {
+      return parent_storage->getMultibindings(typeInfo);
+    }
     // Not registered.
     return nullptr;
   }
+  if (concurrent_injection_enabled) {
+    return getMultibindingsConcurrently(*bindingDataVector);
+  }
   return bindingDataVector->get_multibindings_vector(*this).get();
 }
 
+void* InjectorStorage::getMultibindingsConcurrently(NormalizedMultibindingData& multibinding_data) {
+  int* state = &multibinding_data.concurrent_construction_state;
+  while (true) {
+    int current_state = atomicLoadAcquire(state);
+    if (current_state == MULTIBINDINGS_CONSTRUCTED) {
+      return multibinding_data.v.get();
+    }
+    if (current_state == MULTIBINDINGS_NOT_CONSTRUCTED
+        && atomicCompareExchange(state, current_state, MULTIBINDINGS_IN_PROGRESS)) {
+      // This thread is the one that constructs the vector.
+      try {
+        multibinding_data.get_multibindings_vector(*this);
+      } catch (...) {
+        // Let the next thread that needs these multibindings try again.
+        atomicStoreRelease(state, MULTIBINDINGS_NOT_CONSTRUCTED);
+        throw;
+      }
+      atomicStoreRelease(state, MULTIBINDINGS_CONSTRUCTED);
+      return multibinding_data.v.get();
+    }
+    // Another thread is constructing the vector, wait for it.
+    std::this_thread::yield();
+  }
+}
+
 void InjectorStorage::eagerlyInjectMultibindings() {
   for (auto& typeInfoInfoPair : multibindings) {
-    typeInfoInfoPair.second.get_multibindings_vector(*this);
+    if (concurrent_injection_enabled) {
+      getMultibindingsConcurrently(typeInfoInfoPair.second);
+    } else {
+      typeInfoInfoPair.second.get_multibindings_vector(*this);
+    }
+  }
+}
+
+void InjectorStorage::eagerlyInjectConstructionSchedule() {
+  if (construction_schedule == nullptr) {
+    return;
+  }
+  const std::vector<std::size_t>& schedule = *construction_schedule;
+  // Start all the async providers first, so that they run concurrently instead of each one being started only after
+  // the previous ones are done.
+  for (std::size_t position : normalized_component_storage->async_provider_starts) {
+    getPtrInternal(bindings.atIndex(schedule[position]));
+  }
+  // The dependencies of each node come before it, so getPtrInternal() finds them already constructed.
+  for (std::size_t index : schedule) {
+    getPtrInternal(bindings.atIndex(index));
+  }
+}
+
+void InjectorStorage::eagerlyInjectConstructionScheduleInParallel(std::size_t num_threads) {
+  FruitAssert(concurrent_injection_enabled);
+  if (construction_schedule == nullptr || num_threads <= 1 || construction_schedule->size() <= 1) {
+    eagerlyInjectConstructionSchedule();
+    return;
+  }
+  const std::vector<std::size_t>& schedule = *construction_schedule;
+  std::size_t n = schedule.size();
+  num_threads = std::min(num_threads, n);
+  
+  // After sorting, the positions of the objects that depend on the one at position i are the second elements of the
+  // pairs in [dependents_begin[i], dependents_begin[i+1]).
+  std::vector<std::pair<std::size_t, std::size_t>> deps = normalized_component_storage->construction_schedule_deps;
+  std::sort(deps.begin(), deps.end());
+  deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+  std::vector<std::size_t> dependents_begin(n + 1, 0);
+  std::vector<std::size_t> num_pending_deps(n, 0);
+  for (const std::pair<std::size_t, std::size_t>& dep : deps) {
+    ++dependents_begin[dep.first + 1];
+    ++num_pending_deps[dep.second];
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    dependents_begin[i + 1] += dependents_begin[i];
+  }
+  
+  // The positions of the objects that can be constructed now. The ones that start an async provider are in
+  // ready_async_provider_starts instead, and they're constructed first, so that all the async computations are started
+  // before waiting for any of them.
+  std::vector<bool> starts_async_provider(n, false);
+  for (std::size_t position : normalized_component_storage->async_provider_starts) {
+    starts_async_provider[position] = true;
+  }
+  std::vector<std::size_t> ready;
+  std::vector<std::size_t> ready_async_provider_starts;
+  auto setReady = [&](std::size_t position) {
+    if (starts_async_provider[position]) {
+      ready_async_provider_starts.push_back(position);
+    } else {
+      ready.push_back(position);
+    }
+  };
+  for (std::size_t i = 0; i < n; ++i) {
+    if (num_pending_deps[i] == 0) {
+      setReady(i);
+    }
+  }
+  
+  // These fields (and the ready vectors, num_pending_deps) are protected by `mutex'.
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::size_t num_in_progress = 0;
+  std::exception_ptr error;
+  
+  auto worker = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cond.wait(lock, [&]() {
+        return !ready.empty() || !ready_async_provider_starts.empty() || num_in_progress == 0 || error != nullptr;
+      });
+      if ((ready.empty() && ready_async_provider_starts.empty()) || error != nullptr) {
+        // Either all objects are constructed, or some objects are left only due to a dependency loop. The latter will
+        // be reported when constructing them sequentially.
+        cond.notify_all();
+        return;
+      }
+      std::vector<std::size_t>& queue = ready_async_provider_starts.empty() ? ready : ready_async_provider_starts;
+      std::size_t position = queue.back();
+      queue.pop_back();
+      ++num_in_progress;
+      lock.unlock();
+      
+      std::exception_ptr current_error;
+      try {
+        getPtrInternal(bindings.atIndex(schedule[position]));
+      } catch (...) {
+        current_error = std::current_exception();
+      }
+      
+      lock.lock();
+      --num_in_progress;
+      if (current_error != nullptr) {
+        if (error == nullptr) {
+          error = current_error;
+        }
+      } else {
+        for (std::size_t i = dependents_begin[position]; i < dependents_begin[position + 1]; ++i) {
+          std::size_t dependent = deps[i].second;
+          if (--num_pending_deps[dependent] == 0) {
+            setReady(dependent);
+          }
+        }
+      }
+      cond.notify_all();
+    }
+  };
+  
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (std::size_t i = 1; i < num_threads; ++i) {
+    try {
+      threads.emplace_back(worker);
+    } catch (const std::system_error&) {
+      // No more threads can be created now, the ones created so far will do.
+      break;
+    }
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+void InjectorStorage::ignoreConstructionSchedule() {
+  construction_schedule = nullptr;
+}
+
+void InjectorStorage::reset(const NormalizedComponentStorage& normalized_component,
+                            const std::pair<TypeId, void*>* required_instances,
+                            std::size_t num_required_instances) {
+  if (!constructed_from_required_instances || normalized_component_storage != &normalized_component) {
+    fatal("reset() can only be called on an injector constructed from the same NormalizedComponent and instances of its required types.");
+  }
+  
+  // Objects are destroyed before changing anything else, since their destructors might still use the injector's state.
+  allocator.clear();
+  instances.clear();
+  
+  for (auto& p : multibindings) {
+    NormalizedMultibindingData& multibinding_data = p.second;
+    for (NormalizedMultibindingData::Elem& elem : multibinding_data.elems) {
+      if (elem.create != nullptr) {
+        // This object was constructed by this injector (if at all), so it was destroyed above.
+        elem.object = nullptr;
+      }
+    }
+    if (multibinding_data.v != nullptr) {
+      multibinding_data.v_is_stale = true;
+    }
+    multibinding_data.concurrent_construction_state = MULTIBINDINGS_NOT_CONSTRUCTED;
+  }
+  
+  // The nodes of the required types are in pages owned by `bindings', with both of the graph constructors used above.
+  for (std::size_t i = 0; i < num_required_instances; ++i) {
+    Graph::node_iterator node_itr = bindings.findIncludingReferencedNodes(required_instances[i].first);
+    FruitAssert(!(node_itr == bindings.end()));
+    bindings.setTerminalNodeValue(node_itr.getIndex(), NormalizedBindingData(required_instances[i].second));
+  }
+}
+
+void InjectorStorage::enableProfiling() {
+  if (profiler != nullptr) {
+    return;
+  }
+  profiler = std::unique_ptr<InjectionProfiler>(new InjectionProfiler());
+  allocator.enableProfiling();
+}
+
+InjectionProfile InjectorStorage::getProfile() {
+  FruitAssert(profiler != nullptr);
+  std::vector<InjectionProfiler::Record> records = profiler->getRecords();
+  std::vector<TypeId> node_ids = bindings.getNodeIds();
+  
+  InjectionProfile profile;
+  profile.entries.reserve(records.size());
+  // The index in profile.entries of the last construction of each node (or NO_ENTRY). Nodes can be constructed more than
+  // once due to reset().
+  const std::size_t NO_ENTRY = std::size_t(-1);
+  std::vector<std::size_t> entry_by_node(bindings.size(), NO_ENTRY);
+  for (const InjectionProfiler::Record& record : records) {
+    bool is_multibinding = record.node_index == InjectionProfiler::NO_NODE;
+    if (!is_multibinding) {
+      entry_by_node[record.node_index] = profile.entries.size();
+    }
+    InjectionProfile::Entry entry;
+    entry.type_name = std::string(is_multibinding ? record.type : node_ids[record.node_index]);
+    entry.is_multibinding = is_multibinding;
+    entry.start_ns = record.start_ns;
+    entry.total_ns = record.total_ns;
+    entry.self_ns = record.self_ns;
+    entry.allocated_bytes = record.allocated_bytes;
+    entry.thread_index = record.thread_index;
+    profile.entries.push_back(std::move(entry));
+  }
+  
+  if (construction_schedule == nullptr) {
+    return profile;
+  }
+  
+  // Find the longest path (weighted by self time) in the dependency graph of the construction schedule. Each node comes
+  // after its dependencies in the schedule, so a single pass is enough.
+  const std::vector<std::size_t>& schedule = *construction_schedule;
+  std::vector<std::pair<std::size_t, std::size_t>> deps_by_dependent;
+  deps_by_dependent.reserve(normalized_component_storage->construction_schedule_deps.size());
+  for (const std::pair<std::size_t, std::size_t>& dep : normalized_component_storage->construction_schedule_deps) {
+    deps_by_dependent.emplace_back(dep.second, dep.first);
+  }
+  std::sort(deps_by_dependent.begin(), deps_by_dependent.end());
+  // path_ns[i] is the weight of the longest path ending at position i, and path_predecessor[i] the previous position on
+  // that path (or NO_ENTRY).
+  std::vector<std::uint64_t> path_ns(schedule.size(), 0);
+  std::vector<std::size_t> path_predecessor(schedule.size(), NO_ENTRY);
+  std::size_t last_position = NO_ENTRY;
+  auto dep_itr = deps_by_dependent.begin();
+  for (std::size_t position = 0; position < schedule.size(); ++position) {
+    for (; dep_itr != deps_by_dependent.end() && dep_itr->first == position; ++dep_itr) {
+      std::size_t dep_position = dep_itr->second;
+      if (path_predecessor[position] == NO_ENTRY || path_ns[dep_position] > path_ns[path_predecessor[position]]) {
+        path_predecessor[position] = dep_position;
+      }
+    }
+    std::size_t entry_index = entry_by_node[schedule[position]];
+    if (entry_index == NO_ENTRY) {
+      // Not constructed by this injector (or not yet), so it's not on the critical path.
+      path_predecessor[position] = NO_ENTRY;
+      continue;
+    }
+    path_ns[position] = profile.entries[entry_index].self_ns;
+    if (path_predecessor[position] != NO_ENTRY) {
+      path_ns[position] += path_ns[path_predecessor[position]];
+    }
+    if (last_position == NO_ENTRY || path_ns[position] > path_ns[last_position]) {
+      last_position = position;
+    }
+  }
+  
+  for (std::size_t position = last_position; position != NO_ENTRY; position = path_predecessor[position]) {
+    if (entry_by_node[schedule[position]] != NO_ENTRY) {
+      profile.critical_path.push_back(entry_by_node[schedule[position]]);
+    }
+  }
+  std::reverse(profile.critical_path.begin(), profile.critical_path.end());
+  if (last_position != NO_ENTRY) {
+    profile.critical_path_ns = path_ns[last_position];
+  }
+  
+  return profile;
+}
+
+void InjectorStorage::enableMemoryAccounting() {
+  allocator.enableAccounting();
+}
+
+const ConstructionPhaseTimes& InjectorStorage::getConstructionPhaseTimes() const {
+  return construction_phase_times;
+}
+
+InjectorMemoryUsage InjectorStorage::getMemoryUsage() {
+  InjectorMemoryUsage usage;
+  std::unordered_map<TypeId, InjectorMemoryUsage::TypeEntry> entry_by_type;
+  
+  usage.pool_reserved_bytes = allocator.getReservedBytes();
+  usage.pool_used_bytes = allocator.getUsedBytes();
+  for (const std::pair<TypeId, FixedSizeAllocator::TypeStats>& p : allocator.getTypeStats()) {
+    const FixedSizeAllocator::TypeStats& stats = p.second;
+    InjectorMemoryUsage::TypeEntry& entry = entry_by_type[p.first];
+    entry.num_pool_objects += stats.num_objects;
+    entry.pool_reserved_bytes += stats.reserved_bytes;
+    entry.pool_used_bytes += stats.used_bytes;
+    entry.pool_padding_bytes += stats.padding_bytes;
+    entry.num_external_objects += stats.num_external_objects;
+    entry.external_bytes += stats.external_bytes;
+    usage.pool_padding_bytes += stats.padding_bytes;
+    usage.num_external_objects += stats.num_external_objects;
+    usage.external_bytes += stats.external_bytes;
+  }
+  
+  std::vector<TypeId> node_ids = bindings.getNodeIds();
+  auto add_graph = [&](const Graph& graph) {
+    usage.graph_bytes += graph.getAllocatedBytes();
+    graph.forEachOwnedNode([&](std::size_t index, std::size_t num_bytes) {
+      entry_by_type[node_ids[index]].graph_bytes += num_bytes;
+    });
+  };
+  add_graph(bindings);
+  if (normalized_component_storage_ptr != nullptr) {
+    // `bindings' extends the graph of this NormalizedComponentStorage, that is owned by this injector too.
+    add_graph(normalized_component_storage_ptr->bindings);
+  }
+  
+  usage.instance_table_bytes = instances.getAllocatedBytes();
+  
+  for (const auto& p : multibindings) {
+    const NormalizedMultibindingData& multibinding_data = p.second;
+    std::size_t num_bytes = multibinding_data.elems.capacity() * sizeof(NormalizedMultibindingData::Elem);
+    if (multibinding_data.v != nullptr) {
+      // The std::vector<T*> returned by getMultibindings(), that is allocated with the exact capacity needed.
+      num_bytes += sizeof(std::vector<void*>) + multibinding_data.elems.size() * sizeof(void*);
+    }
+    entry_by_type[p.first].multibinding_bytes += num_bytes;
+    usage.multibinding_bytes += num_bytes;
+  }
+  
+  usage.types.reserve(entry_by_type.size());
+  for (auto& p : entry_by_type) {
+    if (p.second.getTotalBytes() != 0) {
+      p.second.type_name = std::string(p.first);
+      usage.types.push_back(std::move(p.second));
+    }
+  }
+  // Ties are broken by name, so that the result doesn't depend on the hash table's order.
+  std::sort(usage.types.begin(), usage.types.end(),
+            [](const InjectorMemoryUsage::TypeEntry& x, const InjectorMemoryUsage::TypeEntry& y) {
+              return x.getTotalBytes() > y.getTotalBytes()
+                  || (x.getTotalBytes() == y.getTotalBytes() && x.type_name < y.type_name);
+            });
+  
+  return usage;
+}
+
+void InjectorStorage::enableConcurrentInjection() {
+  // hardware_concurrency() returns 0 if it's not known.
+  enableConcurrentInjection(std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+void InjectorStorage::enableConcurrentInjection(std::size_t max_async_threads) {
+  if (concurrent_injection_enabled) {
+    // Avoid writing to these fields while other threads might be reading them.
+    return;
+  }
+  concurrent_injection_enabled = true;
+  allocator.enableConcurrentAllocations();
+  // No threads are created until runAsync() is called.
+  async_executor = std::unique_ptr<AsyncExecutor>(new AsyncExecutor(std::max(max_async_threads, std::size_t(1))));
+}
+
+void InjectorStorage::runAsync(std::function<void()> task) {
+  checkConcurrentInjectionEnabled();
+  async_executor->schedule(std::move(task));
+}
+
+void InjectorStorage::checkConcurrentInjectionEnabled() const {
+  if (!concurrent_injection_enabled) {
+    fatal("getAsync() can only be called after enableConcurrentInjection().");
   }
 }
 
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/data_structures/instance_table.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace fruit::impl;
+
+namespace fruit {
+namespace impl {
+
+InstanceTable::InstanceTable(std::size_t size) {
+  std::size_t num_words = (size + bits_per_word - 1) / bits_per_word;
+  // The +1 ensures that we never call calloc() with a size of 0, that might return nullptr.
+  void* storage = std::calloc(size * sizeof(void*) + num_words * sizeof(std::uint64_t) + 1, 1);
+  if (storage == nullptr) {
+    throw std::bad_alloc();
+  }
+  objects = static_cast<void**>(storage);
+  in_progress = reinterpret_cast<std::uint64_t*>(objects + size);
+}
+
+void InstanceTable::clear() {
+  std::size_t size = reinterpret_cast<void**>(in_progress) - objects;
+  std::size_t num_words = (size + bits_per_word - 1) / bits_per_word;
+  std::memset(objects, 0, size * sizeof(void*) + num_words * sizeof(std::uint64_t));
+}
+
+std::size_t InstanceTable::getAllocatedBytes() const {
+  if (objects == nullptr) {
+    return 0;
+  }
+  std::size_t size = reinterpret_cast<void**>(in_progress) - objects;
+  std::size_t num_words = (size + bits_per_word - 1) / bits_per_word;
+  return size * sizeof(void*) + num_words * sizeof(std::uint64_t) + 1;
+}
+
+InstanceTable::~InstanceTable() {
+  std::free(objects);
+}
+
+} // namespace impl
+} // namespace fruit
@@ -22,6 +22,7 @@
 #include <iostream>
 #include <algorithm>
 #include <fruit/impl/util/type_info.h>
+#include <fruit/impl/construction_phase_timer.h>
 
 #include <fruit/impl/storage/normalized_component_storage.h>
 #include <fruit/impl/storage/component_storage.h>
@@ -35,15 +36,137 @@ using std::endl;
 using namespace fruit;
 using namespace fruit::impl;
 
+namespace {
+
+enum class ComponentScopeState : unsigned char {
+  UNKNOWN,
+  VISITING,
+  SCOPED,
+  NOT_SCOPED,
+};
+
+using Graph = NormalizedComponentStorage::Graph;
+
+// An entry of the explicit stacks used by the DFS visits below: a node and the position of the next dependency to visit.
+struct DfsStackEntry {
+  std::size_t index;
+  std::size_t next_dep;
+};
+
+// Determines, for each node with state UNKNOWN, whether it's component-scoped (see
+// NormalizedComponentStorage::component_scoped_nodes), by checking its dependencies first. On return, each state is
+// either SCOPED or NOT_SCOPED.
+void computeComponentScopeStates(Graph& bindings,
+                                 const std::vector<const BindingDeps*>& deps_by_index,
+                                 std::vector<ComponentScopeState>& states) {
+  std::vector<DfsStackEntry> dfs_stack;
+  for (std::size_t root = 0; root < states.size(); ++root) {
+    if (states[root] != ComponentScopeState::UNKNOWN) {
+      continue;
+    }
+    states[root] = ComponentScopeState::VISITING;
+    dfs_stack.push_back(DfsStackEntry{root, 0});
+    while (!dfs_stack.empty()) {
+      DfsStackEntry& entry = dfs_stack.back();
+      const BindingDeps* deps = deps_by_index[entry.index];
+      if (entry.next_dep == deps->num_deps) {
+        states[entry.index] = ComponentScopeState::SCOPED;
+        dfs_stack.pop_back();
+        continue;
+      }
+      Graph::node_iterator dep_itr = bindings.find(deps->deps[entry.next_dep]);
+      ComponentScopeState dep_state =
+          (dep_itr == bindings.end()) ? ComponentScopeState::NOT_SCOPED : states[dep_itr.getIndex()];
+      switch (dep_state) {
+      case ComponentScopeState::SCOPED:
+        ++entry.next_dep;
+        break;
+      case ComponentScopeState::UNKNOWN:
+        // This dependency is visited first, and then checked again.
+        states[dep_itr.getIndex()] = ComponentScopeState::VISITING;
+        dfs_stack.push_back(DfsStackEntry{dep_itr.getIndex(), 0});
+        break;
+      default:
+        // Also covers loops (VISITING), that will be reported when injecting.
+        states[entry.index] = ComponentScopeState::NOT_SCOPED;
+        dfs_stack.pop_back();
+        break;
+      }
+    }
+  }
+}
+
+// Values of the `positions' vector below, for nodes that are not in the construction schedule.
+constexpr std::size_t NOT_VISITED = std::size_t(-1);
+constexpr std::size_t NOT_SCHEDULED = std::size_t(-2);
+
+// Appends the nodes of the specified types to `schedule' (unless they're already there), each after its eager
+// dependencies. Only the nodes with a non-null entry in deps_by_index are added; the others don't need to be constructed.
+// positions[i] is the position of the node with index i in `schedule' (or one of the values above), and for each
+// dependency between two nodes in the schedule the (dependency index, node index) pair is added to `schedule_deps'.
+void addToConstructionSchedule(const std::vector<TypeId>& types,
+                               Graph& bindings,
+                               const std::vector<const BindingDeps*>& deps_by_index,
+                               std::vector<std::size_t>& positions,
+                               std::vector<std::size_t>& schedule,
+                               std::vector<std::pair<std::size_t, std::size_t>>& schedule_deps) {
+  std::vector<DfsStackEntry> dfs_stack;
+  // Visits the node with the specified index (if not visited yet). If it needs to be constructed, it's pushed to
+  // dfs_stack and it's added to the schedule once its eager dependencies have been.
+  auto enterNode = [&](std::size_t index) {
+    if (positions[index] != NOT_VISITED) {
+      // Also covers loops, that will be reported when injecting.
+      return;
+    }
+    positions[index] = NOT_SCHEDULED;
+    if (deps_by_index[index] != nullptr) {
+      dfs_stack.push_back(DfsStackEntry{index, 0});
+    }
+  };
+  for (TypeId type : types) {
+    Graph::node_iterator node_itr = bindings.find(type);
+    if (node_itr == bindings.end()) {
+      continue;
+    }
+    enterNode(node_itr.getIndex());
+    while (!dfs_stack.empty()) {
+      DfsStackEntry& entry = dfs_stack.back();
+      std::size_t index = entry.index;
+      const BindingDeps* deps = deps_by_index[index];
+      if (entry.next_dep == deps->num_eager_deps) {
+        positions[index] = schedule.size();
+        schedule.push_back(index);
+        dfs_stack.pop_back();
+        continue;
+      }
+      Graph::node_iterator dep_itr = bindings.find(deps->eager_deps[entry.next_dep]);
+      ++entry.next_dep;
+      if (!(dep_itr == bindings.end())) {
+        std::size_t dep_index = dep_itr.getIndex();
+        if (deps_by_index[dep_index] != nullptr) {
+          schedule_deps.emplace_back(dep_index, index);
+        }
+        enterNode(dep_index);
+      }
+    }
+  }
+}
+
+} // namespace
+
 namespace fruit {
 namespace impl {
 
-NormalizedComponentStorage::NormalizedComponentStorage(const ComponentStorage& component, const std::vector<TypeId>& exposed_types)
+NormalizedComponentStorage::NormalizedComponentStorage(const ComponentStorage& component,
+                                                       const std::vector<TypeId>& exposed_types,
+                                                       const std::vector<TypeId>& required_types)
   : bindingCompressionInfoMap(
       std::unique_ptr<BindingNormalization::BindingCompressionInfoMap>(
           new BindingNormalization::BindingCompressionInfoMap(
               createHashMap<TypeId, BindingNormalization::BindingCompressionInfo>(
                 TypeId{nullptr}, getInvalidTypeId())))) {
+  ConstructionPhaseTimer timer(construction_phase_times);
+  
   std::vector<std::pair<TypeId, BindingData>> normalized_bindings =
       BindingNormalization::normalizeBindings(component.bindings,
                                               fixed_size_allocator_data,
@@ -52,12 +175,85 @@ NormalizedComponentStorage::NormalizedComponentStorage(const ComponentStorage& c
                                               exposed_types,
                                               *bindingCompressionInfoMap);
   
-  bindings = SemistaticGraph<TypeId, NormalizedBindingData>(InjectorStorage::BindingDataNodeIter{normalized_bindings.begin()},
-                                                            InjectorStorage::BindingDataNodeIter{normalized_bindings.end()},
-                                                            TypeId{nullptr},
-                                                            getInvalidTypeId());
+  {
+    ConstructionPhaseTimer::Phase phase(&ConstructionPhaseTimes::graph_construction_ns);
+    bindings = SemistaticGraph<TypeId, NormalizedBindingData>(InjectorStorage::BindingDataNodeIter{normalized_bindings.begin()},
+                                                              InjectorStorage::BindingDataNodeIter{normalized_bindings.end()},
+                                                              exposed_types);
+  }
+  construction_phase_times.num_new_bindings = normalized_bindings.size();
   
   BindingNormalization::addMultibindings(multibindings, fixed_size_allocator_data, std::vector<std::pair<TypeId, MultibindingData>>(component.multibindings.begin(), component.multibindings.end()));
+  
+  // The component-scoped nodes are only determined if needed, in shareComponentScopedInstances(). For now,
+  // component_scoped_nodes only marks the nodes bound to an object, that are always component-scoped.
+  component_scoped_nodes = std::vector<bool>(bindings.size(), false);
+  deps_by_index = std::vector<const BindingDeps*>(bindings.size(), nullptr);
+  for (const std::pair<TypeId, BindingData>& p : normalized_bindings) {
+    std::size_t index = bindings.at(p.first).getIndex();
+    if (p.second.isCreated()) {
+      component_scoped_nodes[index] = true;
+    } else {
+      deps_by_index[index] = p.second.getDeps();
+    }
+  }
+  
+  std::vector<std::size_t> positions(bindings.size(), NOT_VISITED);
+  addToConstructionSchedule(exposed_types, bindings, deps_by_index, positions, construction_schedule,
+                            construction_schedule_deps);
+  for (std::pair<std::size_t, std::size_t>& dep : construction_schedule_deps) {
+    dep = std::make_pair(positions[dep.first], positions[dep.second]);
+  }
+  for (std::size_t position = 0; position < construction_schedule.size(); ++position) {
+    if (deps_by_index[construction_schedule[position]]->starts_async_provider) {
+      async_provider_starts.push_back(position);
+    }
+  }
+  
+  for (TypeId type : required_types) {
+    Graph::node_iterator node_itr = bindings.findIncludingReferencedNodes(type);
+    if (node_itr == bindings.end()) {
+      // No type bound in this component depends on `type'.
+      all_required_types_have_nodes = false;
+    } else {
+      required_type_nodes.emplace_back(type, node_itr.getIndex());
+    }
+  }
+}
+
+void NormalizedComponentStorage::shareComponentScopedInstances() {
+  if (shared_instances_storage != nullptr) {
+    return;
+  }
+  
+  // Determine the component-scoped nodes.
+  // Nodes that are not bound in this component keep the NOT_SCOPED state.
+  std::vector<ComponentScopeState> states(bindings.size(), ComponentScopeState::NOT_SCOPED);
+  for (std::size_t i = 0; i < bindings.size(); ++i) {
+    if (component_scoped_nodes[i]) {
+      states[i] = ComponentScopeState::SCOPED;
+    } else if (deps_by_index[i] != nullptr) {
+      states[i] = ComponentScopeState::UNKNOWN;
+    }
+  }
+  for (const auto& p : *bindingCompressionInfoMap) {
+    states[bindings.at(p.second.iTypeId).getIndex()] = ComponentScopeState::NOT_SCOPED;
+  }
+  computeComponentScopeStates(bindings, deps_by_index, states);
+  for (std::size_t i = 0; i < bindings.size(); ++i) {
+    component_scoped_nodes[i] = (states[i] == ComponentScopeState::SCOPED);
+  }
+  // Not needed anymore.
+  deps_by_index = std::vector<const BindingDeps*>();
+  
+  shared_instances_storage = std::unique_ptr<InjectorStorage>(
+      new InjectorStorage(*this, ComponentStorage(), std::vector<TypeId>{}));
+  // Injectors in different threads can use the shared instances concurrently.
+  shared_instances_storage->enableConcurrentInjection();
+}
+
+const ConstructionPhaseTimes& NormalizedComponentStorage::getConstructionPhaseTimes() const {
+  return construction_phase_times;
 }
 
 NormalizedComponentStorage::~NormalizedComponentStorage() {
@@ -26,12 +26,20 @@ namespace fruit {
 namespace impl {
 
 NormalizedComponentStorageHolder::NormalizedComponentStorageHolder(
-  const ComponentStorage& component, const std::vector<TypeId>& exposed_types)
-  : storage(new NormalizedComponentStorage(component, exposed_types)) {
+  const ComponentStorage& component, const std::vector<TypeId>& exposed_types, const std::vector<TypeId>& required_types)
+  : storage(new NormalizedComponentStorage(component, exposed_types, required_types)) {
 }
 
 NormalizedComponentStorageHolder::~NormalizedComponentStorageHolder() {
 }
 
+void NormalizedComponentStorageHolder::shareComponentScopedInstances() {
+  storage->shareComponentScopedInstances();
+}
+
+ConstructionPhaseTimes NormalizedComponentStorageHolder::getConstructionPhaseTimes() const {
+  return storage->getConstructionPhaseTimes();
+}
+
 } // namespace impl
 } // namespace fruit
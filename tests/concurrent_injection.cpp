@@ -0,0 +1,130 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fruit/fruit.h>
+#include "test_macros.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// The constructors sleep to make it likely that multiple threads try to construct the same instance at the same time.
+
+struct X {
+  INJECT(X()) {
+    num_constructed++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  
+  static std::atomic<int> num_constructed;
+};
+
+std::atomic<int> X::num_constructed(0);
+
+struct Y {
+  INJECT(Y(X*, fruit::Provider<X>)) {
+    num_constructed++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  
+  static std::atomic<int> num_constructed;
+};
+
+std::atomic<int> Y::num_constructed(0);
+
+struct Z {
+  Z() {
+    num_constructed++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  
+  static std::atomic<int> num_constructed;
+};
+
+std::atomic<int> Z::num_constructed(0);
+
+struct Listener {
+  virtual ~Listener() = default;
+};
+
+struct ListenerImpl : public Listener {
+  INJECT(ListenerImpl(Y*)) {
+    num_constructed++;
+  }
+  
+  static std::atomic<int> num_constructed;
+};
+
+std::atomic<int> ListenerImpl::num_constructed(0);
+
+fruit::Component<X, Y, Z> getComponent() {
+  return fruit::createComponent()
+    .registerProvider([](){return Z();})
+    .addMultibinding<Listener, ListenerImpl>()
+    .addMultibindingProvider([](X*) -> Listener* {return new ListenerImpl(nullptr);});
+}
+
+const int num_threads = 16;
+
+int main() {
+  fruit::Injector<X, Y, Z> injector(getComponent());
+  injector.enableConcurrentInjection();
+  
+  Assert(X::num_constructed == 0);
+  Assert(Y::num_constructed == 0);
+  Assert(Z::num_constructed == 0);
+  
+  std::vector<X*> xs(num_threads);
+  std::vector<Y*> ys(num_threads);
+  std::vector<Z*> zs(num_threads);
+  std::vector<const std::vector<Listener*>*> listeners(num_threads);
+  
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&injector, &xs, &ys, &zs, &listeners, i]() {
+      // Different threads request the instances in different orders.
+      if (i % 2 == 0) {
+        xs[i] = injector.get<X*>();
+        ys[i] = injector.get<Y*>();
+      } else {
+        ys[i] = injector.get<Y*>();
+        xs[i] = injector.get<X*>();
+      }
+      fruit::Provider<Z> zProvider = injector.get<fruit::Provider<Z>>();
+      zs[i] = zProvider.get<Z*>();
+      listeners[i] = &injector.getMultibindings<Listener>();
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  
+  Assert(X::num_constructed == 1);
+  Assert(Y::num_constructed == 1);
+  Assert(Z::num_constructed == 1);
+  Assert(ListenerImpl::num_constructed == 2);
+  
+  for (int i = 0; i < num_threads; i++) {
+    Assert(xs[i] == injector.get<X*>());
+    Assert(ys[i] == injector.get<Y*>());
+    Assert(zs[i] == injector.get<fruit::Provider<Z>>().get<Z*>());
+    Assert(listeners[i] == &injector.getMultibindings<Listener>());
+    Assert(listeners[i]->size() == 2);
+  }
+  
+  return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fruit/fruit.h>
+#include "test_macros.h"
+
+#include <sstream>
+#include <string>
+
+struct X {
+  INJECT(X()) = default;
+};
+
+struct I {
+  virtual ~I() = default;
+};
+
+struct C : public I {
+  INJECT(C(X*)) {
+  }
+};
+
+struct Y {
+  Y(C*) {
+  }
+};
+
+struct Listener {
+  INJECT(Listener(X*)) {
+  }
+};
+
+fruit::Component<I> getComponent() {
+  return fruit::createComponent()
+    .bind<I, C>()
+    .addMultibinding<Listener, Listener>();
+}
+
+fruit::Component<fruit::Required<X>, I> getNormalizedComponent() {
+  return fruit::createComponent()
+    .bind<I, C>();
+}
+
+struct Z {
+  INJECT(Z()) = default;
+};
+
+// Nothing depends on Z, so the NormalizedComponent doesn't reserve a node for it.
+fruit::Component<fruit::Required<X, Z>, I> getNormalizedComponentWithUnusedRequirement() {
+  return fruit::createComponent()
+    .bind<I, C>();
+}
+
+fruit::Component<X, Y> getRequestComponent() {
+  return fruit::createComponent()
+    .registerProvider([](C* c) { return Y(c); })
+    .addMultibinding<Listener, Listener>();
+}
+
+void checkTimes(const fruit::ConstructionPhaseTimes& times) {
+  Assert(times.total_ns != 0);
+  Assert(times.duplicate_detection_ns + times.binding_compression_ns + times.multibindings_ns
+      + times.graph_construction_ns <= times.total_ns);
+  Assert(times.hash_selection_ns <= times.graph_construction_ns);
+  // The graphs here are small enough that their hash tables might not need a hash function.
+  Assert(times.num_rejected_hash_functions == 0 || times.num_hash_selections != 0);
+  
+  std::ostringstream os;
+  os << times;
+  Assert(os.str().find("hash selection") != std::string::npos);
+}
+
+int main() {
+  {
+    fruit::Injector<I> injector(getComponent());
+    checkTimes(injector.getConstructionPhaseTimes());
+  }
+  
+  {
+    fruit::NormalizedComponent<fruit::Required<X>, I> normalized_component(getNormalizedComponent());
+    fruit::ConstructionPhaseTimes normalized_component_times = normalized_component.getConstructionPhaseTimes();
+    checkTimes(normalized_component_times);
+    
+    // Y depends on C, so this undoes the binding compression of I->C.
+    fruit::Injector<I, X, Y> injector(normalized_component, getRequestComponent());
+    checkTimes(injector.getConstructionPhaseTimes());
+    Assert(injector.get<Y*>() != nullptr);
+    
+    // The NormalizedComponent's times don't change.
+    Assert(normalized_component.getConstructionPhaseTimes().total_ns == normalized_component_times.total_ns);
+    // The bindings for I and C.
+    Assert(normalized_component_times.num_new_bindings == 2);
+    // At least the bindings for Y and Listener.
+    Assert(injector.getConstructionPhaseTimes().num_new_bindings >= 2);
+  }
+  
+  {
+    fruit::NormalizedComponent<fruit::Required<X>, I> normalized_component(getNormalizedComponent());
+    X x;
+    fruit::Injector<I> injector(normalized_component, x);
+    Assert(injector.get<I*>() != nullptr);
+    
+    // The instance is stored in the node that the NormalizedComponent reserved for X, without normalizing or adding any
+    // binding.
+    fruit::ConstructionPhaseTimes times = injector.getConstructionPhaseTimes();
+    Assert(times.duplicate_detection_ns == 0);
+    Assert(times.binding_compression_ns == 0);
+    Assert(times.multibindings_ns == 0);
+    Assert(times.num_hash_selections == 0);
+    Assert(times.num_new_bindings == 0);
+  }
+  
+  {
+    fruit::NormalizedComponent<fruit::Required<X, Z>, I> normalized_component(getNormalizedComponentWithUnusedRequirement());
+    X x;
+    Z z;
+    fruit::Injector<I> injector(normalized_component, x, z);
+    Assert(injector.get<I*>() != nullptr);
+    
+    // Z has no node in the NormalizedComponent, so the instances are added as bindings instead.
+    fruit::ConstructionPhaseTimes times = injector.getConstructionPhaseTimes();
+    Assert(times.duplicate_detection_ns == 0);
+    Assert(times.binding_compression_ns == 0);
+    Assert(times.num_new_bindings == 2);
+  }
+  
+  return 0;
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fruit/fruit.h>
+#include "test_macros.h"
+
+#if FRUIT_HAS_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// A minimal coroutine type: it starts running immediately and sets `done' when it completes.
+struct Task {
+  struct promise_type {
+    Task get_return_object() {
+      return Task();
+    }
+    std::suspend_never initial_suspend() noexcept {
+      return {};
+    }
+    std::suspend_never final_suspend() noexcept {
+      return {};
+    }
+    void return_void() {
+    }
+    void unhandled_exception() {
+      std::terminate();
+    }
+  };
+};
+
+// Runs the scheduled tasks in the calling thread, when run() is called.
+struct QueueScheduler {
+  std::vector<std::function<void()>> tasks;
+  
+  void schedule(std::function<void()> task) {
+    tasks.push_back(std::move(task));
+  }
+  
+  void run() {
+    while (!tasks.empty()) {
+      std::function<void()> task = std::move(tasks.front());
+      tasks.erase(tasks.begin());
+      task();
+    }
+  }
+};
+
+// Runs each scheduled task in a new thread.
+struct ThreadScheduler {
+  std::vector<std::thread> threads;
+  
+  void schedule(std::function<void()> task) {
+    threads.emplace_back(std::move(task));
+  }
+  
+  void join() {
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+};
+
+struct Annotation {};
+
+struct X {
+  INJECT(X()) {
+    num_constructed++;
+  }
+  
+  static std::atomic<int> num_constructed;
+};
+
+std::atomic<int> X::num_constructed(0);
+
+struct Y {
+  INJECT(Y(X*)) {
+  }
+};
+
+struct Z {
+  INJECT(Z(X*)) {
+  }
+};
+
+struct Failing {
+  Failing() = default;
+};
+
+using XAnnot = fruit::Annotated<Annotation, X>;
+
+fruit::Component<X, XAnnot, Y, Z, Failing> getComponent() {
+  return fruit::createComponent()
+    .registerProvider<XAnnot()>([]() { return X(); })
+    .registerProvider([]() -> Failing {
+      throw std::runtime_error("Failing");
+    });
+}
+
+using MyInjector = fruit::Injector<X, XAnnot, Y, Z, Failing>;
+
+Task getX(MyInjector& injector, QueueScheduler& scheduler, X*& x, X*& annotated_x, bool& done) {
+  x = co_await injector.getAsync<X*>(scheduler);
+  X& x_ref = co_await injector.getAsync<X&>(scheduler);
+  Assert(&x_ref == x);
+  annotated_x = co_await injector.getAsync<fruit::Annotated<Annotation, X*>>(scheduler);
+  X x_copy = co_await injector.getAsync<XAnnot>(scheduler);
+  (void)x_copy;
+  done = true;
+}
+
+Task getFailing(MyInjector& injector, QueueScheduler& scheduler, bool& thrown) {
+  try {
+    co_await injector.getAsync<Failing>(scheduler);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+}
+
+Task getY(MyInjector& injector, ThreadScheduler& scheduler, Y*& y) {
+  y = co_await injector.getAsync<Y*>(scheduler);
+}
+
+Task getZ(MyInjector& injector, ThreadScheduler& scheduler, Z*& z) {
+  z = co_await injector.getAsync<Z*>(scheduler);
+}
+
+int main() {
+  {
+    MyInjector injector(getComponent());
+    injector.enableConcurrentInjection();
+    QueueScheduler scheduler;
+    X* x = nullptr;
+    X* annotated_x = nullptr;
+    bool done = false;
+    getX(injector, scheduler, x, annotated_x, done);
+    
+    // The coroutine is suspended until the scheduler runs the injection.
+    Assert(!done);
+    Assert(X::num_constructed == 0);
+    
+    scheduler.run();
+    Assert(done);
+    Assert(x == injector.get<X*>());
+    Assert(annotated_x == injector.get<fruit::Annotated<Annotation, X*>>());
+    Assert(x != annotated_x);
+    
+    bool thrown = false;
+    getFailing(injector, scheduler, thrown);
+    Assert(!thrown);
+    scheduler.run();
+    Assert(thrown);
+  }
+  
+  {
+    X::num_constructed = 0;
+    MyInjector injector(getComponent());
+    injector.enableConcurrentInjection();
+    ThreadScheduler scheduler;
+    Y* y = nullptr;
+    Z* z = nullptr;
+    getY(injector, scheduler, y);
+    getZ(injector, scheduler, z);
+    scheduler.join();
+    
+    Assert(y == injector.get<Y*>());
+    Assert(z == injector.get<Z*>());
+    // X is shared by Y and Z, and it's constructed only once.
+    Assert(X::num_constructed == 1);
+  }
+  
+  return 0;
+}
+
+#else // !FRUIT_HAS_COROUTINES
+
+int main() {
+  return 0;
+}
+
+#endif // FRUIT_HAS_COROUTINES
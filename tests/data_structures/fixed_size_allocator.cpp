@@ -160,6 +160,76 @@ void test_move_constructor() {
   Assert(Y::num_instances == 0);
 }
 
+void test_clear() {
+  {
+    FixedSizeAllocator::FixedSizeAllocatorData allocator_data;
+    allocator_data.addExternallyAllocatedType(getTypeId<X>());
+    allocator_data.addType(getTypeId<Y>());
+    FixedSizeAllocator allocator(allocator_data);
+    allocator.registerExternallyAllocatedObject(new X(15));
+    Y* y = allocator.constructObject<Y>();
+    allocator.clear();
+    Assert(X::num_instances == 0);
+    Assert(Y::num_instances == 0);
+    // The same objects can be constructed again, in the same space.
+    allocator.registerExternallyAllocatedObject(new X(15));
+    Assert(allocator.constructObject<Y>() == y);
+    Assert(X::num_instances == 1);
+    Assert(Y::num_instances == 1);
+  }
+  Assert(X::num_instances == 0);
+  Assert(Y::num_instances == 0);
+}
+
+void test_accounting() {
+  {
+    FixedSizeAllocator::FixedSizeAllocatorData allocator_data;
+    allocator_data.addExternallyAllocatedType(getTypeId<X>());
+    allocator_data.addType(getTypeId<TypeWithAlignment<1>>());
+    allocator_data.addType(getTypeId<TypeWithAlignment<8>>());
+    FixedSizeAllocator allocator(allocator_data);
+    Assert(allocator.getReservedBytes() == 1 + (8 + 7));
+    Assert(allocator.getUsedBytes() == 0);
+    Assert(allocator.getTypeStats().empty());
+    
+    allocator.enableAccounting();
+    allocator.registerExternallyAllocatedObject(new X(15));
+    allocator.constructObject<TypeWithAlignment<1>>();
+    allocator.constructObject<TypeWithAlignment<8>>();
+    Assert(allocator.getUsedBytes() <= allocator.getReservedBytes());
+    
+    std::vector<std::pair<TypeId, FixedSizeAllocator::TypeStats>> type_stats = allocator.getTypeStats();
+    Assert(type_stats.size() == 3);
+    std::size_t used_bytes = 0;
+    for (const std::pair<TypeId, FixedSizeAllocator::TypeStats>& p : type_stats) {
+      const FixedSizeAllocator::TypeStats& stats = p.second;
+      used_bytes += stats.used_bytes;
+      if (p.first == getTypeId<X>()) {
+        Assert(stats.num_objects == 0);
+        Assert(stats.num_external_objects == 1);
+        Assert(stats.external_bytes == sizeof(X));
+      } else if (p.first == getTypeId<TypeWithAlignment<1>>()) {
+        Assert(stats.num_objects == 1);
+        Assert(stats.reserved_bytes == 1);
+        Assert(stats.used_bytes == 1);
+        Assert(stats.padding_bytes == 0);
+      } else {
+        Assert(p.first == getTypeId<TypeWithAlignment<8>>());
+        Assert(stats.num_objects == 1);
+        Assert(stats.reserved_bytes == 8 + 7);
+        Assert(stats.used_bytes == 8 + stats.padding_bytes);
+        Assert(stats.padding_bytes <= 7);
+      }
+    }
+    Assert(used_bytes == allocator.getUsedBytes());
+    
+    allocator.clear();
+    Assert(allocator.getUsedBytes() == 0);
+    Assert(allocator.getTypeStats().empty());
+  }
+  Assert(X::num_instances == 0);
+}
+
 int main() {
   test_empty_allocator();
   test_2_types();
@@ -168,6 +238,8 @@ int main() {
   test_remove_type();
   test_alignment();
   test_move_constructor();
+  test_clear();
+  test_accounting();
   
   return 0;
 }
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/data_structures/instance_table.h>
+#include "../test_macros.h"
+
+#include <utility>
+
+using namespace std;
+using namespace fruit::impl;
+
+void test_empty() {
+  InstanceTable table(0);
+  (void)table;
+}
+
+void test_get_set() {
+  int x = 1, y = 2;
+  InstanceTable table(200);
+  const InstanceTable& const_table = table;
+  Assert(table.get(0) == nullptr);
+  Assert(table.get(150) == nullptr);
+  table.set(150, &x);
+  table.set(3, &y);
+  Assert(table.get(150) == &x);
+  Assert(const_table.get(3) == &y);
+  Assert(table.get(0) == nullptr);
+  Assert(table.get(151) == nullptr);
+  Assert(table.get(199) == nullptr);
+}
+
+void test_mark_as_in_progress() {
+  int x = 1;
+  InstanceTable table(100);
+  Assert(table.tryMarkAsInProgress(70) == true);
+  Assert(table.tryMarkAsInProgress(70) == false);
+  Assert(table.tryMarkAsInProgress(71) == true);
+  Assert(table.get(70) == nullptr);
+  table.set(70, &x);
+  table.clearInProgress(70);
+  Assert(table.get(70) == &x);
+  Assert(table.tryMarkAsInProgress(70) == true);
+  Assert(table.tryMarkAsInProgress(71) == false);
+  table.clearInProgress(71);
+  Assert(table.tryMarkAsInProgress(71) == true);
+}
+
+void test_clear() {
+  int x = 1;
+  InstanceTable table(100);
+  table.set(5, &x);
+  table.set(99, &x);
+  Assert(table.tryMarkAsInProgress(70) == true);
+  table.clear();
+  Assert(table.get(5) == nullptr);
+  Assert(table.get(99) == nullptr);
+  Assert(table.tryMarkAsInProgress(70) == true);
+  table.set(5, &x);
+  Assert(table.get(5) == &x);
+}
+
+void test_move_assignment() {
+  int x = 1;
+  InstanceTable table1(10);
+  table1.set(5, &x);
+  InstanceTable table;
+  table = std::move(table1);
+  Assert(table.get(5) == &x);
+  Assert(table.get(4) == nullptr);
+}
+
+int main() {
+  
+  test_empty();
+  test_get_set();
+  test_mark_as_in_progress();
+  test_clear();
+  test_move_assignment();
+  
+  return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/data_structures/ring_buffer.h>
+#include "../test_macros.h"
+
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace fruit::impl;
+
+vector<int> popAll(RingBuffer<int>& buffer) {
+  vector<int> result;
+  size_t n = buffer.popAll([&result](int x) {
+    result.push_back(x);
+  });
+  Assert(n == result.size());
+  return result;
+}
+
+void test_empty() {
+  RingBuffer<int> buffer(4);
+  Assert(buffer.capacity() == 4);
+  Assert(popAll(buffer).empty());
+}
+
+void test_push_and_pop() {
+  RingBuffer<int> buffer(4);
+  Assert(buffer.tryPush(10));
+  Assert(buffer.tryPush(20));
+  Assert((popAll(buffer) == vector<int>{10, 20}));
+  Assert(popAll(buffer).empty());
+}
+
+void test_full() {
+  RingBuffer<int> buffer(4);
+  for (int i = 0; i < 4; ++i) {
+    Assert(buffer.tryPush(i));
+  }
+  Assert(!buffer.tryPush(4));
+  Assert((popAll(buffer) == vector<int>{0, 1, 2, 3}));
+  // There's space again after popping.
+  Assert(buffer.tryPush(5));
+  Assert((popAll(buffer) == vector<int>{5}));
+}
+
+void test_wrap_around() {
+  RingBuffer<int> buffer(4);
+  for (int i = 0; i < 10; ++i) {
+    Assert(buffer.tryPush(2 * i));
+    Assert(buffer.tryPush(2 * i + 1));
+    Assert((popAll(buffer) == vector<int>{2 * i, 2 * i + 1}));
+  }
+}
+
+void test_concurrent_producer_and_consumer() {
+  const int n = 100000;
+  RingBuffer<int> buffer(64);
+  std::thread producer([&buffer]() {
+    for (int i = 0; i < n; ++i) {
+      while (!buffer.tryPush(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  // The elements must be received in order, with none missing.
+  int next = 0;
+  while (next < n) {
+    buffer.popAll([&next](int x) {
+      Assert(x == next);
+      ++next;
+    });
+  }
+  producer.join();
+  Assert(popAll(buffer).empty());
+}
+
+int main() {
+  test_empty();
+  test_push_and_pop();
+  test_full();
+  test_wrap_around();
+  test_concurrent_producer_and_consumer();
+  
+  return 0;
+}
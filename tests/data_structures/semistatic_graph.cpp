@@ -20,6 +20,7 @@
 #include <fruit/impl/data_structures/semistatic_graph.templates.h>
 #include "../test_macros.h"
 
+#include <string>
 #include <vector>
 
 using namespace std;
@@ -47,7 +48,7 @@ struct SimpleNode {
 
 void test_empty() {
   vector<SimpleNode> values{};
-  Graph graph(values.begin(), values.end(), -1, -2);
+  Graph graph(values.begin(), values.end());
   Assert(graph.find(0) == graph.end());
   Assert(graph.find(2) == graph.end());
   Assert(graph.find(5) == graph.end());
@@ -60,7 +61,7 @@ void test_empty() {
 void test_1_node_no_edges() {
   vector<SimpleNode> values{{2, "foo", &no_neighbors, false}};
 
-  Graph graph(values.begin(), values.end(), -1, -2);
+  Graph graph(values.begin(), values.end());
   Assert(graph.find(0) == graph.end());
   Assert(!(graph.find(2) == graph.end()));
   Assert(graph.at(2).getNode() == string("foo"));
@@ -76,7 +77,7 @@ void test_1_node_no_edges() {
 
 void test_1_node_no_edges_terminal() {
   vector<SimpleNode> values{{2, "foo", &no_neighbors, true}};
-  Graph graph(values.begin(), values.end(), -1, -2);
+  Graph graph(values.begin(), values.end());
   Assert(graph.find(0) == graph.end());
   Assert(!(graph.find(2) == graph.end()));
   Assert(graph.at(2).getNode() == string("foo"));
@@ -93,15 +94,15 @@ void test_1_node_no_edges_terminal() {
 void test_1_node_self_edge() {
   vector<size_t> neighbors = {2};
   vector<SimpleNode> values{{2, "foo", &neighbors, false}};
-  Graph graph(values.begin(), values.end(), -1, -2);
+  Graph graph(values.begin(), values.end());
   Assert(graph.find(0) == graph.end());
   Assert(!(graph.find(2) == graph.end()));
   Assert(graph.at(2).getNode() == string("foo"));
   Assert(graph.at(2).isTerminal() == false);
   edge_iterator itr = graph.at(2).neighborsBegin();
   (void)itr;
-  Assert(itr.getNodeIterator(graph.begin()).getNode() == string("foo"));
-  Assert(itr.getNodeIterator(graph.begin()).isTerminal() == false);
+  Assert(itr.getNodeIterator(graph).getNode() == string("foo"));
+  Assert(itr.getNodeIterator(graph).isTerminal() == false);
   Assert(graph.find(5) == graph.end());
   const Graph& cgraph = graph;
   Assert(cgraph.find(0) == cgraph.end());
@@ -113,7 +114,7 @@ void test_1_node_self_edge() {
 void test_2_nodes_one_edge() {
   vector<size_t> neighbors = {2};
   vector<SimpleNode> values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}};
-  Graph graph(values.begin(), values.end(), -1, -2);
+  Graph graph(values.begin(), values.end());
   Assert(graph.find(0) == graph.end());
   Assert(!(graph.find(2) == graph.end()));
   Assert(graph.at(2).getNode() == string("foo"));
@@ -122,8 +123,8 @@ void test_2_nodes_one_edge() {
   Assert(graph.at(3).isTerminal() == false);
   edge_iterator itr = graph.at(3).neighborsBegin();
   (void)itr;
-  Assert(itr.getNodeIterator(graph.begin()).getNode() == string("foo"));
-  Assert(itr.getNodeIterator(graph.begin()).isTerminal() == false);
+  Assert(itr.getNodeIterator(graph).getNode() == string("foo"));
+  Assert(itr.getNodeIterator(graph).isTerminal() == false);
   Assert(graph.find(5) == graph.end());
   const Graph& cgraph = graph;
   Assert(cgraph.find(0) == cgraph.end());
@@ -137,7 +138,7 @@ void test_2_nodes_one_edge() {
 void test_3_nodes_two_edges() {
   vector<size_t> neighbors = {2, 4};
   vector<SimpleNode> values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}, {4, "baz", &no_neighbors, true}};
-  Graph graph(values.begin(), values.end(), -1, -2);
+  Graph graph(values.begin(), values.end());
   Assert(graph.find(0) == graph.end());
   Assert(!(graph.find(2) == graph.end()));
   Assert(graph.at(2).getNode() == string("foo"));
@@ -145,11 +146,11 @@ void test_3_nodes_two_edges() {
   Assert(graph.at(3).getNode() == string("bar"));
   Assert(graph.at(3).isTerminal() == false);
   edge_iterator itr = graph.at(3).neighborsBegin();
-  Assert(itr.getNodeIterator(graph.begin()).getNode() == string("foo"));
-  Assert(itr.getNodeIterator(graph.begin()).isTerminal() == false);
+  Assert(itr.getNodeIterator(graph).getNode() == string("foo"));
+  Assert(itr.getNodeIterator(graph).isTerminal() == false);
   ++itr;
-  Assert(itr.getNodeIterator(graph.begin()).getNode() == string("baz"));
-  Assert(itr.getNodeIterator(graph.begin()).isTerminal() == true);
+  Assert(itr.getNodeIterator(graph).getNode() == string("baz"));
+  Assert(itr.getNodeIterator(graph).isTerminal() == true);
   Assert(graph.at(4).getNode() == string("baz"));
   Assert(graph.at(4).isTerminal() == true);
   Assert(graph.find(5) == graph.end());
@@ -165,9 +166,66 @@ void test_3_nodes_two_edges() {
   Assert(cgraph.find(5) == cgraph.end());
 }
 
+void test_at_index() {
+  vector<size_t> neighbors = {2, 4};
+  vector<SimpleNode> values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}, {4, "baz", &no_neighbors, true}};
+  Graph graph(values.begin(), values.end());
+  for (int id : {2, 3, 4}) {
+    node_iterator itr = graph.atIndex(graph.at(id).getIndex());
+    Assert(itr == graph.at(id));
+    Assert(itr.getIndex() == graph.at(id).getIndex());
+  }
+  Assert(graph.atIndex(graph.at(3).getIndex()).getNode() == string("bar"));
+}
+
+void test_get_node_ids() {
+  vector<size_t> neighbors = {2, 5};
+  vector<SimpleNode> old_values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}};
+  Graph old_graph(old_values.begin(), old_values.end());
+  vector<SimpleNode> new_values{{4, "baz", &no_neighbors, true}};
+  Graph graph(old_graph, new_values.begin(), new_values.end());
+  vector<int> node_ids = graph.getNodeIds();
+  Assert(node_ids.size() == graph.size());
+  // Node 5 is only referenced by an edge, but it has an index too.
+  for (int id : {2, 3, 4, 5}) {
+    Assert(node_ids[graph.findIncludingReferencedNodes(id).getIndex()] == id);
+  }
+}
+
+void test_for_each_owned_node() {
+  vector<size_t> neighbors = {2, 5};
+  vector<size_t> one_neighbor = {3};
+  vector<SimpleNode> old_values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}};
+  Graph old_graph(old_values.begin(), old_values.end());
+  
+  vector<size_t> old_bytes_by_index(old_graph.size(), 100);
+  old_graph.forEachOwnedNode([&](size_t index, size_t num_bytes) {
+    old_bytes_by_index[index] = num_bytes;
+  });
+  // Node 5 is only referenced by an edge, so it has no data.
+  Assert(old_bytes_by_index[old_graph.findIncludingReferencedNodes(5).getIndex()] == 100);
+  size_t node_bytes = old_bytes_by_index[old_graph.at(2).getIndex()];
+  Assert(old_bytes_by_index[old_graph.at(3).getIndex()] > node_bytes);
+  size_t edge_bytes = (old_bytes_by_index[old_graph.at(3).getIndex()] - node_bytes) / 2;
+  Assert(old_bytes_by_index[old_graph.at(3).getIndex()] == node_bytes + 2 * edge_bytes);
+  Assert(old_graph.getAllocatedBytes() >= 2 * node_bytes + 2 * edge_bytes);
+  
+  // The new graph only owns the page with the new node (that also contains the old nodes, copied) and the new edge.
+  vector<SimpleNode> new_values{{4, "baz", &one_neighbor, false}};
+  Graph graph(old_graph, new_values.begin(), new_values.end());
+  vector<size_t> bytes_by_index(graph.size(), 0);
+  graph.forEachOwnedNode([&](size_t index, size_t num_bytes) {
+    bytes_by_index[index] = num_bytes;
+  });
+  Assert(bytes_by_index[graph.at(2).getIndex()] == node_bytes);
+  // The edges of this node are stored in old_graph.
+  Assert(bytes_by_index[graph.at(3).getIndex()] == node_bytes);
+  Assert(bytes_by_index[graph.at(4).getIndex()] == node_bytes + edge_bytes);
+}
+
 void test_add_node() {
   vector<SimpleNode> old_values{{2, "foo", &no_neighbors, false}, {4, "baz", &no_neighbors, true}};
-  Graph old_graph(old_values.begin(), old_values.end(), -1, -2);
+  Graph old_graph(old_values.begin(), old_values.end());
   vector<size_t> neighbors = {2, 4};
   vector<SimpleNode> new_values{{3, "bar", &neighbors, false}};
   Graph graph(old_graph, new_values.begin(), new_values.end());
@@ -178,11 +236,11 @@ void test_add_node() {
   Assert(graph.at(3).getNode() == string("bar"));
   Assert(graph.at(3).isTerminal() == false);
   edge_iterator itr = graph.at(3).neighborsBegin();
-  Assert(itr.getNodeIterator(graph.begin()).getNode() == string("foo"));
-  Assert(itr.getNodeIterator(graph.begin()).isTerminal() == false);
+  Assert(itr.getNodeIterator(graph).getNode() == string("foo"));
+  Assert(itr.getNodeIterator(graph).isTerminal() == false);
   ++itr;
-  Assert(itr.getNodeIterator(graph.begin()).getNode() == string("baz"));
-  Assert(itr.getNodeIterator(graph.begin()).isTerminal() == true);
+  Assert(itr.getNodeIterator(graph).getNode() == string("baz"));
+  Assert(itr.getNodeIterator(graph).isTerminal() == true);
   Assert(graph.at(4).getNode() == string("baz"));
   Assert(graph.at(4).isTerminal() == true);
   Assert(graph.find(5) == graph.end());
@@ -198,33 +256,140 @@ void test_add_node() {
   Assert(cgraph.find(5) == cgraph.end());
 }
 
-void test_set_terminal() {
+void test_replace_node() {
   vector<size_t> neighbors = {2, 4};
-  vector<SimpleNode> values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}, {4, "baz", &no_neighbors, true}};
-  Graph graph(values.begin(), values.end(), -1, -2);
-  graph.find(3).setTerminal();
-  Assert(graph.find(0) == graph.end());
-  Assert(!(graph.find(2) == graph.end()));
+  vector<SimpleNode> old_values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}, {4, "baz", &no_neighbors, true}};
+  Graph old_graph(old_values.begin(), old_values.end());
+  vector<size_t> new_neighbors = {5};
+  vector<SimpleNode> new_values{{3, "qux", &new_neighbors, false}, {5, "quux", &no_neighbors, true}};
+  Graph graph(old_graph, new_values.begin(), new_values.end());
+  Assert(graph.at(2).getNode() == string("foo"));
+  Assert(graph.at(3).getNode() == string("qux"));
+  Assert(graph.at(3).isTerminal() == false);
+  Assert(graph.at(3).getIndex() == old_graph.at(3).getIndex());
+  edge_iterator itr = graph.at(3).neighborsBegin();
+  Assert(itr.getNodeIterator(graph).getNode() == string("quux"));
+  Assert(itr.getNodeIterator(graph).isTerminal() == true);
+  Assert(graph.at(4).getNode() == string("baz"));
+  Assert(graph.at(5).getNode() == string("quux"));
+  // The old graph is unchanged.
+  Assert(old_graph.at(3).getNode() == string("bar"));
+  itr = old_graph.at(3).neighborsBegin();
+  Assert(itr.getNodeIterator(old_graph).getNode() == string("foo"));
+  ++itr;
+  Assert(itr.getNodeIterator(old_graph).getNode() == string("baz"));
+  Assert(old_graph.find(5) == old_graph.end());
+}
+
+void test_terminal_nodes_by_index() {
+  vector<size_t> neighbors = {2, 4};
+  vector<SimpleNode> old_values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}};
+  Graph old_graph(old_values.begin(), old_values.end());
+  // Node 4 is only referenced by an edge in old_graph.
+  Assert(old_graph.find(4) == old_graph.end());
+  Assert(!(old_graph.findIncludingReferencedNodes(4) == old_graph.end()));
+  Assert(old_graph.findIncludingReferencedNodes(5) == old_graph.end());
+  vector<pair<size_t, const char*>> terminal_nodes{{old_graph.findIncludingReferencedNodes(4).getIndex(), "baz"}};
+  Graph graph(old_graph, terminal_nodes.data(), terminal_nodes.size());
+  Assert(graph.size() == old_graph.size());
   Assert(graph.at(2).getNode() == string("foo"));
-  Assert(graph.at(2).isTerminal() == false);
-  Assert(graph.at(3).getNode() == string("bar"));
-  Assert(graph.at(3).isTerminal() == true);
   Assert(graph.at(4).getNode() == string("baz"));
   Assert(graph.at(4).isTerminal() == true);
+  edge_iterator itr = graph.at(3).neighborsBegin();
+  ++itr;
+  Assert(itr.getNodeIterator(graph).getNode() == string("baz"));
+  // The old graph is unchanged.
+  itr = old_graph.at(3).neighborsBegin();
+  ++itr;
+  Assert(itr.getNodeIterator(old_graph).getIndex() == graph.at(4).getIndex());
+  Assert(old_graph.at(2).getNode() == string("foo"));
+  graph.setTerminalNodeValue(graph.at(4).getIndex(), "qux");
+  Assert(graph.at(4).getNode() == string("qux"));
+  Assert(graph.at(4).isTerminal() == true);
+}
+
+void test_extensions_with_no_new_node_ids() {
+  vector<size_t> neighbors = {2, 4};
+  vector<SimpleNode> old_values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}};
+  Graph old_graph(old_values.begin(), old_values.end());
+  // These graphs don't add any NodeId, so they look up NodeIds in the map of old_graph.
+  vector<SimpleNode> new_values{{2, "qux", &no_neighbors, true}};
+  Graph graph1(old_graph, new_values.begin(), new_values.end());
+  vector<pair<size_t, const char*>> terminal_nodes{{old_graph.findIncludingReferencedNodes(4).getIndex(), "baz"}};
+  Graph graph2(graph1, terminal_nodes.data(), terminal_nodes.size());
+  // Moving the graphs doesn't affect the lookups.
+  Graph graph = std::move(graph2);
+  Assert(graph.size() == old_graph.size());
+  Assert(graph.at(2).getNode() == string("qux"));
+  Assert(graph.at(3).getNode() == string("bar"));
+  Assert(graph.at(4).getNode() == string("baz"));
   Assert(graph.find(5) == graph.end());
-  const Graph& cgraph = graph;
-  Assert(cgraph.find(0) == cgraph.end());
-  Assert(!(cgraph.find(2) == cgraph.end()));
-  Assert(cgraph.find(2).getNode() == string("foo"));
-  Assert(cgraph.find(3).getNode() == string("bar"));
-  Assert(cgraph.find(4).getNode() == string("baz"));
-  Assert(cgraph.find(5) == cgraph.end());
+  Assert(graph1.at(2).getNode() == string("qux"));
+  Assert(graph1.find(4) == graph1.end());
+  Assert(graph.getNodeIds() == old_graph.getNodeIds());
+  // A graph that extends these with a new NodeId.
+  vector<size_t> one_neighbor = {4};
+  vector<SimpleNode> newer_values{{5, "quux", &one_neighbor, false}};
+  Graph graph3(graph, newer_values.begin(), newer_values.end());
+  Assert(graph3.at(2).getNode() == string("qux"));
+  Assert(graph3.at(4).getNode() == string("baz"));
+  Assert(graph3.at(5).getNode() == string("quux"));
+  Assert(graph3.at(5).neighborsBegin().getNodeIterator(graph3).getNode() == string("baz"));
+  Assert(graph.find(5) == graph.end());
+}
+
+void test_add_node_many_pages() {
+  vector<vector<size_t>> neighbors(200);
+  vector<string> names;
+  for (size_t i = 0; i < 200; ++i) {
+    names.push_back(std::to_string(i));
+  }
+  vector<SimpleNode> old_values;
+  for (size_t i = 0; i < 150; ++i) {
+    if (i != 0) {
+      neighbors[i].push_back(i - 1);
+    }
+    old_values.push_back(SimpleNode{i, names[i].c_str(), &neighbors[i], i == 0});
+  }
+  Graph old_graph(old_values.begin(), old_values.end());
+  vector<SimpleNode> new_values;
+  for (size_t i = 150; i < 200; ++i) {
+    neighbors[i].push_back(i - 1);
+    new_values.push_back(SimpleNode{i, names[i].c_str(), &neighbors[i], false});
+  }
+  // Also replace a node in the first page.
+  new_values.push_back(SimpleNode{10, "ten", &no_neighbors, true});
+  Graph graph(old_graph, new_values.begin(), new_values.end());
+  Assert(old_graph.size() == 150);
+  Assert(graph.size() == 200);
+  vector<bool> used_indexes(graph.size());
+  for (size_t i = 0; i < 200; ++i) {
+    Graph::node_iterator node_itr = graph.at(i);
+    Assert(node_itr.getIndex() < graph.size());
+    Assert(!used_indexes[node_itr.getIndex()]);
+    used_indexes[node_itr.getIndex()] = true;
+    if (i == 10) {
+      Assert(node_itr.getNode() == string("ten"));
+      Assert(node_itr.isTerminal());
+    } else {
+      Assert(node_itr.getNode() == names[i]);
+      Assert(node_itr.isTerminal() == (i == 0));
+    }
+    if (!node_itr.isTerminal()) {
+      Assert(node_itr.neighborsBegin().getNodeIterator(graph) == graph.at(i - 1));
+    }
+  }
+  for (size_t i = 0; i < 150; ++i) {
+    Assert(old_graph.at(i).getNode() == names[i]);
+    Assert(old_graph.at(i).getIndex() == graph.at(i).getIndex());
+  }
+  Assert(old_graph.find(150) == old_graph.end());
 }
 
 void test_move_constructor() {
   vector<size_t> neighbors = {2};
   vector<SimpleNode> values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}};
-  Graph graph1(values.begin(), values.end(), -1, -2);
+  Graph graph1(values.begin(), values.end());
   Graph graph = std::move(graph1);
   Assert(graph.find(0) == graph.end());
   Assert(!(graph.find(2) == graph.end()));
@@ -234,15 +399,15 @@ void test_move_constructor() {
   Assert(graph.at(3).isTerminal() == false);
   edge_iterator itr = graph.at(3).neighborsBegin();
   (void)itr;
-  Assert(itr.getNodeIterator(graph.begin()).getNode() == string("foo"));
-  Assert(itr.getNodeIterator(graph.begin()).isTerminal() == false);
+  Assert(itr.getNodeIterator(graph).getNode() == string("foo"));
+  Assert(itr.getNodeIterator(graph).isTerminal() == false);
   Assert(graph.find(5) == graph.end());
 }
 
 void test_move_assignment() {
   vector<size_t> neighbors = {2};
   vector<SimpleNode> values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false}};
-  Graph graph1(values.begin(), values.end(), -1, -2);
+  Graph graph1(values.begin(), values.end());
   Graph graph;
   graph = std::move(graph1);
   Assert(graph.find(0) == graph.end());
@@ -253,8 +418,8 @@ void test_move_assignment() {
   Assert(graph.at(3).isTerminal() == false);
   edge_iterator itr = graph.at(3).neighborsBegin();
   (void)itr;
-  Assert(itr.getNodeIterator(graph.begin()).getNode() == string("foo"));
-  Assert(itr.getNodeIterator(graph.begin()).isTerminal() == false);
+  Assert(itr.getNodeIterator(graph).getNode() == string("foo"));
+  Assert(itr.getNodeIterator(graph).isTerminal() == false);
   Assert(graph.find(5) == graph.end());
 }
 
@@ -262,7 +427,7 @@ void test_incomplete_graph() {
   vector<size_t> neighbors = {2};
   vector<SimpleNode> values{{1, "foo", &neighbors, false}};
 
-  Graph graph(values.begin(), values.end(), -1, -2);
+  Graph graph(values.begin(), values.end());
   Assert(!(graph.find(1) == graph.end()));
   Assert(graph.at(1).getNode() == string("foo"));
   Assert(graph.at(1).isTerminal() == false);
@@ -274,6 +439,28 @@ void test_incomplete_graph() {
   Assert(cgraph.find(2) == cgraph.end());
 }
 
+void test_dfs_post_order() {
+  vector<size_t> neighbors_5 = {3, 4};
+  vector<size_t> neighbors_3_4 = {2};
+  vector<SimpleNode> values{{6, "qux", &no_neighbors, false},
+                            {2, "foo", &no_neighbors, false},
+                            {3, "bar", &neighbors_3_4, false},
+                            {4, "baz", &neighbors_3_4, false},
+                            {5, "root", &neighbors_5, false}};
+  // 7 is not a node, so it's ignored.
+  vector<int> roots = {7, 5};
+  Graph graph(values.begin(), values.end(), roots);
+  Assert(graph.size() == 5);
+  // Dependencies come before the nodes that depend on them.
+  Assert(graph.at(2).getIndex() < graph.at(3).getIndex());
+  Assert(graph.at(2).getIndex() < graph.at(4).getIndex());
+  Assert(graph.at(3).getIndex() < graph.at(5).getIndex());
+  Assert(graph.at(4).getIndex() < graph.at(5).getIndex());
+  // Nodes not reachable from the roots come last.
+  Assert(graph.at(5).getIndex() < graph.at(6).getIndex());
+  Assert(graph.at(6).getNode() == string("qux"));
+}
+
 int main() {
   
   test_empty();
@@ -282,11 +469,18 @@ int main() {
   test_1_node_self_edge();
   test_2_nodes_one_edge();
   test_3_nodes_two_edges();
+  test_at_index();
+  test_get_node_ids();
+  test_for_each_owned_node();
   test_add_node();
-  test_set_terminal();
+  test_replace_node();
+  test_terminal_nodes_by_index();
+  test_extensions_with_no_new_node_ids();
+  test_add_node_many_pages();
   test_move_constructor();
   test_move_assignment();
   test_incomplete_graph();
+  test_dfs_post_order();
   
   return 0;
 }
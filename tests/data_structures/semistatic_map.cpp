@@ -21,10 +21,58 @@
 #include "../test_macros.h"
 
 #include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstring>
 
 using namespace std;
 using namespace fruit::impl;
 
+// A key type where all keys have the same hash, so no hash function can keep the buckets small.
+template <typename T>
+struct CollidingKey {
+  T x;
+  
+  bool operator==(const CollidingKey& other) const {
+    return x == other.x;
+  }
+};
+
+// A 64-bit key with padding bytes, that operator== ignores. All keys have the same hash.
+struct PaddedKey {
+  std::int32_t x;
+  char c;
+  
+  bool operator==(const PaddedKey& other) const {
+    return x == other.x && c == other.c;
+  }
+};
+
+namespace std {
+template <typename T>
+struct hash<CollidingKey<T>> {
+  size_t operator()(const CollidingKey<T>&) const {
+    return 42;
+  }
+};
+
+template <>
+struct hash<PaddedKey> {
+  size_t operator()(const PaddedKey&) const {
+    return 42;
+  }
+};
+}
+
+PaddedKey makePaddedKey(int x, unsigned char padding) {
+  PaddedKey key;
+  std::memset(&key, padding, sizeof(key));
+  key.x = x;
+  key.c = 'a';
+  return key;
+}
+
 void test_empty() {
   vector<pair<int, std::string>> values{};
   SemistaticMap<int, std::string> map(values.begin(), values.size());
@@ -104,6 +152,40 @@ void test_3_elem_3_inserted() {
   Assert(map.at(16) == "16");
 }
 
+void test_inserted_elems_not_in_old_map() {
+  vector<pair<int, std::string>> values{{1, "1"}, {3, "3"}, {5, "5"}};
+  SemistaticMap<int, std::string> old_map(values.begin(), values.size());
+  vector<pair<int, std::string>> new_values{{2, "2"}, {4, "4"}, {16, "16"}};
+  SemistaticMap<int, std::string> map(old_map, std::move(new_values));
+  Assert(old_map.find(1) != nullptr);
+  Assert(old_map.at(1) == "1");
+  Assert(old_map.find(2) == nullptr);
+  Assert(old_map.find(4) == nullptr);
+  Assert(old_map.find(16) == nullptr);
+  Assert(map.find(2) != nullptr);
+}
+
+void test_elems_inserted_twice() {
+  vector<pair<int, std::string>> values{{1, "1"}, {3, "3"}};
+  SemistaticMap<int, std::string> old_map(values.begin(), values.size());
+  std::unique_ptr<SemistaticMap<int, std::string>> middle_map(
+      new SemistaticMap<int, std::string>(old_map, vector<pair<int, std::string>>{{2, "2"}, {4, "4"}}));
+  SemistaticMap<int, std::string> map(*middle_map, vector<pair<int, std::string>>{{5, "5"}});
+  // `map' extends old_map directly, so it doesn't depend on middle_map.
+  middle_map.reset();
+  for (int i = 1; i <= 5; ++i) {
+    Assert(map.find(i) != nullptr);
+    Assert(map.at(i) == std::to_string(i));
+  }
+  Assert(map.find(0) == nullptr);
+  Assert(map.find(6) == nullptr);
+  std::size_t num_elements = 0;
+  map.forEachElement([&num_elements](int, const std::string&) {
+    ++num_elements;
+  });
+  Assert(num_elements == 5);
+}
+
 void test_move_constructor() {
   vector<pair<int, std::string>> values{{1, "foo"}, {3, "bar"}, {4, "baz"}};
   SemistaticMap<int, std::string> map1(values.begin(), values.size());
@@ -135,6 +217,115 @@ void test_move_assignment() {
   Assert(map.find(5) == nullptr);
 }
 
+void test_many_elems_constructed_twice() {
+  vector<pair<int, std::string>> values;
+  for (int i = 0; i < 10000; ++i) {
+    values.emplace_back(i * 7, "foo");
+  }
+  SemistaticMap<int, std::string> map1(values.begin(), values.size());
+  SemistaticMap<int, std::string> map2(values.begin(), values.size());
+  for (int i = 0; i < 10000; ++i) {
+    Assert(map1.find(i * 7) != nullptr);
+    Assert(map2.find(i * 7) != nullptr);
+    Assert(map2.find(i * 7 + 1) == nullptr);
+  }
+}
+
+void test_all_sizes_up_to_40() {
+  for (int n = 0; n <= 40; ++n) {
+    vector<pair<int, std::string>> values;
+    for (int i = 0; i < n; ++i) {
+      values.emplace_back(i * 3, std::to_string(i));
+    }
+    SemistaticMap<int, std::string> map(values.begin(), values.size());
+    for (int i = 0; i < n; ++i) {
+      Assert(map.find(i * 3) != nullptr);
+      Assert(map.at(i * 3) == std::to_string(i));
+      Assert(map.find(i * 3 + 1) == nullptr);
+    }
+    Assert(map.find(n * 3) == nullptr);
+  }
+}
+
+std::vector<int> getKeysInIterationOrder(const SemistaticMap<int, std::string>& map) {
+  std::vector<int> keys;
+  map.forEachElement([&keys](int key, const std::string&) {
+    keys.push_back(key);
+  });
+  return keys;
+}
+
+void test_layout_independent_of_other_maps() {
+  vector<pair<int, std::string>> values1;
+  vector<pair<int, std::string>> values2;
+  for (int i = 0; i < 1000; ++i) {
+    values1.emplace_back(i * 7, "foo");
+    values2.emplace_back(i * 13 + 5, "bar");
+  }
+  // The iteration order depends on the hash functions used by the map. map2 uses a different hash function (the hint),
+  // and that must not affect map3.
+  SemistaticMap<int, std::string> map1(values1.begin(), values1.size());
+  SemistaticMap<int, std::string> map2(values2.begin(), values2.size(), std::uintptr_t(0x9e3779b97f4a7c15ULL));
+  SemistaticMap<int, std::string> map3(values1.begin(), values1.size());
+  Assert(getKeysInIterationOrder(map1) == getKeysInIterationOrder(map3));
+}
+
+void test_extensions_of_all_sizes_up_to_40() {
+  vector<pair<int, std::string>> base_values;
+  for (int i = 0; i < 100; ++i) {
+    base_values.emplace_back(-i - 1, std::to_string(-i - 1));
+  }
+  SemistaticMap<int, std::string> base_map(base_values.begin(), base_values.size());
+  for (int n = 0; n <= 40; ++n) {
+    vector<pair<int, std::string>> values;
+    for (int i = 0; i < n; ++i) {
+      values.emplace_back(i * 3, std::to_string(i));
+    }
+    SemistaticMap<int, std::string> map(base_map, std::move(values));
+    for (int i = 0; i < n; ++i) {
+      Assert(map.find(i * 3) != nullptr);
+      Assert(map.at(i * 3) == std::to_string(i));
+      Assert(map.find(i * 3 + 1) == nullptr);
+    }
+    Assert(map.find(n * 3) == nullptr);
+    Assert(map.at(-1) == "-1");
+    Assert(map.at(-100) == "-100");
+    Assert(map.find(-101) == nullptr);
+  }
+}
+
+// With few keys, this also checks the fallback when the keys can't be put in a single bucket.
+template <typename T>
+void test_colliding_keys(int num_keys) {
+  using Key = CollidingKey<T>;
+  vector<pair<Key, int>> values;
+  for (int i = 0; i < num_keys; ++i) {
+    values.emplace_back(Key{T(i)}, i);
+  }
+  SemistaticMap<Key, int> map(values.begin(), values.size());
+  for (int i = 0; i < num_keys; ++i) {
+    Assert(map.find(Key{T(i)}) != nullptr);
+    Assert(map.at(Key{T(i)}) == i);
+  }
+  Assert(map.find(Key{T(num_keys)}) == nullptr);
+  Assert(map.find(Key{T(-1)}) == nullptr);
+}
+
+void test_keys_with_padding() {
+  static_assert(sizeof(PaddedKey) == 8, "");
+  vector<pair<PaddedKey, int>> values;
+  for (int i = 0; i < 20; ++i) {
+    values.emplace_back(makePaddedKey(i, 0xFF), i);
+  }
+  SemistaticMap<PaddedKey, int> map(values.begin(), values.size());
+  for (int i = 0; i < 20; ++i) {
+    // The keys compare equal even if their padding bytes differ.
+    Assert(map.find(makePaddedKey(i, 0)) != nullptr);
+    Assert(map.at(makePaddedKey(i, 0)) == i);
+  }
+  Assert(map.find(makePaddedKey(20, 0xFF)) == nullptr);
+}
+
 int main() {
   
   test_empty();
@@ -143,8 +334,19 @@ int main() {
   test_3_elem();
   test_1_elem_2_inserted();
   test_3_elem_3_inserted();
+  test_inserted_elems_not_in_old_map();
+  test_elems_inserted_twice();
   test_move_constructor();
   test_move_assignment();
+  test_many_elems_constructed_twice();
+  test_layout_independent_of_other_maps();
+  test_all_sizes_up_to_40();
+  test_extensions_of_all_sizes_up_to_40();
+  test_colliding_keys<int>(20);
+  test_colliding_keys<int>(5);
+  test_colliding_keys<std::int64_t>(20);
+  test_colliding_keys<std::int64_t>(5);
+  test_keys_with_padding();
   
   return 0;
 }
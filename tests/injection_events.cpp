@@ -0,0 +1,177 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fruit/fruit.h>
+#include "test_macros.h"
+
+#if FRUIT_ENABLE_INJECTION_EVENTS
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using Kind = fruit::InjectionEvent::Kind;
+
+struct X {
+  INJECT(X()) = default;
+  
+  // Objects with a trivial destructor have no DESTRUCTION event.
+  ~X() {
+  }
+};
+
+struct Y {
+  INJECT(Y(X*)) {
+  }
+  
+  ~Y() {
+  }
+};
+
+struct Listener {
+  INJECT(Listener()) = default;
+};
+
+fruit::Component<Y> getComponent() {
+  return fruit::createComponent()
+    .addMultibinding<Listener, Listener>();
+}
+
+fruit::Component<X> getXComponent() {
+  return fruit::createComponent();
+}
+
+// Injects X when destroyed. If this is constructed before the thread records its first event, it's destroyed after the
+// thread's buffer is released.
+struct InjectXOnThreadExit {
+  ~InjectXOnThreadExit() {
+    fruit::Injector<X> injector(getXComponent());
+    injector.get<X*>();
+  }
+};
+
+std::vector<fruit::InjectionEvent> drain() {
+  std::vector<fruit::InjectionEvent> events;
+  std::size_t n = fruit::drainInjectionEvents(events);
+  Assert(n == events.size());
+  return events;
+}
+
+void checkEvent(const fruit::InjectionEvent& event, Kind kind, const std::string& type_name) {
+  Assert(event.kind == kind);
+  Assert(event.getTypeName() == type_name);
+}
+
+int main() {
+  {
+    const void* x;
+    const void* y;
+    {
+      fruit::Injector<Y> injector(getComponent());
+      y = injector.get<Y*>();
+      
+      std::vector<fruit::InjectionEvent> events = drain();
+      Assert(events.size() == 4);
+      // X is constructed while constructing Y.
+      checkEvent(events[0], Kind::CONSTRUCTION_BEGIN, "Y");
+      checkEvent(events[1], Kind::CONSTRUCTION_BEGIN, "X");
+      checkEvent(events[2], Kind::CONSTRUCTION_END, "X");
+      checkEvent(events[3], Kind::CONSTRUCTION_END, "Y");
+      Assert(events[0].object == nullptr);
+      Assert(events[2].object != nullptr);
+      Assert(events[3].object == y);
+      x = events[2].object;
+      for (std::size_t i = 0; i < events.size(); ++i) {
+        Assert(events[i].thread_index == events[0].thread_index);
+        Assert(i == 0 || events[i].timestamp_ns >= events[i - 1].timestamp_ns);
+      }
+      
+      // Nothing is recorded twice.
+      injector.get<Y*>();
+      Assert(drain().empty());
+      
+      injector.getMultibindings<Listener>();
+      events = drain();
+      Assert(events.size() >= 3);
+      checkEvent(events.front(), Kind::CONSTRUCTION_BEGIN, "Listener");
+      checkEvent(events.back(), Kind::MULTIBINDINGS_CONSTRUCTED, "Listener");
+    }
+    
+    // Objects are destroyed in reverse order of construction.
+    std::vector<fruit::InjectionEvent> events = drain();
+    Assert(events.size() == 2);
+    Assert(events[0].kind == Kind::DESTRUCTION);
+    Assert(events[0].object == y);
+    Assert(events[0].getTypeName() == "");
+    Assert(events[1].kind == Kind::DESTRUCTION);
+    Assert(events[1].object == x);
+  }
+  
+  {
+    // Each thread records events in its own buffer, and they can be drained after the thread exits.
+    std::thread thread([]() {
+      fruit::Injector<X> injector(getXComponent());
+      injector.get<X*>();
+    });
+    thread.join();
+    
+    std::vector<fruit::InjectionEvent> events = drain();
+    Assert(events.size() == 3);
+    checkEvent(events[0], Kind::CONSTRUCTION_BEGIN, "X");
+    checkEvent(events[1], Kind::CONSTRUCTION_END, "X");
+    Assert(events[2].kind == Kind::DESTRUCTION);
+    Assert(events[0].thread_index != 0);
+  }
+  
+  {
+    // When the buffer is full, new events are dropped.
+    Assert(fruit::getNumDroppedInjectionEvents() == 0);
+    std::size_t num_events = 0;
+    for (int i = 0; i < 2000; ++i) {
+      fruit::Injector<X> injector(getXComponent());
+      injector.get<X*>();
+      num_events += 3;
+    }
+    std::size_t num_drained_events = drain().size();
+    Assert(num_drained_events < num_events);
+    Assert(num_drained_events + fruit::getNumDroppedInjectionEvents() == num_events);
+  }
+  
+  {
+    // Events recorded after the thread's buffer is released are dropped.
+    std::uint64_t num_dropped_events = fruit::getNumDroppedInjectionEvents();
+    std::thread thread([]() {
+      static thread_local InjectXOnThreadExit inject_x_on_thread_exit;
+      (void) inject_x_on_thread_exit;
+      fruit::Injector<X> injector(getXComponent());
+      injector.get<X*>();
+    });
+    thread.join();
+    
+    Assert(drain().size() == 3);
+    Assert(fruit::getNumDroppedInjectionEvents() == num_dropped_events + 3);
+  }
+  
+  return 0;
+}
+
+#else // !FRUIT_ENABLE_INJECTION_EVENTS
+
+int main() {
+  return 0;
+}
+
+#endif // FRUIT_ENABLE_INJECTION_EVENTS
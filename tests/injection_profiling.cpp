@@ -0,0 +1,218 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fruit/fruit.h>
+#include "test_macros.h"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+void sleepMs(int ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+const std::uint64_t MS = 1000 * 1000;
+
+// C depends on A and B, and A is much slower than B. So the critical path is A, C.
+// The sleeps are far apart so that the order of the types doesn't depend on the load of the machine; the tests below
+// only check lower bounds on the measured times.
+
+struct A {
+  INJECT(A()) {
+    sleepMs(200);
+  }
+
+  char data[100];
+};
+
+struct B {
+  INJECT(B()) {
+    sleepMs(10);
+  }
+};
+
+struct C {
+  INJECT(C(A*, B*)) {
+    sleepMs(100);
+  }
+};
+
+struct Listener {
+  INJECT(Listener(C*)) {
+  }
+};
+
+fruit::Component<C> getComponent() {
+  return fruit::createComponent()
+    .addMultibinding<Listener, Listener>();
+}
+
+fruit::Component<A, C> getComponentWithA() {
+  return fruit::createComponent()
+    .install(getComponent());
+}
+
+const fruit::InjectionProfile::Entry& getEntry(const fruit::InjectionProfile& profile, const std::string& type_name) {
+  for (const fruit::InjectionProfile::Entry& entry : profile.entries) {
+    if (entry.type_name == type_name) {
+      return entry;
+    }
+  }
+  Assert(false);
+  return profile.entries[0];
+}
+
+fruit::InjectionProfile::Entry makeEntry(const std::string& type_name, std::uint64_t self_ns) {
+  fruit::InjectionProfile::Entry entry;
+  entry.type_name = type_name;
+  entry.is_multibinding = false;
+  entry.start_ns = 0;
+  entry.total_ns = self_ns;
+  entry.self_ns = self_ns;
+  entry.allocated_bytes = 0;
+  entry.thread_index = 0;
+  return entry;
+}
+
+void test_slowest_types() {
+  fruit::InjectionProfile profile;
+  profile.entries.push_back(makeEntry("X", 30));
+  profile.entries.push_back(makeEntry("Y", 50));
+  profile.entries.push_back(makeEntry("X", 30));
+  profile.entries.push_back(makeEntry("W", 10));
+  profile.entries.push_back(makeEntry("Z", 50));
+
+  // The self times of the entries of each type are summed, and ties are broken by name.
+  std::vector<std::pair<std::string, std::uint64_t>> slowest_types = profile.getSlowestTypes(3);
+  Assert(slowest_types.size() == 3);
+  Assert(slowest_types[0] == std::make_pair(std::string("X"), std::uint64_t(60)));
+  Assert(slowest_types[1] == std::make_pair(std::string("Y"), std::uint64_t(50)));
+  Assert(slowest_types[2] == std::make_pair(std::string("Z"), std::uint64_t(50)));
+
+  slowest_types = profile.getSlowestTypes(10);
+  Assert(slowest_types.size() == 4);
+  Assert(slowest_types[3] == std::make_pair(std::string("W"), std::uint64_t(10)));
+
+  Assert(profile.getSlowestTypes(0).empty());
+  Assert(fruit::InjectionProfile().getSlowestTypes(10).empty());
+}
+
+void test_chrome_trace() {
+  fruit::InjectionProfile profile;
+  profile.entries.push_back(makeEntry("X", 1500));
+  profile.entries.push_back(makeEntry("Y\"", 2000));
+  profile.entries[1].is_multibinding = true;
+  profile.critical_path.push_back(1);
+
+  std::ostringstream trace;
+  profile.writeChromeTrace(trace);
+  std::string trace_str = trace.str();
+  Assert(trace_str.find("\"traceEvents\"") != std::string::npos);
+  Assert(trace_str.find("\"name\":\"X\",\"cat\":\"binding\"") != std::string::npos);
+  Assert(trace_str.find("\"name\":\"Y\\\"\",\"cat\":\"multibinding\"") != std::string::npos);
+  Assert(trace_str.find("\"dur\":1.500") != std::string::npos);
+  Assert(trace_str.find("\"on_critical_path\":true") != std::string::npos);
+  Assert(trace_str.find("\"on_critical_path\":false") < trace_str.find("\"on_critical_path\":true"));
+}
+
+int main() {
+  test_slowest_types();
+  test_chrome_trace();
+
+  {
+    fruit::Injector<C> injector(getComponent());
+    injector.enableProfiling();
+    injector.eagerlyInjectAll();
+
+    fruit::InjectionProfile profile = injector.getProfile();
+    // The multibinding constructs a Listener, and then adds it to the multibindings.
+    Assert(profile.entries.size() == 5);
+
+    const fruit::InjectionProfile::Entry& a = getEntry(profile, "A");
+    Assert(!a.is_multibinding);
+    Assert(a.self_ns >= 200 * MS);
+    Assert(a.allocated_bytes >= sizeof(A));
+    Assert(a.thread_index == 0);
+
+    const fruit::InjectionProfile::Entry& c = getEntry(profile, "C");
+    const fruit::InjectionProfile::Entry& b = getEntry(profile, "B");
+    Assert(c.self_ns >= 100 * MS);
+    // eagerlyInjectAll() constructs A and B before C, so they aren't nested in C's construction.
+    Assert(c.self_ns == c.total_ns);
+    Assert(c.start_ns >= a.start_ns + a.total_ns);
+    Assert(c.start_ns >= b.start_ns + b.total_ns);
+
+    Assert(!getEntry(profile, "Listener").is_multibinding);
+    Assert(profile.entries[4].type_name == "Listener");
+    Assert(profile.entries[4].is_multibinding);
+
+    std::vector<std::pair<std::string, std::uint64_t>> slowest_types = profile.getSlowestTypes(1);
+    Assert(slowest_types.size() == 1);
+    Assert(slowest_types[0].first == "A");
+    Assert(profile.getSlowestTypes(10).size() == 4);
+
+    Assert(profile.critical_path.size() == 2);
+    Assert(profile.entries[profile.critical_path[0]].type_name == "A");
+    Assert(profile.entries[profile.critical_path[1]].type_name == "C");
+    Assert(profile.critical_path_ns == a.self_ns + c.self_ns);
+
+    std::ostringstream trace;
+    profile.writeChromeTrace(trace);
+    std::string trace_str = trace.str();
+    Assert(trace_str.find("\"traceEvents\"") != std::string::npos);
+    Assert(trace_str.find("\"name\":\"A\"") != std::string::npos);
+    Assert(trace_str.find("\"cat\":\"multibinding\"") != std::string::npos);
+  }
+
+  {
+    // With lazy injection, A and B are constructed while constructing C, so their time is excluded from C's self time.
+    fruit::Injector<C> injector(getComponent());
+    injector.enableProfiling();
+    injector.get<C*>();
+
+    fruit::InjectionProfile profile = injector.getProfile();
+    Assert(profile.entries.size() == 3);
+    // Nested constructions end first.
+    Assert(profile.entries[2].type_name == "C");
+    const fruit::InjectionProfile::Entry& c = profile.entries[2];
+    Assert(c.total_ns >= 310 * MS);
+    Assert(c.self_ns >= 100 * MS);
+    Assert(c.self_ns == c.total_ns - getEntry(profile, "A").total_ns - getEntry(profile, "B").total_ns);
+    Assert(c.allocated_bytes < sizeof(A));
+  }
+
+  {
+    // Constructions in other threads are numbered.
+    fruit::Injector<A, C> injector(getComponentWithA());
+    injector.enableConcurrentInjection();
+    injector.enableProfiling();
+    std::thread thread([&injector]() {
+      injector.get<A*>();
+    });
+    thread.join();
+    injector.get<C*>();
+
+    fruit::InjectionProfile profile = injector.getProfile();
+    Assert(profile.entries.size() == 3);
+    Assert(getEntry(profile, "A").thread_index == 0);
+    Assert(getEntry(profile, "B").thread_index == 1);
+    Assert(getEntry(profile, "C").thread_index == 1);
+  }
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fruit/fruit.h>
+#include "test_macros.h"
+
+#include <string>
+
+struct X {
+  INJECT(X()) = default;
+  
+  char data[1000];
+};
+
+struct Y {
+  Y(X*) {
+  }
+  
+  double data[10];
+};
+
+struct Listener {
+  INJECT(Listener(X*)) {
+  }
+};
+
+fruit::Component<Y> getComponent() {
+  return fruit::createComponent()
+    // Y is allocated by the provider, outside of the injector's memory pool.
+    .registerProvider([](X* x) { return new Y(x); })
+    .addMultibinding<Listener, Listener>();
+}
+
+fruit::Component<fruit::Required<X>, Y> getRequestComponent() {
+  return fruit::createComponent()
+    .registerProvider([](X* x) { return new Y(x); });
+}
+
+const fruit::InjectorMemoryUsage::TypeEntry* getEntry(const fruit::InjectorMemoryUsage& usage,
+                                                      const std::string& type_name) {
+  for (const fruit::InjectorMemoryUsage::TypeEntry& entry : usage.types) {
+    if (entry.type_name == type_name) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+void checkTotals(const fruit::InjectorMemoryUsage& usage) {
+  std::size_t total_bytes = usage.instance_table_bytes;
+  std::size_t graph_bytes = 0;
+  std::size_t multibinding_bytes = 0;
+  for (std::size_t i = 0; i < usage.types.size(); ++i) {
+    const fruit::InjectorMemoryUsage::TypeEntry& entry = usage.types[i];
+    Assert(entry.getTotalBytes() != 0);
+    Assert(i == 0 || usage.types[i - 1].getTotalBytes() >= entry.getTotalBytes());
+    total_bytes += entry.getTotalBytes();
+    graph_bytes += entry.graph_bytes;
+    multibinding_bytes += entry.multibinding_bytes;
+  }
+  Assert(graph_bytes <= usage.graph_bytes);
+  Assert(multibinding_bytes == usage.multibinding_bytes);
+  Assert(usage.pool_used_bytes <= usage.pool_reserved_bytes);
+  Assert(total_bytes <= usage.getTotalBytes());
+}
+
+int main() {
+  {
+    fruit::Injector<Y> injector(getComponent());
+    injector.enableMemoryAccounting();
+    injector.get<Y*>();
+    injector.getMultibindings<Listener>();
+    
+    fruit::InjectorMemoryUsage usage = injector.getMemoryUsage();
+    checkTotals(usage);
+    Assert(usage.pool_reserved_bytes >= sizeof(X));
+    Assert(usage.pool_used_bytes >= sizeof(X));
+    Assert(usage.num_external_objects == 1);
+    Assert(usage.external_bytes == sizeof(Y));
+    Assert(usage.graph_bytes != 0);
+    Assert(usage.instance_table_bytes != 0);
+    Assert(usage.multibinding_bytes != 0);
+    
+    // X uses the most memory.
+    Assert(usage.types[0].type_name == "X");
+    Assert(usage.types[0].num_pool_objects == 1);
+    Assert(usage.types[0].pool_reserved_bytes >= sizeof(X));
+    Assert(usage.types[0].pool_used_bytes >= sizeof(X));
+    Assert(usage.types[0].pool_used_bytes == sizeof(X) + usage.types[0].pool_padding_bytes);
+    Assert(usage.types[0].graph_bytes != 0);
+    
+    const fruit::InjectorMemoryUsage::TypeEntry* y = getEntry(usage, "Y");
+    Assert(y != nullptr);
+    Assert(y->num_pool_objects == 0);
+    Assert(y->num_external_objects == 1);
+    Assert(y->external_bytes == sizeof(Y));
+    
+    const fruit::InjectorMemoryUsage::TypeEntry* listener = getEntry(usage, "Listener");
+    Assert(listener != nullptr);
+    Assert(listener->multibinding_bytes != 0);
+  }
+  
+  {
+    // Without enableMemoryAccounting(), the objects' memory is not broken down by type.
+    fruit::Injector<Y> injector(getComponent());
+    injector.get<Y*>();
+    fruit::InjectorMemoryUsage usage = injector.getMemoryUsage();
+    checkTotals(usage);
+    Assert(usage.pool_used_bytes >= sizeof(X));
+    Assert(usage.num_external_objects == 0);
+    Assert(getEntry(usage, "X")->num_pool_objects == 0);
+    Assert(getEntry(usage, "X")->graph_bytes != 0);
+  }
+  
+  {
+    // The graph shared with the NormalizedComponent is not included.
+    fruit::NormalizedComponent<fruit::Required<X>, Y> normalized_component(getRequestComponent());
+    X x;
+    fruit::Injector<Y> injector(normalized_component, x);
+    injector.enableMemoryAccounting();
+    injector.get<Y*>();
+    fruit::InjectorMemoryUsage usage = injector.getMemoryUsage();
+    checkTotals(usage);
+    Assert(usage.external_bytes == sizeof(Y));
+    Assert(getEntry(usage, "X") == nullptr || getEntry(usage, "X")->pool_reserved_bytes == 0);
+  }
+  
+  return 0;
+}
@@ -34,6 +34,14 @@ void test_IsInVector() {
   Assert(IsInVector(A, Vector<A>));
 }
 
+void test_FindInVector() {
+  AssertSameType(FindInVector(A, Vector<>), Int<-1>);
+  AssertSameType(FindInVector(A, Vector<B>), Int<-1>);
+  AssertSameType(FindInVector(A, Vector<A>), Int<0>);
+  AssertSameType(FindInVector(B, Vector<A, B, C>), Int<1>);
+  AssertSameType(FindInVector(A, Vector<B, A, A>), Int<1>);
+}
+
 void test_IsSameVector() {
   AssertNotSameType(Vector<A, B>, Vector<B, A>);
   AssertNotSameType(Vector<A>, Vector<>);
@@ -73,6 +81,7 @@ void test_VectorRemoveFirstN() {
 int main() {
   
   test_IsInVector();
+  test_FindInVector();
   test_IsSameVector();
   test_VectorSize();
   test_ConcatVectors();
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fruit/fruit.h>
+#include "test_macros.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+// Waits until `other_started' is true, for at most 5 seconds. Returns false on timeout.
+bool waitFor(const std::atomic<bool>& other_started) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!other_started) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// A and B don't depend on each other, so they're constructed concurrently: each constructor waits for the other one to
+// start.
+
+struct A {
+  INJECT(A()) {
+    started = true;
+    overlapped = waitFor(B_started);
+  }
+  
+  static std::atomic<bool> started;
+  static std::atomic<bool> B_started;
+  static std::atomic<bool> overlapped;
+};
+
+std::atomic<bool> A::started(false);
+std::atomic<bool> A::B_started(false);
+std::atomic<bool> A::overlapped(false);
+
+struct B {
+  INJECT(B()) {
+    A::B_started = true;
+    overlapped = waitFor(A::started);
+  }
+  
+  static std::atomic<bool> overlapped;
+};
+
+std::atomic<bool> B::overlapped(false);
+
+struct Y {
+  INJECT(Y()) {
+    constructed = true;
+  }
+  
+  static std::atomic<bool> constructed;
+};
+
+std::atomic<bool> Y::constructed(false);
+
+struct C {
+  INJECT(C(A* a, B* b, fruit::Provider<Y>)) {
+    Assert(a != nullptr);
+    Assert(b != nullptr);
+    num_constructed++;
+  }
+  
+  static std::atomic<int> num_constructed;
+};
+
+std::atomic<int> C::num_constructed(0);
+
+struct Z {
+  INJECT(Z()) {
+    constructed = true;
+  }
+  
+  static std::atomic<bool> constructed;
+};
+
+std::atomic<bool> Z::constructed(false);
+
+struct Listener {
+  INJECT(Listener(C*)) {
+    constructed = true;
+  }
+  
+  static std::atomic<bool> constructed;
+};
+
+std::atomic<bool> Listener::constructed(false);
+
+fruit::Component<C> getComponent() {
+  return fruit::createComponent()
+    .registerConstructor<Z()>()
+    .addMultibinding<Listener, Listener>();
+}
+
+struct Failing {
+  Failing() = default;
+};
+
+fruit::Component<C, Failing> getFailingComponent() {
+  return fruit::createComponent()
+    .install(getComponent())
+    .registerProvider([]() -> Failing {
+      throw std::runtime_error("Failing");
+    });
+}
+
+int main() {
+  {
+    fruit::Injector<C> injector(getComponent());
+    injector.eagerlyInjectAll(4);
+    
+    Assert(A::overlapped);
+    Assert(B::overlapped);
+    Assert(C::num_constructed == 1);
+    Assert(Listener::constructed);
+    // Y is only injected through a Provider, and Z is not reachable.
+    Assert(!Y::constructed);
+    Assert(!Z::constructed);
+    
+    // Concurrent injection is enabled, and the instances are the same.
+    C* c = injector.get<C*>();
+    std::thread thread([&injector, c]() {
+      Assert(injector.get<C*>() == c);
+    });
+    thread.join();
+    Assert(C::num_constructed == 1);
+  }
+  
+  {
+    fruit::Injector<C, Failing> injector(getFailingComponent());
+    bool thrown = false;
+    try {
+      injector.eagerlyInjectAll(4);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    Assert(thrown);
+  }
+  
+  return 0;
+}
@@ -37,8 +37,8 @@ fruit::Component<> getComponent() {
 }
 
 int main() {
-  // The component normalization generates a random hash. By looping 50 times it's very likely that we'll get at least one hash
-  // with too many collisions (and we'll generate another).
+  // The component normalization picks a hash function for the map of bindings. The hash functions are tried in the same
+  // order in each iteration, so they all pick the same one.
   for (int i = 0; i < 50; i++) {
     fruit::NormalizedComponent<> normalizedComponent(getComponent());
     (void) normalizedComponent;
@@ -179,6 +179,409 @@ def test_error_type_not_provided_with_annotation(XAnnot, YAnnot):
         source,
         locals())
 
+def test_eagerly_inject_all_skips_provider_deps():
+    source = '''
+        struct Y {
+          static bool constructed;
+          INJECT(Y()) {
+            constructed = true;
+          }
+        };
+
+        bool Y::constructed = false;
+
+        struct Z {
+          static bool constructed;
+          INJECT(Z()) {
+            constructed = true;
+          }
+        };
+
+        bool Z::constructed = false;
+
+        struct X {
+          INJECT(X(fruit::Provider<Y>, Z*)) {
+            Assert(Z::constructed);
+          }
+        };
+
+        fruit::Component<X> getComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::Injector<X> injector(getComponent());
+          injector.eagerlyInjectAll();
+          Assert(Z::constructed);
+          // Y is only injected lazily, through the Provider.
+          Assert(!Y::constructed);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_get_async():
+    source = '''
+        // A and B are constructed concurrently: each provider waits until the other one started.
+        std::promise<void> a_started;
+        std::promise<void> b_started;
+
+        struct A {};
+        struct B {};
+
+        struct C {
+          A* a;
+          B* b;
+          INJECT(C(A* a, B* b)) : a(a), b(b) {}
+        };
+
+        fruit::Component<A, B, C> getComponent() {
+          return fruit::createComponent()
+            .registerProvider([]() {
+              a_started.set_value();
+              b_started.get_future().wait();
+              return A();
+            })
+            .registerProvider([]() {
+              b_started.set_value();
+              a_started.get_future().wait();
+              return B();
+            });
+        }
+
+        int main() {
+          fruit::Injector<A, B, C> injector(getComponent());
+          injector.enableConcurrentInjection(2);
+          std::future<A*> a = injector.getAsync<A*>();
+          std::future<B&> b = injector.getAsync<B&>();
+          Assert(a.get() == injector.get<A*>());
+          Assert(&b.get() == injector.get<B*>());
+          C* c = injector.getAsync<C*>().get();
+          Assert(c->a == injector.get<A*>());
+          Assert(c->b == injector.get<B*>());
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS + '''
+            #include <future>
+            ''',
+        source)
+
+def test_get_async_many_times():
+    source = '''
+        // The injections run in a bounded number of threads, they don't need a thread each.
+        struct X {
+          INJECT(X()) = default;
+        };
+
+        fruit::Component<X> getComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::Injector<X> injector(getComponent());
+          injector.enableConcurrentInjection();
+          std::vector<std::future<X*>> futures;
+          for (int i = 0; i < 10000; ++i) {
+            futures.push_back(injector.getAsync<X*>());
+          }
+          for (std::future<X*>& future : futures) {
+            Assert(future.get() == injector.get<X*>());
+          }
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS + '''
+            #include <future>
+            #include <vector>
+            ''',
+        source)
+
+def test_get_async_injector_moved():
+    source = '''
+        // The injection of B is queued while A's provider is running, and it runs after the injector has been moved.
+        std::promise<void> a_started;
+        std::promise<void> injector_moved;
+
+        struct A {};
+        struct B {
+          INJECT(B()) = default;
+        };
+
+        fruit::Component<A, B> getComponent() {
+          return fruit::createComponent()
+            .registerProvider([]() {
+              a_started.set_value();
+              injector_moved.get_future().wait();
+              return A();
+            });
+        }
+
+        int main() {
+          fruit::Injector<A, B> injector(getComponent());
+          injector.enableConcurrentInjection(1);
+          std::future<A*> a = injector.getAsync<A*>();
+          std::future<B*> b = injector.getAsync<B*>();
+          a_started.get_future().wait();
+          fruit::Injector<A, B> moved_injector(std::move(injector));
+          injector_moved.set_value();
+          Assert(a.get() == moved_injector.get<A*>());
+          Assert(b.get() == moved_injector.get<B*>());
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS + '''
+            #include <future>
+            ''',
+        source)
+
+def test_get_async_without_concurrent_injection_error():
+    source = '''
+        struct X {
+          INJECT(X()) = default;
+        };
+
+        fruit::Component<X> getComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::Injector<X> injector(getComponent());
+          injector.getAsync<X*>();
+        }
+        '''
+    expect_runtime_error(
+        'Fatal injection error: getAsync\\(\\) can only be called after enableConcurrentInjection\\(\\).',
+        COMMON_DEFINITIONS + '''
+            #include <future>
+            ''',
+        source)
+
+def test_get_async_error_type_not_provided():
+    source = '''
+        struct X {};
+        struct Y {};
+
+        fruit::Component<X> getComponent() {
+          return fruit::createComponent()
+            .registerProvider([]() { return X(); });
+        }
+
+        int main() {
+          fruit::Injector<X> injector(getComponent());
+          injector.getAsync<Y>();
+        }
+        '''
+    expect_compile_error(
+        'TypeNotProvidedError<Y>',
+        'Trying to get an instance of T, but it is not provided by this Provider/Injector.',
+        COMMON_DEFINITIONS,
+        source)
+
+def test_child_injector():
+    source = '''
+        struct X {
+          static int num_constructed;
+          INJECT(X()) {
+            ++num_constructed;
+          }
+        };
+
+        int X::num_constructed = 0;
+
+        struct Y {
+          X* x;
+          int request;
+          INJECT(Y(X* x, int request)) : x(x), request(request) {}
+        };
+
+        fruit::Component<X> getParentComponent() {
+          return fruit::createComponent();
+        }
+
+        fruit::Component<fruit::Required<X>, Y> getChildComponent(int& request) {
+          return fruit::createComponent()
+            .bindInstance(request);
+        }
+
+        int main() {
+          fruit::Injector<X> parentInjector(getParentComponent());
+          parentInjector.enableConcurrentInjection();
+          X* x = parentInjector.get<X*>();
+          int request1 = 1;
+          int request2 = 2;
+          fruit::Injector<X, Y> childInjector1(parentInjector, getChildComponent(request1));
+          fruit::Injector<Y> childInjector2(parentInjector, getChildComponent(request2));
+          Assert(childInjector1.get<X*>() == x);
+          Assert(childInjector1.get<Y*>()->x == x);
+          Assert(childInjector1.get<Y*>()->request == 1);
+          Assert(childInjector2.get<Y*>()->x == x);
+          Assert(childInjector2.get<Y*>()->request == 2);
+          Assert(childInjector1.get<Y*>() != childInjector2.get<Y*>());
+          Assert(X::num_constructed == 1);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_child_injector_constructs_in_parent():
+    source = '''
+        struct X {
+          static int num_constructed;
+          INJECT(X()) {
+            ++num_constructed;
+          }
+        };
+
+        int X::num_constructed = 0;
+
+        struct Y {
+          X* x;
+          INJECT(Y(X* x)) : x(x) {}
+        };
+
+        fruit::Component<X> getParentComponent() {
+          return fruit::createComponent();
+        }
+
+        fruit::Component<fruit::Required<X>, Y> getChildComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::Injector<X> parentInjector(getParentComponent());
+          parentInjector.enableConcurrentInjection();
+          fruit::Injector<Y> childInjector1(parentInjector, getChildComponent());
+          fruit::Injector<Y> childInjector2(parentInjector, getChildComponent());
+          X* x = childInjector1.get<Y*>()->x;
+          Assert(childInjector2.get<Y*>()->x == x);
+          Assert(parentInjector.get<X*>() == x);
+          Assert(X::num_constructed == 1);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_child_injector_multibindings():
+    source = '''
+        struct X {
+          int n;
+        };
+
+        fruit::Component<> getParentComponent(X& x1) {
+          return fruit::createComponent()
+            .addInstanceMultibinding(x1);
+        }
+
+        fruit::Component<> getChildComponent(X& x2) {
+          return fruit::createComponent()
+            .addInstanceMultibinding(x2);
+        }
+
+        int main() {
+          X x1{1}, x2{2};
+          fruit::Injector<> parentInjector(getParentComponent(x1));
+          parentInjector.enableConcurrentInjection();
+          fruit::Injector<> emptyChildInjector(parentInjector, fruit::Component<>(fruit::createComponent()));
+          fruit::Injector<> childInjector(parentInjector, getChildComponent(x2));
+          Assert((emptyChildInjector.getMultibindings<X>() == std::vector<X*>{&x1}));
+          Assert((childInjector.getMultibindings<X>() == std::vector<X*>{&x1, &x2}));
+          Assert((parentInjector.getMultibindings<X>() == std::vector<X*>{&x1}));
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_child_injector_undoes_binding_compression():
+    source = '''
+        struct I {
+          virtual ~I() = default;
+        };
+
+        struct C : public I {
+          static int num_constructed;
+          INJECT(C()) {
+            ++num_constructed;
+          }
+        };
+
+        int C::num_constructed = 0;
+
+        struct Y {
+          C* c;
+          INJECT(Y(C* c)) : c(c) {}
+        };
+
+        fruit::Component<I> getParentComponent() {
+          return fruit::createComponent()
+            .bind<I, C>();
+        }
+
+        fruit::Component<fruit::Required<I>, Y> getChildComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::Injector<I> parentInjector(getParentComponent());
+          parentInjector.enableConcurrentInjection();
+          fruit::Injector<I, Y> childInjector(parentInjector, getChildComponent());
+          Assert(childInjector.get<I*>() == childInjector.get<Y*>()->c);
+          Assert(C::num_constructed == 1);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_child_injector_without_concurrent_injection_error():
+    source = '''
+        struct X {
+          INJECT(X()) = default;
+        };
+
+        fruit::Component<X> getParentComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::Injector<X> parentInjector(getParentComponent());
+          fruit::Injector<X> childInjector(parentInjector, fruit::Component<>(fruit::createComponent()));
+        }
+        '''
+    expect_runtime_error(
+        'Fatal injection error: A child injector can only be created after calling enableConcurrentInjection\\(\\) on the parent injector.',
+        COMMON_DEFINITIONS,
+        source)
+
+@params('X', 'fruit::Annotated<Annotation1, X>')
+def test_error_child_injector_unsatisfied_requirements(XAnnot):
+    source = '''
+        struct X {};
+
+        fruit::Component<> getParentComponent() {
+          return fruit::createComponent();
+        }
+
+        fruit::Component<fruit::Required<XAnnot>> getChildComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::Injector<> parentInjector(getParentComponent());
+          fruit::Injector<> childInjector(parentInjector, getChildComponent());
+        }
+        '''
+    expect_compile_error(
+        'UnsatisfiedRequirementsInChildInjectorError<XAnnot>',
+        'The requirements in UnsatisfiedRequirements are required by the Component \\(second parameter of the Injector constructor\\) but are not provided by the parent Injector.',
+        COMMON_DEFINITIONS,
+        source,
+        locals())
+
 if __name__ == '__main__':
     import nose2
     nose2.main()
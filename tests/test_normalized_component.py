@@ -128,6 +128,393 @@ def test_success_inline_component(XAnnot, X_ANNOT, YAnnot):
         source,
         locals())
 
+def test_share_component_scoped_instances():
+    source = '''
+        struct X {};
+
+        struct Y {
+          static int num_constructed;
+          static int num_destroyed;
+          INJECT(Y()) {
+            ++num_constructed;
+          }
+          ~Y() {
+            ++num_destroyed;
+          }
+        };
+
+        int Y::num_constructed = 0;
+        int Y::num_destroyed = 0;
+
+        struct Z {
+          static int num_constructed;
+          Y* y;
+          INJECT(Z(X&, Y* y)) : y(y) {
+            ++num_constructed;
+          }
+        };
+
+        int Z::num_constructed = 0;
+
+        fruit::Component<fruit::Required<X>, Y, Z> getComponent() {
+          return fruit::createComponent();
+        }
+
+        fruit::Component<X> getXComponent(X& x) {
+          return fruit::createComponent()
+            .bindInstance(x);
+        }
+
+        int main() {
+          {
+            fruit::NormalizedComponent<fruit::Required<X>, Y, Z> normalizedComponent(getComponent());
+            normalizedComponent.shareComponentScopedInstances();
+
+            X x1{}, x2{};
+            Y* y1;
+            {
+              fruit::Injector<Y, Z> injector(normalizedComponent, getXComponent(x1));
+              y1 = injector.get<Y*>();
+              Assert(injector.get<Z*>()->y == y1);
+            }
+            Assert(Y::num_destroyed == 0);
+            fruit::Injector<Y, Z> injector(normalizedComponent, getXComponent(x2));
+            Assert(injector.get<Z*>()->y == y1);
+            Assert(injector.get<Y*>() == y1);
+            Assert(Y::num_constructed == 1);
+            Assert(Z::num_constructed == 2);
+          }
+          Assert(Y::num_destroyed == 1);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_component_scoped_instances_not_shared_by_default():
+    source = '''
+        struct X {};
+
+        struct Y {
+          static int num_constructed;
+          INJECT(Y()) {
+            ++num_constructed;
+          }
+        };
+
+        int Y::num_constructed = 0;
+
+        fruit::Component<fruit::Required<X>, Y> getComponent() {
+          return fruit::createComponent();
+        }
+
+        fruit::Component<X> getXComponent(X& x) {
+          return fruit::createComponent()
+            .bindInstance(x);
+        }
+
+        int main() {
+          fruit::NormalizedComponent<fruit::Required<X>, Y> normalizedComponent(getComponent());
+
+          X x{};
+          fruit::Injector<Y> injector1(normalizedComponent, getXComponent(x));
+          fruit::Injector<Y> injector2(normalizedComponent, getXComponent(x));
+          Assert(injector1.get<Y*>() != injector2.get<Y*>());
+          Assert(Y::num_constructed == 2);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_injector_from_required_instances():
+    source = '''
+        struct X {
+          int n;
+        };
+
+        struct Y {
+          X* x;
+          INJECT(Y(X* x)) : x(x) {}
+        };
+
+        fruit::Component<fruit::Required<X>, Y> getComponent() {
+          return fruit::createComponent();
+        }
+
+        fruit::Component<X> getXComponent(X& x) {
+          return fruit::createComponent()
+            .bindInstance(x);
+        }
+
+        int main() {
+          fruit::NormalizedComponent<fruit::Required<X>, Y> normalizedComponent(getComponent());
+
+          X x1{1}, x2{2};
+          fruit::Injector<X, Y> injector1(normalizedComponent, x1);
+          fruit::Injector<Y> injector2(normalizedComponent, x2);
+          Assert(injector1.get<X*>() == &x1);
+          Assert(injector1.get<Y*>()->x == &x1);
+          Assert(injector2.get<Y*>()->x == &x2);
+
+          // A Component lvalue still selects the constructor that takes a Component.
+          fruit::Component<X> xComponent = getXComponent(x1);
+          fruit::Injector<Y> injector3(normalizedComponent, xComponent);
+          Assert(injector3.get<Y*>()->x == &x1);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_injector_from_required_instances_unused_requirement():
+    source = '''
+        struct X {};
+
+        struct Y {
+          INJECT(Y()) = default;
+        };
+
+        fruit::Component<fruit::Required<X>, Y> getComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::NormalizedComponent<fruit::Required<X>, Y> normalizedComponent(getComponent());
+
+          X x{};
+          fruit::Injector<X, Y> injector(normalizedComponent, x);
+          Assert(injector.get<X*>() == &x);
+          injector.get<Y*>();
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_injector_from_required_instances_no_requirements():
+    source = '''
+        struct Y {
+          INJECT(Y()) = default;
+        };
+
+        fruit::Component<Y> getComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::NormalizedComponent<Y> normalizedComponent(getComponent());
+          fruit::Injector<Y> injector(normalizedComponent);
+          injector.get<Y*>();
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_error_injector_from_required_instances_missing_instance():
+    source = '''
+        struct X {};
+
+        fruit::Component<fruit::Required<X>> getComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::NormalizedComponent<fruit::Required<X>> normalizedComponent(getComponent());
+          fruit::Injector<> injector(normalizedComponent);
+        }
+        '''
+    expect_compile_error(
+        'MissingRequiredInstancesError<X>',
+        'The types in MissingTypes are required by the NormalizedComponent, but no instance of them was passed to the Injector constructor.',
+        COMMON_DEFINITIONS,
+        source)
+
+def test_error_injector_from_required_instances_type_not_required():
+    source = '''
+        struct X {};
+        struct Y {};
+
+        fruit::Component<fruit::Required<X>> getComponent() {
+          return fruit::createComponent();
+        }
+
+        int main() {
+          fruit::NormalizedComponent<fruit::Required<X>> normalizedComponent(getComponent());
+          X x{};
+          Y y{};
+          fruit::Injector<> injector(normalizedComponent, x, y);
+        }
+        '''
+    expect_compile_error(
+        'InstancesOfTypesNotRequiredError<Y>',
+        'Instances of the types in NotRequiredTypes were passed to the Injector constructor, but these types are not required by the NormalizedComponent.',
+        COMMON_DEFINITIONS,
+        source)
+
+def test_reset_injector():
+    source = '''
+        struct X {
+          int n;
+        };
+
+        struct Y {
+          static int num_constructed;
+          static int num_destroyed;
+          X* x;
+          INJECT(Y(X* x)) : x(x) {
+            ++num_constructed;
+          }
+          ~Y() {
+            ++num_destroyed;
+          }
+        };
+
+        int Y::num_constructed = 0;
+        int Y::num_destroyed = 0;
+
+        struct Z {
+          static int num_constructed;
+          INJECT(Z()) {
+            ++num_constructed;
+          }
+        };
+
+        int Z::num_constructed = 0;
+
+        fruit::Component<fruit::Required<X>, Y> getComponent() {
+          return fruit::createComponent()
+            .addMultibinding<Z, Z>();
+        }
+
+        int main() {
+          fruit::NormalizedComponent<fruit::Required<X>, Y> normalizedComponent(getComponent());
+
+          X x1{1}, x2{2};
+          {
+            fruit::Injector<X, Y> injector(normalizedComponent, x1);
+            Assert(injector.get<Y*>()->x == &x1);
+            const std::vector<Z*>* multibindings = &injector.getMultibindings<Z>();
+            Assert(multibindings->size() == 1);
+            
+            injector.reset(normalizedComponent, x2);
+            Assert(Y::num_destroyed == 1);
+            Assert(injector.get<X*>() == &x2);
+            Assert(injector.get<Y*>()->x == &x2);
+            // The vector of multibindings is reused, and refilled with the new objects.
+            Assert(&injector.getMultibindings<Z>() == multibindings);
+            Assert(multibindings->size() == 1);
+            Assert(Z::num_constructed == 2);
+            Assert(Y::num_constructed == 2);
+            
+            // Resetting an injector that didn't construct anything yet is also allowed.
+            injector.reset(normalizedComponent, x1);
+            injector.reset(normalizedComponent, x2);
+            Assert(Y::num_destroyed == 2);
+            Assert(injector.get<Y*>()->x == &x2);
+          }
+          Assert(Y::num_destroyed == 3);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
+def test_reset_injector_constructed_from_component_error():
+    source = '''
+        struct X {};
+
+        fruit::Component<fruit::Required<X>> getComponent() {
+          return fruit::createComponent();
+        }
+
+        fruit::Component<X> getXComponent(X& x) {
+          return fruit::createComponent()
+            .bindInstance(x);
+        }
+
+        int main() {
+          fruit::NormalizedComponent<fruit::Required<X>> normalizedComponent(getComponent());
+          X x{};
+          fruit::Injector<> injector(normalizedComponent, getXComponent(x));
+          injector.reset(normalizedComponent, x);
+        }
+        '''
+    expect_runtime_error(
+        'Fatal injection error: reset\\(\\) can only be called on an injector constructed from the same NormalizedComponent and instances of its required types.',
+        COMMON_DEFINITIONS,
+        source)
+
+def test_eagerly_inject_all_from_normalized_component():
+    source = '''
+        struct R {};
+
+        struct X {
+          static int num_constructed;
+          INJECT(X(R*)) {
+            ++num_constructed;
+          }
+        };
+
+        int X::num_constructed = 0;
+
+        struct W {
+          static int num_constructed;
+          INJECT(W()) {
+            ++num_constructed;
+          }
+        };
+
+        int W::num_constructed = 0;
+
+        fruit::Component<fruit::Required<R>, X, W> getComponent() {
+          return fruit::createComponent();
+        }
+
+        fruit::Component<R> getRComponent(R& r) {
+          return fruit::createComponent()
+            .bindInstance(r);
+        }
+
+        int main() {
+          fruit::NormalizedComponent<fruit::Required<R>, X, W> normalizedComponent(getComponent());
+          R r;
+          {
+            fruit::Injector<X> injector(normalizedComponent, r);
+            injector.eagerlyInjectAll();
+            Assert(X::num_constructed == 1);
+            // W is not reachable from Injector<X>.
+            Assert(W::num_constructed == 0);
+          }
+          {
+            fruit::Injector<R, X, W> injector(normalizedComponent, r);
+            injector.eagerlyInjectAll();
+            Assert(X::num_constructed == 2);
+            Assert(W::num_constructed == 1);
+            injector.reset(normalizedComponent, r);
+            injector.eagerlyInjectAll();
+            Assert(X::num_constructed == 3);
+            Assert(W::num_constructed == 2);
+          }
+          {
+            fruit::Injector<X> injector(normalizedComponent, getRComponent(r));
+            injector.eagerlyInjectAll();
+            Assert(X::num_constructed == 4);
+            Assert(W::num_constructed == 2);
+          }
+          {
+            fruit::Injector<X, W> injector(normalizedComponent, getRComponent(r));
+            injector.eagerlyInjectAll();
+            Assert(X::num_constructed == 5);
+            Assert(W::num_constructed == 3);
+          }
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS,
+        source)
+
 @params('X', 'fruit::Annotated<Annotation1, X>')
 def test_unsatisfied_requirements(XAnnot):
     source = '''
@@ -169,6 +169,185 @@ def test_error_returned_nullptr(XAnnot, XPtrAnnot):
         source,
         locals())
 
+@params(
+    ('X', 'WithNoAnnot'),
+    ('fruit::Annotated<Annotation1, X>', 'WithAnnot1'))
+def test_register_async_provider_returning_value(XAnnot, WithAnnot):
+    source = '''
+        struct Y {
+          int value = 5;
+        };
+
+        struct X {
+          X(int value) : value(value) {
+            ++num_constructions;
+          }
+
+          static unsigned num_constructions;
+
+          int value;
+        };
+
+        unsigned X::num_constructions = 0;
+
+        fruit::Component<XAnnot> getComponent() {
+          static Y y;
+          return fruit::createComponent()
+            .bindInstance(y)
+            .registerAsyncProvider<XAnnot(Y*)>([](Y* y) {
+              return std::async(std::launch::async, [y]() {
+                return X(y->value);
+              });
+            });
+        }
+
+        int main() {
+          fruit::Injector<XAnnot> injector(getComponent());
+
+          Assert((injector.get<WithAnnot<X                 >>(). value == 5));
+          Assert((injector.get<WithAnnot<X*                >>()->value == 5));
+          Assert((injector.get<WithAnnot<const X&          >>(). value == 5));
+          Assert((injector.get<WithAnnot<std::shared_ptr<X>>>()->value == 5));
+
+          Assert(X::num_constructions == 1);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS + '''
+            #include <future>
+            ''',
+        source,
+        locals())
+
+@params(
+    ('X', 'X*', 'WithNoAnnot'),
+    ('fruit::Annotated<Annotation1, X>', 'fruit::Annotated<Annotation1, X*>', 'WithAnnot1'))
+def test_register_async_provider_returning_pointer(XAnnot, XPtrAnnot, WithAnnot):
+    source = '''
+        struct X {
+          int value = 5;
+        };
+
+        fruit::Component<XAnnot> getComponent() {
+          return fruit::createComponent()
+            .registerAsyncProvider<XPtrAnnot()>([]() {
+              std::promise<X*> promise;
+              promise.set_value(new X());
+              return promise.get_future().share();
+            });
+        }
+
+        int main() {
+          fruit::Injector<XAnnot> injector(getComponent());
+
+          Assert((injector.get<WithAnnot<X*>>()->value == 5));
+          Assert((injector.get<WithAnnot<X*>>() == injector.get<WithAnnot<X*>>()));
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS + '''
+            #include <future>
+            ''',
+        source,
+        locals())
+
+def test_register_async_provider_without_signature():
+    source = '''
+        struct X {
+          int value = 5;
+        };
+
+        fruit::Component<X> getComponent() {
+          return fruit::createComponent()
+            .registerAsyncProvider([]() {
+              return std::async(std::launch::deferred, []() {
+                return X();
+              });
+            });
+        }
+
+        int main() {
+          fruit::Injector<X> injector(getComponent());
+          Assert(injector.get<X*>()->value == 5);
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS + '''
+            #include <future>
+            ''',
+        source)
+
+def test_register_async_provider_eagerly_injected_starts_all_first():
+    source = '''
+        // The computations of X and Y only finish once both have started, so they must be started before waiting for
+        // either of them, even though eagerlyInjectAll() only uses 1 thread.
+        std::promise<void> x_started;
+        std::promise<void> y_started;
+
+        void waitFor(std::promise<void>& promise) {
+          Assert(promise.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        }
+
+        struct X {};
+        struct Y {};
+
+        struct Z {
+          INJECT(Z(X, Y)) {}
+        };
+
+        fruit::Component<Z> getComponent() {
+          return fruit::createComponent()
+            .registerAsyncProvider([]() {
+              x_started.set_value();
+              return std::async(std::launch::async, []() {
+                waitFor(y_started);
+                return X();
+              });
+            })
+            .registerAsyncProvider([]() {
+              y_started.set_value();
+              return std::async(std::launch::async, []() {
+                waitFor(x_started);
+                return Y();
+              });
+            });
+        }
+
+        int main() {
+          fruit::Injector<Z> injector(getComponent());
+          injector.eagerlyInjectAll();
+          injector.get<Z*>();
+        }
+        '''
+    expect_success(
+        COMMON_DEFINITIONS + '''
+            #include <chrono>
+            #include <future>
+            ''',
+        source)
+
+@params('X', 'fruit::Annotated<Annotation1, X>')
+def test_register_async_provider_error_not_function(XAnnot):
+    source = '''
+        struct X {
+          X(int) {}
+        };
+
+        fruit::Component<XAnnot> getComponent() {
+          int n = 3;
+          return fruit::createComponent()
+            .registerAsyncProvider<XAnnot()>([=]{return std::async(std::launch::deferred, [n]() {return X(n);});});
+        }
+        '''
+    expect_compile_error(
+        'FunctorUsedAsProviderError<.*>',
+        'A stateful lambda or a non-lambda functor was used as provider',
+        COMMON_DEFINITIONS + '''
+            #include <future>
+            ''',
+        source,
+        locals())
+
 if __name__ == '__main__':
     import nose2
     nose2.main()
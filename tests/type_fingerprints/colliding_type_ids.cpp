@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include "colliding_type_ids.h"
+#include "../test_macros.h"
+
+#include <fruit/impl/data_structures/semistatic_map.templates.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace fruit::impl;
+
+fruit::Component<Y1, Y2> getComponent() {
+  return fruit::createComponent()
+    .install(getY1Component())
+    .install(getY2Component());
+}
+
+// The 2 X types are different, but they have the same hash.
+void test_type_ids_collide() {
+  Assert(!(getX1TypeId() == getX2TypeId()));
+  Assert(std::hash<TypeId>()(getX1TypeId()) == std::hash<TypeId>()(getX2TypeId()));
+}
+
+// The keys with the same hash can't be in a perfect hashed map, so the map falls back to scanning buckets.
+void test_semistatic_map() {
+  std::vector<std::pair<TypeId, int>> values{{getX1TypeId(), 1}, {getX2TypeId(), 2}, {getTypeId<Y1>(), 3}};
+  SemistaticMap<TypeId, int> map(values.begin(), values.size());
+  Assert(map.at(getX1TypeId()) == 1);
+  Assert(map.at(getX2TypeId()) == 2);
+  Assert(map.at(getTypeId<Y1>()) == 3);
+  Assert(map.find(getTypeId<Y2>()) == nullptr);
+}
+
+// The injector's graph has 2 nodes with the same hash, so their NodeIds are compared when sorting the nodes.
+void test_injector() {
+  fruit::Injector<Y1, Y2> injector(getComponent());
+  Assert(injector.get<Y1>().n == 1);
+  Assert(injector.get<Y2>().n == 2);
+  Assert(getX1Value(injector) == 1);
+  Assert(getX2Value(injector) == 2);
+}
+
+// Here the 2 X types are in different graphs (and maps): the one of the NormalizedComponent, and its extension.
+void test_injector_from_normalized_component() {
+  fruit::NormalizedComponent<Y1> normalized_component(getY1Component());
+  fruit::Injector<Y1, Y2> injector(normalized_component, fruit::Component<Y2>(getY2Component()));
+  Assert(injector.get<Y1>().n == 1);
+  Assert(injector.get<Y2>().n == 2);
+  Assert(getX1Value(injector) == 1);
+  Assert(getX2Value(injector) == 2);
+}
+
+int main() {
+  
+  test_type_ids_collide();
+  test_semistatic_map();
+  test_injector();
+  test_injector_from_normalized_component();
+  
+  return 0;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COLLIDING_TYPE_IDS_H
+#define COLLIDING_TYPE_IDS_H
+
+#include <fruit/fruit.h>
+
+struct Y1 {
+  int n;
+};
+
+struct Y2 {
+  int n;
+};
+
+// Each of these binds Y1 (or Y2) with a provider that takes an X*. Both types are called X, and are defined in anonymous
+// namespaces of different translation units, so they have the same fingerprint.
+fruit::Component<Y1> getY1Component();
+fruit::Component<Y2> getY2Component();
+
+// The TypeId of the X used by getY1Component() (or getY2Component()).
+fruit::impl::TypeId getX1TypeId();
+fruit::impl::TypeId getX2TypeId();
+
+// Gets the X used by getY1Component() (or getY2Component()) with unsafeGet(), that looks up its TypeId.
+int getX1Value(fruit::Injector<Y1, Y2>& injector);
+int getX2Value(fruit::Injector<Y1, Y2>& injector);
+
+#endif // COLLIDING_TYPE_IDS_H
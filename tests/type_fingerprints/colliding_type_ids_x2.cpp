@@ -0,0 +1,43 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "colliding_type_ids.h"
+
+namespace {
+
+struct X {
+  int n;
+  
+  INJECT(X()) : n(2) {
+  }
+};
+
+} // namespace
+
+fruit::Component<Y2> getY2Component() {
+  return fruit::createComponent()
+    .registerProvider([](X* x) {
+      return Y2{x->n};
+    });
+}
+
+fruit::impl::TypeId getX2TypeId() {
+  return fruit::impl::getTypeId<X>();
+}
+
+int getX2Value(fruit::Injector<Y1, Y2>& injector) {
+  return injector.unsafeGet<X>()->n;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE
+
+#include <fruit/impl/util/radix_sort.h>
+#include "../test_macros.h"
+
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cstdint>
+
+using namespace std;
+using namespace fruit::impl;
+
+size_t getFirst(const pair<size_t, int>& x) {
+  return x.first;
+}
+
+void test_empty() {
+  vector<pair<size_t, int>> v;
+  radixSort(v, getFirst);
+  Assert(v.empty());
+}
+
+void test_stable() {
+  vector<pair<size_t, int>> v = {{3, 0}, {1, 1}, {3, 2}, {2, 3}, {1, 4}, {3, 5}};
+  radixSort(v, getFirst);
+  vector<pair<size_t, int>> expected = {{1, 1}, {1, 4}, {2, 3}, {3, 0}, {3, 2}, {3, 5}};
+  Assert(v == expected);
+}
+
+void test_all_keys_equal() {
+  vector<pair<size_t, int>> v = {{7, 0}, {7, 1}, {7, 2}};
+  radixSort(v, getFirst);
+  vector<pair<size_t, int>> expected = {{7, 0}, {7, 1}, {7, 2}};
+  Assert(v == expected);
+}
+
+void test_random_keys() {
+  std::default_random_engine random_generator(42);
+  vector<pair<size_t, int>> v;
+  for (int i = 0; i < 10000; ++i) {
+    // Keys spaced like the addresses of TypeInfo objects, plus some keys using the high-order bits.
+    size_t key = (i % 10 == 0) ? size_t(random_generator()) << (sizeof(size_t) * 8 - 32)
+                               : 0x400000 + (random_generator() % 5000) * 24;
+    v.emplace_back(key, i);
+  }
+  vector<pair<size_t, int>> expected = v;
+  std::stable_sort(expected.begin(), expected.end(), [](const pair<size_t, int>& x, const pair<size_t, int>& y) {
+    return x.first < y.first;
+  });
+  radixSort(v, getFirst);
+  Assert(v == expected);
+}
+
+int main() {
+
+  test_empty();
+  test_stable();
+  test_all_keys_equal();
+  test_random_keys();
+
+  return 0;
+}
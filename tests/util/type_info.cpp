@@ -58,6 +58,55 @@ void test_isTriviallyDestructible_false() {
   Assert(!getTypeId<std::vector<int>>().type_info->isTriviallyDestructible());
 }
 
+struct Annotation1 {};
+
+void test_fingerprintOfString() {
+  // The hash of a string doesn't depend on the compiler or on the platform, so these values must never change.
+  static_assert(fingerprintOfString("") == 0x79cfc3dbe5bbfcafULL, "");
+  static_assert(fingerprintOfString("MyStruct") == 0x9d91c85adf73be2cULL, "");
+  static_assert(fingerprintOfString("std::vector<int, std::allocator<int> >") == 0xa6edbb1569f50fb2ULL, "");
+  
+  static_assert(fingerprintOfString("MyStruct") != fingerprintOfString("MyStruct2"), "");
+  static_assert(fingerprintOfString("MyStruct") != fingerprintOfString("MyStrucT"), "");
+  // The chars are packed in blocks of 8, and the leaves of the recursion have up to 16 chars.
+  static_assert(fingerprintOfString("abcdefgh") != fingerprintOfString("abcdefg"), "");
+  static_assert(fingerprintOfString("abcdefghijklmnop") != fingerprintOfString("abcdefghijklmnoq"), "");
+  static_assert(fingerprintOfString("abcdefghijklmnop") != fingerprintOfString("bacdefghijklmnop"), "");
+  static_assert(fingerprintOfString("abcdefghijklmnopqrstuvwxyz0123456789")
+                != fingerprintOfString("abcdefghijklmnopqrstuvwxyz0123456788"), "");
+  static_assert(fingerprintOfString("abcdefghijklmnopqrstuvwxyz0123456789")
+                != fingerprintOfString("abcdefghijklmnopqrstuvwxyz0123456789a"), "");
+  // Swapping the two halves of the string changes the hash.
+  static_assert(fingerprintOfString("abcdefghijklmnopqrstuvwxyz012345")
+                != fingerprintOfString("qrstuvwxyz012345abcdefghijklmnop"), "");
+}
+
+void test_fingerprint() {
+#if FRUIT_ENABLE_TYPE_FINGERPRINTS
+  // The fingerprints are computed at compile time.
+  static_assert(getTypeFingerprint<MyStruct>() != 0, "");
+  static_assert(getTypeFingerprint<MyStruct>() != getTypeFingerprint<TypeAligned128>(), "");
+  Assert(getTypeId<MyStruct>().type_info->fingerprint() == getTypeFingerprint<MyStruct>());
+  Assert(getTypeId<int>().type_info->fingerprint() != getTypeId<unsigned>().type_info->fingerprint());
+  Assert(getTypeId<int>().type_info->fingerprint() != getTypeId<int*>().type_info->fingerprint());
+  Assert(getTypeId<int>().type_info->fingerprint()
+         != getTypeId<fruit::Annotated<Annotation1, int>>().type_info->fingerprint());
+  Assert(getTypeId<std::vector<int>>().type_info->fingerprint()
+         != getTypeId<std::vector<unsigned>>().type_info->fingerprint());
+#else
+  Assert(getTypeId<MyStruct>().type_info->fingerprint() == 0);
+#endif
+}
+
+void test_getTypeIdsForList() {
+  // The list contains meta-level types, getTypeIdsForList() must return the TypeIds of the wrapped types.
+  using fruit::impl::meta::Type;
+  using fruit::impl::meta::Vector;
+  Assert((getTypeIdsForList<Vector<>>().empty()));
+  Assert((getTypeIdsForList<Vector<Type<MyStruct>, Type<int>>>()
+          == std::vector<TypeId>{getTypeId<MyStruct>(), getTypeId<int>()}));
+}
+
 int main() {
   
   test_size();
@@ -65,6 +114,9 @@ int main() {
   test_name();
   test_isTriviallyDestructible_true();
   test_isTriviallyDestructible_false();
+  test_fingerprintOfString();
+  test_fingerprint();
+  test_getTypeIdsForList();
   
   return 0;
 }